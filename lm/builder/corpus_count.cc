@@ -9,12 +9,19 @@
 #include "util/file.hh"
 #include "util/file_piece.hh"
 #include "util/murmur_hash.hh"
+#include "util/pcqueue.hh"
 #include "util/probing_hash_table.hh"
 #include "util/scoped.hh"
 #include "util/stream/chain.hh"
 #include "util/stream/timer.hh"
 #include "util/tokenize_piece.hh"
 
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <functional>
 
 #include <stdint.h>
@@ -65,17 +72,18 @@ const float kProbingMultiplier = 1.5;
 
 typedef util::ProbingHashTable<DedupeEntry, DedupeHash, DedupeEquals> Dedupe;
 
-class Writer {
+// Blocks is util::stream::Link or, for threads counting in parallel, CountBlocks.
+template <class Blocks> class Writer {
   public:
-    Writer(std::size_t order, const util::stream::ChainPosition &position, void *dedupe_mem, std::size_t dedupe_mem_size)
-      : block_(position), gram_(block_->Get(), order),
+    Writer(std::size_t order, Blocks &block, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size, bool add_special_unigrams)
+      : block_(block), gram_(block_->Get(), order),
         dedupe_invalid_(order, std::numeric_limits<WordIndex>::max()),
         dedupe_(dedupe_mem, dedupe_mem_size, &dedupe_invalid_[0], DedupeHash(order), DedupeEquals(order)),
         buffer_(new WordIndex[order - 1]),
-        block_size_(position.GetChain().BlockSize()) {
+        block_size_(block_size) {
       dedupe_.Clear();
-      assert(Dedupe::Size(position.GetChain().BlockSize() / position.GetChain().EntrySize(), kProbingMultiplier) == dedupe_mem_size);
-      if (order == 1) {
+      assert(Dedupe::Size(block_size / NGram<BuildingPayload>::TotalSize(order), kProbingMultiplier) == dedupe_mem_size);
+      if (add_special_unigrams) {
         // Add special words.  AdjustCounts is responsible if order != 1.
         AddUnigramWord(kUNK);
         AddUnigramWord(kBOS);
@@ -134,7 +142,7 @@ class Writer {
       }
     }
 
-    util::stream::Link block_;
+    Blocks &block_;
 
     NGram<BuildingPayload> gram_;
 
@@ -155,16 +163,21 @@ float CorpusCount::DedupeMultiplier(std::size_t order) {
   return kProbingMultiplier * static_cast<float>(sizeof(DedupeEntry)) / static_cast<float>(NGram<BuildingPayload>::TotalSize(order));
 }
 
+std::size_t CorpusCount::ThreadBlocks(std::size_t threads) {
+  return threads > 1 ? 2 * threads : 0;
+}
+
 std::size_t CorpusCount::VocabUsage(std::size_t vocab_estimate) {
   return ngram::GrowableVocab<ngram::WriteUniqueWords>::MemUsage(vocab_estimate);
 }
 
-CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol)
+CorpusCount::CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads)
   : from_(from), vocab_write_(vocab_write), token_count_(token_count), type_count_(type_count),
     prune_words_(prune_words), prune_vocab_filename_(prune_vocab_filename),
     dedupe_mem_size_(Dedupe::Size(entries_per_block, kProbingMultiplier)),
-    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_)),
-    disallowed_symbol_action_(disallowed_symbol) {
+    dedupe_mem_(util::MallocOrThrow(dedupe_mem_size_ * std::max<std::size_t>(threads, 1))),
+    disallowed_symbol_action_(disallowed_symbol),
+    threads_(std::max<std::size_t>(threads, 1)) {
 }
 
 namespace {
@@ -180,6 +193,208 @@ namespace {
         UTIL_THROW(FormatLoadException, "Special word " << word << " is not allowed in the corpus.  I plan to support models containing <unk> in the future.  Pass --skip_symbols to convert these symbols to whitespace.");
     }
   }
+
+// Bytes of text each thread takes at once.
+const std::size_t kBatchSize = 1 << 22;
+
+// Blocks of a counting thread.  They are passed to the thread writing the
+// chain through filled and come back through free.
+class CountBlocks {
+  public:
+    CountBlocks(util::PCQueue<util::stream::Block> &free, util::PCQueue<util::stream::Block> &filled)
+      : free_(free), filled_(filled) {
+      free_.Consume(current_);
+    }
+
+    util::stream::Block *operator->() { return &current_; }
+
+    CountBlocks &operator++() {
+      filled_.Produce(current_);
+      free_.Consume(current_);
+      return *this;
+    }
+
+    // This thread is done.
+    void Poison() {
+      free_.Produce(current_);
+      filled_.Produce(util::stream::Block());
+    }
+
+  private:
+    util::PCQueue<util::stream::Block> &free_, &filled_;
+    util::stream::Block current_;
+};
+
+// Remembers the words of a batch in order of appearance.
+class RecordWords {
+  public:
+    explicit RecordWords(std::vector<StringPiece> *words) : words_(words) {}
+    void operator()(const StringPiece &word) { words_->push_back(word); }
+  private:
+    std::vector<StringPiece> *words_;
+};
+
+/* Counts on several threads.  Each takes a batch of lines in turn and gives
+ * the words its own ids, in order of appearance.  The batches then add their
+ * new words to the vocabulary in the order they were read, so words get the
+ * ids they get on one thread and the vocabulary file is the same.  Each
+ * thread combines the n-grams of its batches in its own blocks, which are
+ * copied into the chain as they fill up.  The sort that follows combines
+ * the n-grams of different blocks.
+ */
+class ParallelCount {
+  public:
+    ParallelCount(util::FilePiece &from, ngram::GrowableVocab<ngram::WriteUniqueWords> &vocab, WarningAction &disallowed_symbol_action, const bool *delimiters, std::size_t threads)
+      : from_(from), vocab_(vocab), disallowed_symbol_action_(disallowed_symbol_action), delimiters_(delimiters),
+        threads_(threads), eof_(false), next_read_(0), next_map_(0), failed_(false), token_count_(0),
+        free_(CorpusCount::ThreadBlocks(threads)), filled_(CorpusCount::ThreadBlocks(threads) + threads) {}
+
+    // Leaves the link for the caller to poison, unless counting failed.
+    uint64_t Run(util::stream::Link &link, std::size_t order, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size) {
+      util::scoped_malloc blocks(util::MallocOrThrow(block_size * CorpusCount::ThreadBlocks(threads_)));
+      for (std::size_t i = 0; i < CorpusCount::ThreadBlocks(threads_); ++i) {
+        free_.Produce(util::stream::Block(static_cast<uint8_t*>(blocks.get()) + i * block_size, block_size));
+      }
+
+      boost::thread_group threads;
+      for (std::size_t i = 0; i < threads_; ++i) {
+        threads.create_thread(boost::bind(&ParallelCount::Count, this, order, block_size,
+              static_cast<uint8_t*>(dedupe_mem) + i * dedupe_mem_size, dedupe_mem_size, i == 0 && order == 1));
+      }
+
+      util::stream::Block block;
+      for (std::size_t running = threads_; running; ) {
+        filled_.Consume(block);
+        if (!block) {
+          --running;
+          continue;
+        }
+        if (block.ValidSize()) {
+          memcpy(link->Get(), block.Get(), block.ValidSize());
+          link->SetValidSize(block.ValidSize());
+          ++link;
+        }
+        free_.Produce(block);
+      }
+      threads.join_all();
+      if (failed_) {
+        link.Poison();
+        // as thrown, so a FormatLoadException stays one
+        boost::rethrow_exception(error_);
+      }
+      return token_count_;
+    }
+
+  private:
+    void Count(std::size_t order, std::size_t block_size, void *dedupe_mem, std::size_t dedupe_mem_size, bool add_special_unigrams) {
+      CountBlocks blocks(free_, filled_);
+      Writer<CountBlocks> writer(order, blocks, block_size, dedupe_mem, dedupe_mem_size, add_special_unigrams);
+      try {
+        std::string text;
+        uint64_t sequence = 0;
+        std::vector<StringPiece> words;
+        std::vector<WordIndex> ids, mapping;
+        while (Read(text, sequence)) {
+          words.clear();
+          ids.clear();
+          StringPiece disallowed;
+          uint64_t count = 0;
+          {
+            ngram::GrowableVocab<RecordWords> batch_vocab(1 << 16, RecordWords(&words));
+            for (const char *line = text.data(), *end = text.data() + text.size(); line != end; ) {
+              const char *line_end = static_cast<const char*>(memchr(line, '\n', end - line));
+              for (util::TokenIter<util::BoolCharacter, true> w(StringPiece(line, line_end - line), delimiters_); w; ++w) {
+                WordIndex word = batch_vocab.FindOrInsert(*w);
+                if (word <= 2) {
+                  if (disallowed.empty()) disallowed = *w;
+                  continue;
+                }
+                ids.push_back(word);
+                ++count;
+              }
+              ids.push_back(kEOS);
+              line = line_end + 1;
+            }
+          }
+          if (!Map(sequence, words, disallowed, count, mapping)) break;
+
+          bool start = true;
+          for (std::vector<WordIndex>::const_iterator i = ids.begin(); i != ids.end(); ++i) {
+            if (start) writer.StartSentence();
+            writer.Append(mapping[*i]);
+            start = (*i == kEOS);
+          }
+        }
+      } catch (...) {
+        Fail(boost::current_exception());
+      }
+    }
+
+    // Reads the next batch of lines, each ending in a newline.
+    bool Read(std::string &text, uint64_t &sequence) {
+      boost::mutex::scoped_lock lock(read_mutex_);
+      text.clear();
+      if (eof_ || failed_) return false;
+      try {
+        while (text.size() < kBatchSize) {
+          StringPiece line(from_.ReadLine());
+          text.append(line.data(), line.size());
+          text.push_back('\n');
+        }
+      } catch (const util::EndOfFileException &e) {
+        eof_ = true;
+      }
+      if (text.empty()) return false;
+      sequence = next_read_++;
+      return true;
+    }
+
+    // Adds the words of a batch to the vocabulary once the batches before it did.
+    bool Map(uint64_t sequence, const std::vector<StringPiece> &words, const StringPiece &disallowed, uint64_t count, std::vector<WordIndex> &mapping) {
+      boost::mutex::scoped_lock lock(map_mutex_);
+      while (next_map_ != sequence && !failed_) mapped_.wait(lock);
+      if (failed_) return false;
+      if (!disallowed.empty()) {
+        ComplainDisallowed(disallowed, disallowed_symbol_action_);
+      }
+      mapping.resize(words.size());
+      for (std::size_t i = 0; i < words.size(); ++i) {
+        mapping[i] = vocab_.FindOrInsert(words[i]);
+      }
+      token_count_ += count;
+      ++next_map_;
+      mapped_.notify_all();
+      return true;
+    }
+
+    void Fail(const boost::exception_ptr &error) {
+      boost::mutex::scoped_lock read_lock(read_mutex_);
+      boost::mutex::scoped_lock map_lock(map_mutex_);
+      if (!failed_) error_ = error;
+      failed_ = true;
+      mapped_.notify_all();
+    }
+
+    util::FilePiece &from_;
+    ngram::GrowableVocab<ngram::WriteUniqueWords> &vocab_;
+    WarningAction &disallowed_symbol_action_;
+    const bool *delimiters_;
+    const std::size_t threads_;
+
+    boost::mutex read_mutex_;
+    bool eof_;
+    uint64_t next_read_;
+
+    boost::mutex map_mutex_;
+    boost::condition_variable mapped_;
+    uint64_t next_map_;
+    bool failed_;
+    boost::exception_ptr error_;
+    uint64_t token_count_;
+
+    util::PCQueue<util::stream::Block> free_, filled_;
+};
+
 } // namespace
 
 void CorpusCount::Run(const util::stream::ChainPosition &position) {
@@ -187,26 +402,34 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
   token_count_ = 0;
   type_count_ = 0;
   const WordIndex end_sentence = vocab.FindOrInsert("</s>");
-  Writer writer(NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize()), position, dedupe_mem_.get(), dedupe_mem_size_);
+  const std::size_t order = NGram<BuildingPayload>::OrderFromSize(position.GetChain().EntrySize());
+  util::stream::Link link(position);
+  // On one thread the writer poisons the chain once this is done.
+  util::scoped_ptr<Writer<util::stream::Link> > writer;
   uint64_t count = 0;
   bool delimiters[256];
   util::BoolCharacter::Build("\0\t\n\r ", delimiters);
-  try {
-    while(true) {
-      StringPiece line(from_.ReadLine());
-      writer.StartSentence();
-      for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
-        WordIndex word = vocab.FindOrInsert(*w);
-        if (word <= 2) {
-          ComplainDisallowed(*w, disallowed_symbol_action_);
-          continue;
+  if (threads_ > 1) {
+    count = ParallelCount(from_, vocab, disallowed_symbol_action_, delimiters, threads_).Run(link, order, position.GetChain().BlockSize(), dedupe_mem_.get(), dedupe_mem_size_);
+  } else {
+    writer.reset(new Writer<util::stream::Link>(order, link, position.GetChain().BlockSize(), dedupe_mem_.get(), dedupe_mem_size_, order == 1));
+    try {
+      while(true) {
+        StringPiece line(from_.ReadLine());
+        writer->StartSentence();
+        for (util::TokenIter<util::BoolCharacter, true> w(line, delimiters); w; ++w) {
+          WordIndex word = vocab.FindOrInsert(*w);
+          if (word <= 2) {
+            ComplainDisallowed(*w, disallowed_symbol_action_);
+            continue;
+          }
+          writer->Append(word);
+          ++count;
         }
-        writer.Append(word);
-        ++count;
+        writer->Append(end_sentence);
       }
-      writer.Append(end_sentence);
-    }
-  } catch (const util::EndOfFileException &e) {}
+    } catch (const util::EndOfFileException &e) {}
+  }
   token_count_ = count;
   type_count_ = vocab.Size();
 
@@ -233,6 +456,8 @@ void CorpusCount::Run(const util::stream::ChainPosition &position) {
       abort();
     }
   }
+
+  if (!writer.get()) link.Poison();
 }
 
 } // namespace builder
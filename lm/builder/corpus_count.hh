@@ -25,12 +25,18 @@ class CorpusCount {
     // Memory usage will be DedupeMultipler(order) * block_size + total_chain_size + unknown vocab_hash_size
     static float DedupeMultiplier(std::size_t order);
 
+    // With threads > 1, each thread has its own dedupe table and they also
+    // fill this many blocks of their own, which are copied into the chain.
+    static std::size_t ThreadBlocks(std::size_t threads);
+
     // How much memory vocabulary will use based on estimated size of the vocab.
     static std::size_t VocabUsage(std::size_t vocab_estimate);
 
     // token_count: out.
     // type_count aka vocabulary size.  Initialize to an estimate.  It is set to the exact value.
-    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol);
+    // threads: number of threads that tokenize and count.  The output is the
+    // same for any number, up to the order of n-grams within the chain.
+    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::vector<bool> &prune_words, const std::string& prune_vocab_filename, std::size_t entries_per_block, WarningAction disallowed_symbol, std::size_t threads = 1);
 
     void Run(const util::stream::ChainPosition &position);
 
@@ -40,12 +46,14 @@ class CorpusCount {
     uint64_t &token_count_;
     WordIndex &type_count_;
     std::vector<bool>& prune_words_;
-    const std::string& prune_vocab_filename_;
+    const std::string prune_vocab_filename_;
 
     std::size_t dedupe_mem_size_;
     util::scoped_malloc dedupe_mem_;
 
     WarningAction disallowed_symbol_action_;
+
+    std::size_t threads_;
 };
 
 } // namespace builder
@@ -13,6 +13,10 @@
 #define BOOST_TEST_MODULE CorpusCountTest
 #include <boost/test/unit_test.hpp>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace lm { namespace builder { namespace {
 
 #define Check(str, cnt) { \
@@ -76,4 +80,64 @@ BOOST_AUTO_TEST_CASE(Short) {
   BOOST_CHECK_EQUAL(sizeof(v) / sizeof(const char*), type_count);
 }
 
+typedef std::map<std::vector<WordIndex>, uint64_t> Counts;
+
+// Counts the text on threads and adds up the counts of each n-gram.
+void CountOnThreads(const std::string &text, std::size_t threads, Counts &counts, std::string &vocab_words, uint64_t &token_count, WordIndex &type_count) {
+  util::scoped_fd input_file(util::MakeTemp("corpus_count_test_temp"));
+  util::WriteOrThrow(input_file.get(), text.data(), text.size());
+  util::FilePiece input_piece(input_file.release(), "temp file");
+
+  util::stream::ChainConfig config;
+  config.entry_size = NGram<BuildingPayload>::TotalSize(3);
+  config.total_memory = config.entry_size * 4096;
+  config.block_count = 2;
+
+  util::scoped_fd vocab(util::MakeTemp("corpus_count_test_vocab"));
+
+  {
+    util::stream::Chain chain(config);
+    type_count = 10;
+    std::vector<bool> prune_words;
+    CorpusCount counter(input_piece, vocab.get(), token_count, type_count, prune_words, "", chain.BlockSize() / chain.EntrySize(), SILENT, threads);
+    chain >> boost::ref(counter);
+    NGramStream<BuildingPayload> stream(chain.Add());
+    chain >> util::stream::kRecycle;
+    for (; stream; ++stream) {
+      counts[std::vector<WordIndex>(stream->begin(), stream->end())] += stream->Value().count;
+    }
+  }
+
+  util::SeekOrThrow(vocab.get(), 0);
+  vocab_words.resize(util::SizeOrThrow(vocab.get()));
+  util::ReadOrThrow(vocab.get(), &vocab_words[0], vocab_words.size());
+}
+
+BOOST_AUTO_TEST_CASE(Threads) {
+  // Enough text for several batches.
+  std::string text;
+  uint32_t state = 1;
+  while (text.size() < (10 << 20)) {
+    state = state * 1103515245 + 12345;
+    const std::size_t length = (state >> 16) % 20;
+    for (std::size_t i = 0; i < length; ++i) {
+      state = state * 1103515245 + 12345;
+      text += "w" + std::string(1, 'a' + (state >> 16) % 8) + std::string(1, 'a' + (state >> 24) % 4) + " ";
+    }
+    text += "\n";
+  }
+
+  Counts serial, parallel;
+  std::string serial_vocab, parallel_vocab;
+  uint64_t serial_tokens, parallel_tokens;
+  WordIndex serial_types, parallel_types;
+  CountOnThreads(text, 1, serial, serial_vocab, serial_tokens, serial_types);
+  CountOnThreads(text, 3, parallel, parallel_vocab, parallel_tokens, parallel_types);
+
+  BOOST_CHECK_EQUAL(serial_tokens, parallel_tokens);
+  BOOST_CHECK_EQUAL(serial_types, parallel_types);
+  BOOST_CHECK(serial_vocab == parallel_vocab);
+  BOOST_CHECK(serial == parallel);
+}
+
 }}} // namespaces
@@ -72,7 +72,9 @@ int main(int argc, char *argv[]) {
     po::options_description options("Language model building options");
     lm::builder::PipelineConfig pipeline;
 
-    std::string text, intermediate, arpa;
+    std::string text, intermediate, arpa, binary, binary_type;
+    float probing_multiplier;
+    int quantize_prob, quantize_backoff, array_pointers;
     std::vector<std::string> pruning;
     std::vector<std::string> discount_fallback;
     std::vector<std::string> discount_fallback_default;
@@ -95,12 +97,19 @@ int main(int argc, char *argv[]) {
       ("minimum_block", lm::SizeOption(pipeline.minimum_block, "8K"), "Minimum block size to allow")
       ("sort_block", lm::SizeOption(pipeline.sort.buffer_size, "64M"), "Size of IO operations for sort (determines arity)")
       ("block_count", po::value<std::size_t>(&pipeline.block_count)->default_value(2), "Block count (per order)")
+      ("count_threads", po::value<std::size_t>(&pipeline.count_threads)->default_value(1), "Threads that tokenize and count the corpus in step 1.  Each uses 4M of text at a time, and a dedupe table and two blocks out of the sorting memory")
       ("vocab_estimate", po::value<lm::WordIndex>(&pipeline.vocab_estimate)->default_value(1000000), "Assume this vocabulary size for purposes of calculating memory in step 1 (corpus count) and pre-sizing the hash table")
       ("vocab_pad", po::value<uint64_t>(&pipeline.vocab_size_for_unk)->default_value(0), "If the vocabulary is smaller than this value, pad with <unk> to reach this size. Requires --interpolate_unigrams")
       ("verbose_header", po::bool_switch(&verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
       ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
       ("intermediate", po::value<std::string>(&intermediate), "Write ngrams to intermediate files.  Turns off ARPA output (which can be reactivated by --arpa file).  Forces --renumber on.")
+      ("binary", po::value<std::string>(&binary), "Build a KenLM binary file directly, without writing ARPA and running build_binary.  Turns off ARPA output (which can be reactivated by --arpa file).")
+      ("binary_type", po::value<std::string>(&binary_type)->default_value("probing"), "Data structure of the --binary file: probing or trie.  The trie forces --renumber on.")
+      ("probing_multiplier", po::value<float>(&probing_multiplier)->default_value(1.5), "Space multiplier for the probing hash tables, as build_binary -p")
+      ("quantize", po::value<int>(&quantize_prob)->default_value(0), "Quantize trie probabilities to this many bits, as build_binary -q.  0 (default) does not quantize.")
+      ("quantize_backoff", po::value<int>(&quantize_backoff)->default_value(0), "Quantize trie backoffs to this many bits, as build_binary -b.  Defaults to --quantize.")
+      ("array_pointers", po::value<int>(&array_pointers)->default_value(0), "Compress trie pointers, using at most this many bits for the offset array, as build_binary -a.  0 (default) does not compress.")
       ("renumber", po::bool_switch(&pipeline.renumber_vocabulary), "Rrenumber the vocabulary identifiers so that they are monotone with the hash of each string.  This is consistent with the ordering used by the trie data structure.")
       ("collapse_values", po::bool_switch(&pipeline.output_q), "Collapse probability and backoff into a single value, q that yields the same sentence-level probabilities.  See http://kheafield.com/professional/edinburgh/rest_paper.pdf for more details, including a proof.")
       ("prune", po::value<std::vector<std::string> >(&pruning)->multitoken(), "Prune n-grams with count less than or equal to the given threshold.  Specify one value for each order i.e. 0 0 1 to prune singleton trigrams and above.  The sequence of values must be non-decreasing and the last value applies to any remaining orders. Default is to not prune, which is equivalent to --prune 0.")
@@ -180,6 +189,45 @@ int main(int argc, char *argv[]) {
 
     util::NormalizeTempPrefix(pipeline.sort.temp_prefix);
 
+    bool writing_binary = vm.count("binary");
+    lm::ngram::ModelType model_type = lm::ngram::PROBING;
+    lm::ngram::Config binary_config;
+    if (writing_binary) {
+      if (pipeline.output_q) {
+        std::cerr << "--binary does not support --collapse_values" << std::endl;
+        return 1;
+      }
+      if (!quantize_backoff) quantize_backoff = quantize_prob;
+      if (binary_type == "probing") {
+        if (quantize_prob || array_pointers) {
+          std::cerr << "--quantize and --array_pointers require --binary_type trie" << std::endl;
+          return 1;
+        }
+        binary_config.probing_multiplier = probing_multiplier;
+        // Like build_binary, keep the hash tables in memory until they are done.
+        binary_config.write_method = lm::ngram::Config::WRITE_AFTER;
+      } else if (binary_type == "trie") {
+        model_type = lm::ngram::TRIE;
+        if (quantize_prob) {
+          model_type = static_cast<lm::ngram::ModelType>(model_type + lm::ngram::kQuantAdd);
+          binary_config.prob_bits = quantize_prob;
+          binary_config.backoff_bits = quantize_backoff;
+        }
+        if (array_pointers) {
+          model_type = static_cast<lm::ngram::ModelType>(model_type + lm::ngram::kArrayAdd);
+          binary_config.pointer_bhiksha_bits = array_pointers;
+        }
+        binary_config.write_method = lm::ngram::Config::WRITE_MMAP;
+        // The trie expects n-grams in the order of the renumbered vocabulary.
+        pipeline.renumber_vocabulary = true;
+      } else {
+        std::cerr << "Unknown --binary_type " << binary_type << ".  Use probing or trie." << std::endl;
+        return 1;
+      }
+      binary_config.temporary_directory_prefix = pipeline.sort.temp_prefix.c_str();
+      binary_config.building_memory = pipeline.sort.total_memory;
+    }
+
     lm::builder::InitialProbabilitiesConfig &initial = pipeline.initial_probs;
     // TODO: evaluate options for these.
     initial.adder_in.total_memory = 32768;
@@ -203,9 +251,12 @@ int main(int argc, char *argv[]) {
         pipeline.renumber_vocabulary = true;
       }
       lm::builder::Output output(writing_intermediate ? intermediate : pipeline.sort.temp_prefix, writing_intermediate, pipeline.output_q);
-      if (!writing_intermediate || vm.count("arpa")) {
+      if ((!writing_intermediate && !writing_binary) || vm.count("arpa")) {
         output.Add(new lm::builder::PrintHook(out.release(), verbose_header));
       }
+      if (writing_binary) {
+        output.Add(new lm::builder::BinaryHook(binary, model_type, binary_config));
+      }
       lm::builder::Pipeline(pipeline, in.release(), output);
     } catch (const util::MallocException &e) {
       std::cerr << e.what() << std::endl;
@@ -1,22 +1,33 @@
 #include "lm/builder/output.hh"
 
+#include "lm/builder/payload.hh"
 #include "lm/common/model_buffer.hh"
 #include "lm/common/print.hh"
+#include "lm/model.hh"
+#include "lm/read_intermediate.hh"
 #include "util/file_stream.hh"
 #include "util/stream/multi_stream.hh"
 
 #include <iostream>
+#include <vector>
 
 namespace lm { namespace builder {
 
+namespace {
+// Steps of the pipeline before those of the output.
+const unsigned int kEstimateSteps = 4;
+} // namespace
+
 OutputHook::~OutputHook() {}
 
+BufferHook::~BufferHook() {}
+
 Output::Output(StringPiece file_base, bool keep_buffer, bool output_q)
   : buffer_(file_base, keep_buffer, output_q) {}
 
 void Output::SinkProbs(util::stream::Chains &chains) {
   Apply(PROB_PARALLEL_HOOK, chains);
-  if (!buffer_.Keep() && !Have(PROB_SEQUENTIAL_HOOK)) {
+  if (!buffer_.Keep() && !Have(PROB_SEQUENTIAL_HOOK) && buffer_hooks_.empty()) {
     chains >> util::stream::kRecycle;
     chains.Wait(true);
     return;
@@ -24,12 +35,20 @@ void Output::SinkProbs(util::stream::Chains &chains) {
   buffer_.Sink(chains, header_.counts_pruned);
   chains >> util::stream::kRecycle;
   chains.Wait(false);
+  const unsigned int total_steps = kEstimateSteps + Steps();
   if (Have(PROB_SEQUENTIAL_HOOK)) {
-    std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+    std::cerr << "=== " << (kEstimateSteps + 1) << "/" << total_steps << " Writing ARPA model ===" << std::endl;
     buffer_.Source(chains);
     Apply(PROB_SEQUENTIAL_HOOK, chains);
     chains >> util::stream::kRecycle;
-    chains.Wait(true);
+  }
+  // Release the chain memory for building binary models.
+  chains.Wait(true);
+  if (!buffer_hooks_.empty()) {
+    std::cerr << "=== " << total_steps << "/" << total_steps << " Building binary model ===" << std::endl;
+    for (boost::ptr_vector<BufferHook>::iterator hook = buffer_hooks_.begin(); hook != buffer_hooks_.end(); ++hook) {
+      hook->Sink(header_, buffer_);
+    }
   }
 }
 
@@ -49,4 +68,33 @@ void PrintHook::Sink(const HeaderInfo &info, int vocab_file, util::stream::Chain
   chains >> PrintARPA(vocab_file, file_.get(), info.counts_pruned);
 }
 
+void BinaryHook::Sink(const HeaderInfo &/*info*/, const ModelBuffer &buffer) {
+  std::vector<int> files;
+  for (std::size_t i = 0; i < buffer.Order(); ++i) {
+    files.push_back(buffer.NGramFile(i));
+  }
+  IntermediateReader reader(buffer.VocabFile(), files, buffer.Counts(), sizeof(BuildingPayload), file_);
+  ngram::Config config(config_);
+  config.write_mmap = file_.c_str();
+  switch (type_) {
+    case ngram::PROBING:
+      ngram::ProbingModel(reader, config);
+      break;
+    case ngram::TRIE:
+      ngram::TrieModel(reader, config);
+      break;
+    case ngram::QUANT_TRIE:
+      ngram::QuantTrieModel(reader, config);
+      break;
+    case ngram::ARRAY_TRIE:
+      ngram::ArrayTrieModel(reader, config);
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      ngram::QuantArrayTrieModel(reader, config);
+      break;
+    default:
+      UTIL_THROW(util::Exception, "Building " << ngram::kModelNames[type_] << " directly is not supported");
+  }
+}
+
 }} // namespaces
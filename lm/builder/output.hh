@@ -3,11 +3,15 @@
 
 #include "lm/builder/header_info.hh"
 #include "lm/common/model_buffer.hh"
+#include "lm/config.hh"
+#include "lm/model_type.hh"
 #include "util/file.hh"
 
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/utility.hpp>
 
+#include <string>
+
 namespace util { namespace stream { class Chains; class ChainPositions; } }
 
 /* Outputs from lmplz: ARPA, sharded files, etc */
@@ -35,6 +39,14 @@ class OutputHook {
     HookType type_;
 };
 
+// Reads the files of the model buffer once all the n-grams are in them.
+class BufferHook {
+  public:
+    virtual ~BufferHook();
+
+    virtual void Sink(const HeaderInfo &info, const ModelBuffer &buffer) = 0;
+};
+
 class Output : boost::noncopyable {
   public:
     Output(StringPiece file_base, bool keep_buffer, bool output_q);
@@ -44,6 +56,11 @@ class Output : boost::noncopyable {
       outputs_[hook->Type()].push_back(hook);
     }
 
+    // Takes ownership.
+    void Add(BufferHook *hook) {
+      buffer_hooks_.push_back(hook);
+    }
+
     bool Have(HookType hook_type) const {
       return !outputs_[hook_type].empty();
     }
@@ -56,7 +73,7 @@ class Output : boost::noncopyable {
     // This is called by the pipeline.
     void SinkProbs(util::stream::Chains &chains);
 
-    unsigned int Steps() const { return Have(PROB_SEQUENTIAL_HOOK); }
+    unsigned int Steps() const { return Have(PROB_SEQUENTIAL_HOOK) + !buffer_hooks_.empty(); }
 
   private:
     void Apply(HookType hook_type, util::stream::Chains &chains);
@@ -64,6 +81,7 @@ class Output : boost::noncopyable {
     ModelBuffer buffer_;
 
     boost::ptr_vector<OutputHook> outputs_[NUMBER_OF_HOOKS];
+    boost::ptr_vector<BufferHook> buffer_hooks_;
     HeaderInfo header_;
 };
 
@@ -80,6 +98,22 @@ class PrintHook : public OutputHook {
     bool verbose_header_;
 };
 
+// Builds a binary model (lm/model.hh) like build_binary does, but from the
+// model buffer instead of parsing ARPA.
+class BinaryHook : public BufferHook {
+  public:
+    // file takes the place of config.write_mmap.
+    BinaryHook(const std::string &file, ngram::ModelType type, const ngram::Config &config)
+      : file_(file), type_(type), config_(config) {}
+
+    void Sink(const HeaderInfo &info, const ModelBuffer &buffer);
+
+  private:
+    std::string file_;
+    ngram::ModelType type_;
+    ngram::Config config_;
+};
+
 }} // namespaces
 
 #endif // LM_BUILDER_OUTPUT_H
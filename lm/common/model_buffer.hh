@@ -44,6 +44,9 @@ class ModelBuffer {
     }
 
     int VocabFile() const { return vocab_file_.get(); }
+
+    // The n-grams of one order.  Requires Sink or load from file.
+    int NGramFile(std::size_t order_minus_1) const { return files_[order_minus_1].get(); }
     int StealVocabFile() { return vocab_file_.release(); }
 
     bool Keep() const { return keep_buffer_; }
@@ -4,6 +4,9 @@
 #include "util/file_piece.hh"
 #include "util/usage.hh"
 
+#include <algorithm>
+#include <vector>
+
 #include <stdint.h>
 
 namespace {
@@ -67,53 +70,108 @@ template <class Model, class Width> void QueryFromBytes(const Model &model, int
   std::cout << "RSSMax: " << util::RSSMax() << std::endl;
 }
 
-template <class Model, class Width> void DispatchFunction(const Model &model, bool query) {
-  if (query) {
-    QueryFromBytes<Model, Width>(model, 0);
-  } else {
-    ConvertToBytes<Model, Width>(model, 0);
+// Compare FullScore with FullScoreBatch at increasing batch sizes.  States
+// are computed up front so every query in the text is independent.
+template <class Model, class Width> void BatchFromBytes(const Model &model, int fd_in) {
+  std::vector<lm::WordIndex> words;
+  Width buf[4096];
+  while (std::size_t got = util::ReadOrEOF(fd_in, buf, sizeof(buf))) {
+    UTIL_THROW_IF2(got % sizeof(Width), "File size not a multiple of vocab id size " << sizeof(Width));
+    words.insert(words.end(), buf, buf + got / sizeof(Width));
+  }
+  UTIL_THROW_IF2(words.empty(), "No queries in input");
+
+  const lm::WordIndex kEOS = model.GetVocabulary().EndSentence();
+  std::vector<lm::ngram::State> states(words.size() + 1);
+  std::vector<lm::ngram::BatchQuery> queries(words.size());
+  const lm::ngram::State *in_state = &model.BeginSentenceState();
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    queries[i].in_state = in_state;
+    queries[i].new_word = words[i];
+    model.FullScore(*in_state, words[i], states[i]);
+    in_state = (words[i] == kEOS) ? &model.BeginSentenceState() : &states[i];
+  }
+  std::vector<lm::ngram::State> out_states(queries.size());
+  std::vector<lm::FullScoreReturn> out(queries.size());
+
+  double before = util::WallTime();
+  double total = 0.0;
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    total += model.FullScore(*queries[i].in_state, queries[i].new_word, out_states[i]).prob;
+  }
+  double after = util::WallTime();
+  std::cerr << "Probability sum is " << total << std::endl;
+  std::cout << "Queries: " << queries.size() << '\n'
+    << "FullScore queries/s: " << (static_cast<double>(queries.size()) / (after - before)) << std::endl;
+
+  for (std::size_t batch = 1; batch <= 256; batch *= 2) {
+    before = util::WallTime();
+    for (std::size_t i = 0; i < queries.size(); i += batch) {
+      model.FullScoreBatch(&queries[i], std::min(batch, queries.size() - i), &out_states[i], &out[i]);
+    }
+    after = util::WallTime();
+    total = 0.0;
+    for (std::size_t i = 0; i < out.size(); ++i) total += out[i].prob;
+    std::cerr << "Probability sum is " << total << std::endl;
+    std::cout << "Batch " << batch << " queries/s: " << (static_cast<double>(queries.size()) / (after - before)) << std::endl;
   }
 }
 
-template <class Model> void DispatchWidth(const char *file, bool query) {
+enum Mode { VOCAB, QUERY, BATCH };
+
+template <class Model, class Width> void DispatchFunction(const Model &model, Mode mode) {
+  switch (mode) {
+    case VOCAB:
+      ConvertToBytes<Model, Width>(model, 0);
+      break;
+    case QUERY:
+      QueryFromBytes<Model, Width>(model, 0);
+      break;
+    case BATCH:
+      BatchFromBytes<Model, Width>(model, 0);
+      break;
+  }
+}
+
+template <class Model> void DispatchWidth(const char *file, Mode mode) {
   lm::ngram::Config config;
   config.load_method = util::READ;
   std::cerr << "Using load_method = READ." << std::endl;
   Model model(file, config);
   lm::WordIndex bound = model.GetVocabulary().Bound();
   if (bound <= 256) {
-    DispatchFunction<Model, uint8_t>(model, query);
+    DispatchFunction<Model, uint8_t>(model, mode);
   } else if (bound <= 65536) {
-    DispatchFunction<Model, uint16_t>(model, query);
+    DispatchFunction<Model, uint16_t>(model, mode);
   } else if (bound <= (1ULL << 32)) {
-    DispatchFunction<Model, uint32_t>(model, query);
+    DispatchFunction<Model, uint32_t>(model, mode);
   } else {
-    DispatchFunction<Model, uint64_t>(model, query);
+    DispatchFunction<Model, uint64_t>(model, mode);
   }
 }
 
-void Dispatch(const char *file, bool query) {
+void Dispatch(const char *file, Mode mode) {
   using namespace lm::ngram;
   lm::ngram::ModelType model_type;
   if (lm::ngram::RecognizeBinary(file, model_type)) {
     switch(model_type) {
       case PROBING:
-        DispatchWidth<lm::ngram::ProbingModel>(file, query);
+        DispatchWidth<lm::ngram::ProbingModel>(file, mode);
         break;
       case REST_PROBING:
-        DispatchWidth<lm::ngram::RestProbingModel>(file, query);
+        DispatchWidth<lm::ngram::RestProbingModel>(file, mode);
         break;
       case TRIE:
-        DispatchWidth<lm::ngram::TrieModel>(file, query);
+        DispatchWidth<lm::ngram::TrieModel>(file, mode);
         break;
       case QUANT_TRIE:
-        DispatchWidth<lm::ngram::QuantTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantTrieModel>(file, mode);
         break;
       case ARRAY_TRIE:
-        DispatchWidth<lm::ngram::ArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::ArrayTrieModel>(file, mode);
         break;
       case QUANT_ARRAY_TRIE:
-        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, query);
+        DispatchWidth<lm::ngram::QuantArrayTrieModel>(file, mode);
         break;
       default:
         UTIL_THROW(util::Exception, "Unrecognized kenlm model type " << model_type);
@@ -126,7 +184,7 @@ void Dispatch(const char *file, bool query) {
 } // namespace
 
 int main(int argc, char *argv[]) {
-  if (argc != 3 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query"))) {
+  if (argc != 3 || (strcmp(argv[1], "vocab") && strcmp(argv[1], "query") && strcmp(argv[1], "batch"))) {
     std::cerr
       << "Benchmark program for KenLM.  Intended usage:\n"
       << "#Convert text to vocabulary ids offline.  These ids are tied to a model.\n"
@@ -134,9 +192,17 @@ int main(int argc, char *argv[]) {
       << "#Ensure files are in RAM.\n"
       << "cat $text.vocab $model >/dev/null\n"
       << "#Timed query against the model.\n"
-      << argv[0] << " query $model <$text.vocab\n";
+      << argv[0] << " query $model <$text.vocab\n"
+      << "#Queries/s of FullScore and FullScoreBatch with batch sizes 1 to 256.\n"
+      << argv[0] << " batch $model <$text.vocab\n";
     return 1;
   }
-  Dispatch(argv[2], !strcmp(argv[1], "query"));
+  Mode mode = VOCAB;
+  if (!strcmp(argv[1], "query")) {
+    mode = QUERY;
+  } else if (!strcmp(argv[1], "batch")) {
+    mode = BATCH;
+  }
+  Dispatch(argv[2], mode);
   return 0;
 }
@@ -5,6 +5,7 @@
 #include "lm/search_hashed.hh"
 #include "lm/search_trie.hh"
 #include "lm/read_arpa.hh"
+#include "lm/read_intermediate.hh"
 #include "util/have.hh"
 #include "util/murmur_hash.hh"
 
@@ -75,7 +76,15 @@ template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::Ge
     ComplainAboutARPA(init_config, kModelType);
     InitializeFromARPA(fd.release(), file, init_config);
   }
+  InitializeStates();
+}
+
+template <class Search, class VocabularyT> GenericModel<Search, VocabularyT>::GenericModel(IntermediateReader &reader, const Config &config) : backing_(config) {
+  InitializeFromSource(reader, reader.FileName(), config);
+  InitializeStates();
+}
 
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::InitializeStates() {
   // g++ prints warnings unless these are fully initialized.
   State begin_sentence = State();
   begin_sentence.length = 1;
@@ -93,44 +102,48 @@ template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT
   // Backing file is the ARPA.
   util::FilePiece f(fd, file, config.ProgressMessages());
   try {
-    std::vector<uint64_t> counts;
-    // File counts do not include pruned trigrams that extend to quadgrams etc.   These will be fixed by search_.
-    ReadARPACounts(f, counts);
-    CheckCounts(counts);
-    if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
-    if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
-
-    std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
-    // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
-    vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
-
-    if (config.write_mmap && config.include_vocab) {
-      WriteWordsWrapper wrap(config.enumerate_vocab);
-      vocab_.ConfigureEnumerate(&wrap, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
-      void *vocab_rebase, *search_rebase;
-      backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
-      // Due to writing at the end of file, mmap may have relocated data.  So remap.
-      vocab_.Relocate(vocab_rebase);
-      search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
-    } else {
-      vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
-      search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
-    }
-
-    if (!vocab_.SawUnk()) {
-      assert(config.unknown_missing != THROW_UP);
-      // Default probabilities for unknown.
-      search_.UnknownUnigram().backoff = 0.0;
-      search_.UnknownUnigram().prob = config.unknown_missing_logprob;
-    }
-    backing_.FinishFile(config, kModelType, kVersion, counts);
+    InitializeFromSource(f, file, config);
   } catch (util::Exception &e) {
     e << " Byte: " << f.Offset();
     throw;
   }
 }
 
+template <class Search, class VocabularyT> template <class Source> void GenericModel<Search, VocabularyT>::InitializeFromSource(Source &f, const char *file, const Config &config) {
+  std::vector<uint64_t> counts;
+  // File counts do not include pruned trigrams that extend to quadgrams etc.   These will be fixed by search_.
+  ReadARPACounts(f, counts);
+  CheckCounts(counts);
+  if (counts.size() < 2) UTIL_THROW(FormatLoadException, "This ngram implementation assumes at least a bigram model.");
+  if (config.probing_multiplier <= 1.0) UTIL_THROW(ConfigException, "probing multiplier must be > 1.0");
+
+  std::size_t vocab_size = util::CheckOverflow(VocabularyT::Size(counts[0], config));
+  // Setup the binary file for writing the vocab lookup table.  The search_ is responsible for growing the binary file to its needs.
+  vocab_.SetupMemory(backing_.SetupJustVocab(vocab_size, counts.size()), vocab_size, counts[0], config);
+
+  if (config.write_mmap && config.include_vocab) {
+    WriteWordsWrapper wrap(config.enumerate_vocab);
+    vocab_.ConfigureEnumerate(&wrap, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+    void *vocab_rebase, *search_rebase;
+    backing_.WriteVocabWords(wrap.Buffer(), vocab_rebase, search_rebase);
+    // Due to writing at the end of file, mmap may have relocated data.  So remap.
+    vocab_.Relocate(vocab_rebase);
+    search_.SetupMemory(reinterpret_cast<uint8_t*>(search_rebase), counts, config);
+  } else {
+    vocab_.ConfigureEnumerate(config.enumerate_vocab, counts[0]);
+    search_.InitializeFromARPA(file, f, counts, config, vocab_, backing_);
+  }
+
+  if (!vocab_.SawUnk()) {
+    assert(config.unknown_missing != THROW_UP);
+    // Default probabilities for unknown.
+    search_.UnknownUnigram().backoff = 0.0;
+    search_.UnknownUnigram().prob = config.unknown_missing_logprob;
+  }
+  backing_.FinishFile(config, kModelType, kVersion, counts);
+}
+
 template <class Search, class VocabularyT> FullScoreReturn GenericModel<Search, VocabularyT>::FullScore(const State &in_state, const WordIndex new_word, State &out_state) const {
   FullScoreReturn ret = ScoreExceptBackoff(in_state.words, in_state.words + in_state.length, new_word, out_state);
   for (const float *i = in_state.backoff + ret.ngram_length - 1; i < in_state.backoff + in_state.length; ++i) {
@@ -237,6 +250,85 @@ void CopyRemainingHistory(const WordIndex *from, State &out_state) {
 }
 } // namespace
 
+template <class Search, class VocabularyT> void GenericModel<Search, VocabularyT>::FullScoreBatch(const BatchQuery *queries, std::size_t size, State *out_states, FullScoreReturn *out) const {
+  // Chunked so the bookkeeping stays on the stack.  64 queries in flight is
+  // already more than the memory system will overlap.
+  const std::size_t kChunk = 64;
+  typename Search::Node node[kChunk];
+  // Queries in this chunk that may still match a longer n-gram.
+  std::size_t live[kChunk];
+  for (std::size_t chunk = 0; chunk < size; chunk += kChunk) {
+    const std::size_t count = std::min(kChunk, size - chunk);
+    const BatchQuery *query = queries + chunk;
+    State *out_state = out_states + chunk;
+    FullScoreReturn *ret = out + chunk;
+
+    for (std::size_t i = 0; i < count; ++i) {
+      search_.PrefetchUnigram(query[i].new_word);
+    }
+
+    // Unigrams, as in ScoreExceptBackoff.
+    std::size_t live_count = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      ret[i].ngram_length = 1;
+      typename Search::UnigramPointer uni(search_.LookupUnigram(query[i].new_word, node[i], ret[i].independent_left, ret[i].extend_left));
+      out_state[i].backoff[0] = uni.Backoff();
+      ret[i].prob = uni.Prob();
+      ret[i].rest = uni.Rest();
+      out_state[i].length = HasExtension(out_state[i].backoff[0]) ? 1 : 0;
+      out_state[i].words[0] = query[i].new_word;
+      if (query[i].in_state->length && !ret[i].independent_left) {
+        PrefetchResume(0, query[i].in_state->words[0], node[i]);
+        live[live_count++] = i;
+      }
+    }
+
+    // Bigrams and above, one order per pass, as in ResumeScore.
+    for (unsigned char order_minus_2 = 0; live_count; ++order_minus_2) {
+      std::size_t still_live = 0;
+      for (std::size_t l = 0; l < live_count; ++l) {
+        const std::size_t i = live[l];
+        const State &in_state = *query[i].in_state;
+        const WordIndex word = in_state.words[order_minus_2];
+        if (order_minus_2 == P::Order() - 2) {
+          ret[i].independent_left = true;
+          typename Search::LongestPointer longest(search_.LookupLongest(word, node[i]));
+          if (longest.Found()) {
+            ret[i].prob = longest.Prob();
+            ret[i].rest = ret[i].prob;
+            ret[i].ngram_length = P::Order();
+          }
+          continue;
+        }
+        typename Search::MiddlePointer pointer(search_.LookupMiddle(order_minus_2, word, node[i], ret[i].independent_left, ret[i].extend_left));
+        if (!pointer.Found()) continue;
+        float *backoff_out = out_state[i].backoff + 1 + order_minus_2;
+        *backoff_out = pointer.Backoff();
+        ret[i].prob = pointer.Prob();
+        ret[i].rest = pointer.Rest();
+        ret[i].ngram_length = order_minus_2 + 2;
+        if (HasExtension(*backoff_out)) {
+          out_state[i].length = ret[i].ngram_length;
+        }
+        if (order_minus_2 + 1 < in_state.length && !ret[i].independent_left) {
+          PrefetchResume(order_minus_2 + 1, in_state.words[order_minus_2 + 1], node[i]);
+          live[still_live++] = i;
+        }
+      }
+      live_count = still_live;
+    }
+
+    // Finish as in FullScore.
+    for (std::size_t i = 0; i < count; ++i) {
+      const State &in_state = *query[i].in_state;
+      CopyRemainingHistory(in_state.words, out_state[i]);
+      for (const float *b = in_state.backoff + ret[i].ngram_length - 1; b < in_state.backoff + in_state.length; ++b) {
+        ret[i].prob += *b;
+      }
+    }
+  }
+}
+
 /* Ugly optimized function.  Produce a score excluding backoff.
  * The search goes in increasing order of ngram length.
  * Context goes backward, so context_begin is the word immediately preceeding
@@ -22,7 +22,15 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class IntermediateReader;
 namespace ngram {
+
+// One query for FullScoreBatch: score new_word following *in_state.
+struct BatchQuery {
+  const State *in_state;
+  WordIndex new_word;
+};
+
 namespace detail {
 
 // Should return the same results as SRI.
@@ -50,12 +58,28 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     explicit GenericModel(const char *file, const Config &config = Config());
 
+    /* Build from the n-grams estimated by lmplz without going through ARPA.
+     * Set config.write_mmap to save the model as a binary file.  See
+     * lm/read_intermediate.hh.
+     */
+    explicit GenericModel(IntermediateReader &reader, const Config &config = Config());
+
     /* Score p(new_word | in_state) and incorporate new_word into out_state.
      * Note that in_state and out_state must be different references:
      * &in_state != &out_state.
      */
     FullScoreReturn FullScore(const State &in_state, const WordIndex new_word, State &out_state) const;
 
+    /* Score many independent queries at once.  Same results as calling
+     * out[i] = FullScore(*queries[i].in_state, queries[i].new_word, out_states[i])
+     * for each i in [0, size), but the lookups proceed one n-gram order at a
+     * time across the batch and the entries for the next order are prefetched
+     * while the rest of the batch is looked up.  This hides cache misses when
+     * the queries do not depend on each other, e.g. extending many
+     * hypotheses.  out_states must not alias any in_state.
+     */
+    void FullScoreBatch(const BatchQuery *queries, std::size_t size, State *out_states, FullScoreReturn *out) const;
+
     /* Slower call without in_state.  Try to remember state, but sometimes it
      * would cost too much memory or your decoder isn't setup properly.
      * To use this function, make an array of WordIndex containing the context
@@ -75,6 +99,15 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     void GetState(const WordIndex *context_rbegin, const WordIndex *context_rend, State &out_state) const;
 
+    /* Hint that FullScore(in_state, new_word, ...) will be called soon.  This
+     * issues prefetches for the memory the query will touch and returns
+     * immediately, so callers with many independent queries can prefetch all
+     * of them before scoring any.
+     */
+    void Prefetch(const State &in_state, const WordIndex new_word) const {
+      search_.Prefetch(new_word, in_state.words, in_state.words + in_state.length);
+    }
+
     /* More efficient version of FullScore where a partial n-gram has already
      * been scored.
      * NOTE: THE RETURNED .rest AND .prob ARE RELATIVE TO THE .rest RETURNED BEFORE.
@@ -105,6 +138,15 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
   private:
     FullScoreReturn ScoreExceptBackoff(const WordIndex *const context_rbegin, const WordIndex *const context_rend, const WordIndex new_word, State &out_state) const;
 
+    // Prefetch for the ResumeScore iteration at order_minus_2.
+    void PrefetchResume(unsigned char order_minus_2, WordIndex word, const typename Search::Node &node) const {
+      if (order_minus_2 == P::Order() - 2) {
+        search_.PrefetchLongest(word, node);
+      } else {
+        search_.PrefetchMiddle(order_minus_2, word, node);
+      }
+    }
+
     // Score bigrams and above.  Do not include backoff.
     void ResumeScore(const WordIndex *context_rbegin, const WordIndex *const context_rend, unsigned char starting_order_minus_2, typename Search::Node &node, float *backoff_out, unsigned char &next_use, FullScoreReturn &ret) const;
 
@@ -113,6 +155,12 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 
     void InitializeFromARPA(int fd, const char *file, const Config &config);
 
+    // Source is util::FilePiece or IntermediateReader.
+    template <class Source> void InitializeFromSource(Source &f, const char *file, const Config &config);
+
+    // Called by the constructors once the model is loaded.
+    void InitializeStates();
+
     float InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const;
 
     BinaryFormat backing_;
@@ -131,6 +179,7 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 class name : public from {\
   public:\
     name(const char *file, const Config &config = Config()) : from(file, config) {}\
+    name(IntermediateReader &reader, const Config &config = Config()) : from(reader, config) {}\
 };
 
 LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue> LM_COMMA() ProbingVocabulary>);
@@ -278,6 +278,40 @@ template <class M> void Stateless(const M &model) {
   BOOST_CHECK_EQUAL(static_cast<WordIndex>(0), state.words[0]);
 }
 
+template <class M> void BatchTest(const M &model) {
+  const char *words[] = {"<s>", "looking", "on", "a", "little", "the", "biarritz", "not_found", "more", ".", "</s>"};
+  const size_t num_words = sizeof(words) / sizeof(const char*);
+  // States along the sentence, so there are contexts of every length.
+  std::vector<State> states(num_words);
+  states[0] = model.BeginSentenceState();
+  for (size_t i = 1; i < num_words; ++i) {
+    model.FullScore(states[i - 1], model.GetVocabulary().Index(words[i]), states[i]);
+  }
+  // Every word after every state.  More than one chunk.
+  std::vector<BatchQuery> queries;
+  for (size_t s = 0; s < num_words; ++s) {
+    for (size_t w = 1; w < num_words; ++w) {
+      BatchQuery query;
+      query.in_state = &states[s];
+      query.new_word = model.GetVocabulary().Index(words[w]);
+      queries.push_back(query);
+    }
+  }
+  std::vector<State> out_states(queries.size());
+  std::vector<FullScoreReturn> out(queries.size());
+  model.FullScoreBatch(&queries[0], queries.size(), &out_states[0], &out[0]);
+  for (size_t i = 0; i < queries.size(); ++i) {
+    State expect_state;
+    FullScoreReturn expect = model.FullScore(*queries[i].in_state, queries[i].new_word, expect_state);
+    BOOST_CHECK_EQUAL(expect.prob, out[i].prob);
+    BOOST_CHECK_EQUAL(expect.rest, out[i].rest);
+    BOOST_CHECK_EQUAL(static_cast<unsigned int>(expect.ngram_length), static_cast<unsigned int>(out[i].ngram_length));
+    BOOST_CHECK_EQUAL(expect.independent_left, out[i].independent_left);
+    BOOST_CHECK_EQUAL(expect.extend_left, out[i].extend_left);
+    BOOST_CHECK_EQUAL(expect_state, out_states[i]);
+  }
+}
+
 template <class M> void NoUnkCheck(const M &model) {
   WordIndex unk_index = 0;
   State state;
@@ -294,6 +328,7 @@ template <class M> void Everything(const M &m) {
   MinimalState(m);
   ExtendLeftTest(m);
   Stateless(m);
+  BatchTest(m);
 }
 
 class ExpectEnumerateVocab : public EnumerateVocab {
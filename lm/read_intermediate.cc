@@ -0,0 +1,61 @@
+#include "lm/read_intermediate.hh"
+
+#include "util/file.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace lm {
+
+namespace {
+const std::size_t kBufferSize = 1 << 22;
+} // namespace
+
+IntermediateReader::IntermediateReader(int vocab_file, const std::vector<int> &ngram_files, const std::vector<uint64_t> &counts, std::size_t payload_size, const std::string &name)
+  : files_(ngram_files), counts_(counts), payload_size_(payload_size), name_(name),
+    order_(0), record_size_(0), offset_(0), remaining_(0), buffer_size_(0), current_(NULL), end_(NULL) {
+  UTIL_THROW_IF(files_.size() != counts_.size(), FormatLoadException, "Have " << files_.size() << " n-gram files for " << counts_.size() << " orders in " << name_);
+  UTIL_THROW_IF(payload_size_ < sizeof(ProbBackoff), FormatLoadException, "The payload of " << payload_size_ << " bytes is too small for a probability and backoff in " << name_);
+  for (std::size_t i = 0; i < files_.size(); ++i) {
+    uint64_t expect = counts_[i] * ((i + 1) * sizeof(WordIndex) + payload_size_);
+    uint64_t size = util::SizeOrThrow(files_[i]);
+    UTIL_THROW_IF(size != expect, FormatLoadException, "The " << (i + 1) << "-gram file of " << name_ << " has " << size << " bytes but " << counts_[i] << " n-grams take " << expect);
+  }
+
+  uint64_t size = util::SizeOrThrow(vocab_file);
+  util::MapRead(util::POPULATE_OR_READ, vocab_file, 0, size, vocab_memory_);
+  const char *const start = static_cast<const char*>(vocab_memory_.get());
+  const char *i;
+  for (i = start; i != start + size; i += strlen(i) + 1) {
+    words_.push_back(i);
+  }
+  words_.push_back(i);
+}
+
+void IntermediateReader::BeginOrder(unsigned int order) {
+  UTIL_THROW_IF(order == 0 || order > files_.size(), FormatLoadException, "Was expecting " << order << "-grams but " << name_ << " has orders 1 through " << files_.size());
+  End();
+  order_ = order;
+  record_size_ = order * sizeof(WordIndex) + payload_size_;
+  offset_ = 0;
+  remaining_ = counts_[order - 1] * record_size_;
+  buffer_size_ = std::max<std::size_t>(1, kBufferSize / record_size_) * record_size_;
+  buffer_.call_realloc(buffer_size_);
+  current_ = end_ = NULL;
+}
+
+void IntermediateReader::End() {
+  UTIL_THROW_IF(remaining_ || current_ != end_, FormatLoadException, "Only part of the " << order_ << "-grams in " << name_ << " were read");
+}
+
+void IntermediateReader::Refill() {
+  UTIL_THROW_IF(!remaining_, FormatLoadException, "Read past the " << counts_[order_ - 1] << ' ' << order_ << "-grams in " << name_);
+  std::size_t amount = static_cast<std::size_t>(std::min<uint64_t>(remaining_, buffer_size_));
+  util::ErsatzPRead(files_[order_ - 1], buffer_.get(), amount, offset_);
+  offset_ += amount;
+  remaining_ -= amount;
+  current_ = static_cast<const uint8_t*>(buffer_.get());
+  end_ = current_ + amount;
+}
+
+} // namespace lm
@@ -0,0 +1,158 @@
+#ifndef LM_READ_INTERMEDIATE_H
+#define LM_READ_INTERMEDIATE_H
+
+/* Reads the n-grams estimated by lmplz from the files of its model buffer
+ * (lm/common/model_buffer.hh) so that a binary model can be built from them
+ * without printing and parsing ARPA.  The functions at the bottom overload
+ * those in lm/read_arpa.hh, so the code that builds models from ARPA also
+ * builds them from these files.
+ *
+ * Each order has a file of fixed-size records: the vocabulary ids of an
+ * n-gram followed by a payload that begins with its weights.  The n-grams
+ * are in the order lmplz wrote them.  The vocabulary file has each word
+ * followed by a null, in vocabulary id order.
+ */
+
+#include "lm/blank.hh"
+#include "lm/lm_exception.hh"
+#include "lm/read_arpa.hh"
+#include "lm/weights.hh"
+#include "lm/word_index.hh"
+#include "util/mmap.hh"
+#include "util/scoped.hh"
+#include "util/string_piece.hh"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace lm {
+
+class IntermediateReader {
+  public:
+    /* Does not take ownership of the files.  ngram_files has a file for each
+     * order, with counts[i] n-grams of order i + 1.  payload_size is the
+     * number of bytes after the vocabulary ids of each n-gram.  name appears
+     * in error messages and is the default prefix for temporary files.
+     */
+    IntermediateReader(int vocab_file, const std::vector<int> &ngram_files, const std::vector<uint64_t> &counts, std::size_t payload_size, const std::string &name);
+
+    const std::vector<uint64_t> &Counts() const { return counts_; }
+
+    const char *FileName() const { return name_.c_str(); }
+
+    // Start reading the n-grams of an order.
+    void BeginOrder(unsigned int order);
+
+    // Vocabulary ids of the next n-gram, followed by its payload.  Valid until
+    // the next call.
+    const WordIndex *Next() {
+      if (current_ == end_) Refill();
+      const WordIndex *ret = reinterpret_cast<const WordIndex*>(current_);
+      current_ += record_size_;
+      return ret;
+    }
+
+    StringPiece Word(WordIndex id) const {
+      UTIL_THROW_IF(static_cast<std::size_t>(id) + 1 >= words_.size(), FormatLoadException, "Vocabulary id " << id << " is beyond the " << (words_.size() - 1) << " words in the vocabulary of " << name_);
+      return StringPiece(words_[id], words_[id + 1] - 1 - words_[id]);
+    }
+
+    // Call once the unigrams are in the vocabulary and it finished loading.
+    template <class Voc> void MapVocab(const Voc &vocab) {
+      mapping_.resize(words_.size() - 1);
+      for (WordIndex i = 0; i < mapping_.size(); ++i) {
+        mapping_[i] = vocab.Index(Word(i));
+      }
+    }
+
+    // Map an id from the files to the vocabulary of the model being built.
+    WordIndex Map(WordIndex id) const {
+      UTIL_THROW_IF(id >= mapping_.size(), FormatLoadException, "Vocabulary id " << id << " is beyond the " << mapping_.size() << " words in the vocabulary of " << name_);
+      return mapping_[id];
+    }
+
+    // Check that every n-gram of the last order was read.
+    void End();
+
+  private:
+    void Refill();
+
+    std::vector<int> files_;
+    std::vector<uint64_t> counts_;
+    const std::size_t payload_size_;
+    const std::string name_;
+
+    util::scoped_memory vocab_memory_;
+    // Start of each word, then the end of the last one.
+    std::vector<const char*> words_;
+    std::vector<WordIndex> mapping_;
+
+    // The order being read.
+    unsigned int order_;
+    std::size_t record_size_;
+    uint64_t offset_, remaining_;
+    util::scoped_malloc buffer_;
+    std::size_t buffer_size_;
+    const uint8_t *current_, *end_;
+};
+
+// The longest order has no backoff.
+inline void CopyBackoff(float /*from*/, Prob &/*weights*/) {}
+
+inline void CopyBackoff(float from, float &backoff) {
+  // Always make zero negative, as ReadBackoff does.
+  backoff = (from == ngram::kExtensionBackoff) ? ngram::kNoExtensionBackoff : from;
+}
+inline void CopyBackoff(float from, ProbBackoff &weights) {
+  CopyBackoff(from, weights.backoff);
+}
+inline void CopyBackoff(float from, RestWeights &weights) {
+  CopyBackoff(from, weights.backoff);
+}
+
+template <class Weights> void CopyWeights(const WordIndex *payload, Weights &weights, PositiveProbWarn &warn) {
+  const ProbBackoff &from = *reinterpret_cast<const ProbBackoff*>(payload);
+  weights.prob = from.prob;
+  if (weights.prob > 0.0) {
+    warn.Warn(weights.prob);
+    weights.prob = 0.0;
+  }
+  CopyBackoff(from.backoff, weights);
+}
+
+inline void ReadARPACounts(IntermediateReader &in, std::vector<uint64_t> &number) {
+  number = in.Counts();
+}
+
+inline void ReadNGramHeader(IntermediateReader &in, unsigned int length) {
+  in.BeginOrder(length);
+}
+
+inline void ReadEnd(IntermediateReader &in) {
+  in.End();
+}
+
+template <class Voc, class Weights> void Read1Grams(IntermediateReader &f, std::size_t count, Voc &vocab, Weights *unigrams, PositiveProbWarn &warn) {
+  ReadNGramHeader(f, 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    const WordIndex *word = f.Next();
+    CopyWeights(word + 1, unigrams[vocab.Insert(f.Word(*word))], warn);
+  }
+  vocab.FinishedLoading(unigrams);
+  f.MapVocab(vocab);
+}
+
+template <class Voc, class Weights, class Iterator> void ReadNGram(IntermediateReader &f, const unsigned char n, const Voc &/*vocab*/, Iterator indices_out, Weights &weights, PositiveProbWarn &warn) {
+  const WordIndex *words = f.Next();
+  for (const WordIndex *i = words; i != words + n; ++i, ++indices_out) {
+    *indices_out = f.Map(*i);
+  }
+  CopyWeights(words + n, weights, warn);
+}
+
+} // namespace lm
+
+#endif // LM_READ_INTERMEDIATE_H
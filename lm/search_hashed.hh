@@ -8,6 +8,7 @@
 #include "lm/weights.hh"
 
 #include "util/bit_packing.hh"
+#include "util/exception.hh"
 #include "util/probing_hash_table.hh"
 
 #include <algorithm>
@@ -17,6 +18,7 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class IntermediateReader;
 namespace ngram {
 class BinaryFormat;
 class ProbingVocabulary;
@@ -86,6 +88,9 @@ template <class Value> class HashedSearch {
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
+    // The n-grams estimated by lmplz stand in for ARPA.
+    void InitializeFromARPA(const char *file, IntermediateReader &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_.size() + 2;
     }
@@ -125,6 +130,37 @@ template <class Value> class HashedSearch {
       return LongestPointer(found->value.prob);
     }
 
+    /* Issue prefetches for every table entry a query of word after the given
+     * context (in reverse order) could touch.  Node hashes only depend on the
+     * vocabulary ids so all of the buckets are known before any lookup.
+     */
+    void Prefetch(WordIndex word, const WordIndex *context_rbegin, const WordIndex *context_rend) const {
+      PrefetchUnigram(word);
+      Node node = static_cast<Node>(word);
+      unsigned char order_minus_2 = 0;
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++order_minus_2) {
+        if (order_minus_2 == middle_.size()) {
+          PrefetchLongest(*i, node);
+          return;
+        }
+        PrefetchMiddle(order_minus_2, *i, node);
+        node = CombineWordHash(node, *i);
+      }
+    }
+
+    // Prefetch what the corresponding Lookup call with the same arguments will read.
+    void PrefetchUnigram(WordIndex word) const {
+      UTIL_PREFETCH(&unigram_.Lookup(word));
+    }
+
+    void PrefetchMiddle(unsigned char order_minus_2, WordIndex word, const Node &node) const {
+      UTIL_PREFETCH(&*middle_[order_minus_2].Ideal(CombineWordHash(node, word)));
+    }
+
+    void PrefetchLongest(WordIndex word, const Node &node) const {
+      UTIL_PREFETCH(&*longest_.Ideal(CombineWordHash(node, word)));
+    }
+
     // Generate a node without necessarily checking that it actually exists.
     // Optionally return false if it's know to not exist.
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
@@ -137,10 +173,13 @@ template <class Value> class HashedSearch {
     }
 
   private:
+    // Source is util::FilePiece or IntermediateReader.
+    template <class Source> void Initialize(Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
+
     // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
-    void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
+    template <class Source> void DispatchBuild(Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
 
-    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
+    template <class Source, class Build> void ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
 
     class Unigram {
       public:
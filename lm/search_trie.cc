@@ -25,6 +25,7 @@
 #include <queue>
 #include <limits>
 #include <numeric>
+#include <string>
 #include <vector>
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -575,17 +576,27 @@ template <class Quant, class Bhiksha> uint8_t *TrieSearch<Quant, Bhiksha>::Setup
   return start + Longest::Size(Quant::LongestBits(config), counts.back(), counts[0]);
 }
 
-template <class Quant, class Bhiksha> void TrieSearch<Quant, Bhiksha>::InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
-  std::string temporary_prefix;
+namespace {
+std::string TemporaryPrefix(const char *file, const Config &config) {
   if (!config.temporary_directory_prefix.empty()) {
-    temporary_prefix = config.temporary_directory_prefix;
+    return config.temporary_directory_prefix;
   } else if (config.write_mmap) {
-    temporary_prefix = config.write_mmap;
+    return config.write_mmap;
   } else {
-    temporary_prefix = file;
+    return file;
   }
+}
+} // namespace
+
+template <class Quant, class Bhiksha> void TrieSearch<Quant, Bhiksha>::InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
   // At least 1MB sorting memory.
-  SortedFiles sorted(config, f, counts, std::max<size_t>(config.building_memory, 1048576), temporary_prefix, vocab);
+  SortedFiles sorted(config, f, counts, std::max<size_t>(config.building_memory, 1048576), TemporaryPrefix(file, config), vocab);
+
+  BuildTrie(sorted, counts, config, *this, quant_, vocab, backing);
+}
+
+template <class Quant, class Bhiksha> void TrieSearch<Quant, Bhiksha>::InitializeFromARPA(const char *file, IntermediateReader &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing) {
+  SortedFiles sorted(config, f, counts, std::max<size_t>(config.building_memory, 1048576), TemporaryPrefix(file, config), vocab);
 
   BuildTrie(sorted, counts, config, *this, quant_, vocab, backing);
 }
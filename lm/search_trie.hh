@@ -7,6 +7,7 @@
 #include "lm/trie.hh"
 #include "lm/weights.hh"
 
+#include "util/exception.hh"
 #include "util/file.hh"
 #include "util/file_piece.hh"
 
@@ -15,6 +16,7 @@
 #include <cassert>
 
 namespace lm {
+class IntermediateReader;
 namespace ngram {
 class BinaryFormat;
 class SortedVocabulary;
@@ -61,6 +63,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
 
+    // The n-grams estimated by lmplz stand in for ARPA.
+    void InitializeFromARPA(const char *file, IntermediateReader &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_end_ - middle_begin_ + 2;
     }
@@ -74,6 +79,27 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return ret;
     }
 
+    /* Only the unigram entry can be located without walking the trie, so
+     * that is all that is prefetched.
+     */
+    void Prefetch(WordIndex word, const WordIndex * /*context_rbegin*/, const WordIndex * /*context_rend*/) const {
+      PrefetchUnigram(word);
+    }
+
+    // Prefetch what the corresponding Lookup call with the same arguments
+    // will read first.  Binary search may touch more than that.
+    void PrefetchUnigram(WordIndex word) const {
+      UTIL_PREFETCH(&unigram_.Lookup(word));
+    }
+
+    void PrefetchMiddle(unsigned char order_minus_2, WordIndex word, const Node &node) const {
+      middle_begin_[order_minus_2].Prefetch(word, node);
+    }
+
+    void PrefetchLongest(WordIndex word, const Node &node) const {
+      longest_.Prefetch(word, node);
+    }
+
     MiddlePointer Unpack(uint64_t extend_pointer, unsigned char extend_length, Node &node) const {
       return MiddlePointer(quant_, extend_length - 2, middle_begin_[extend_length - 2].ReadEntry(extend_pointer, node));
     }
@@ -4,6 +4,8 @@
 #include "lm/weights.hh"
 #include "lm/word_index.hh"
 #include "util/bit_packing.hh"
+#include "util/exception.hh"
+#include "util/sorted_uniform.hh"
 
 #include <cstddef>
 
@@ -81,6 +83,13 @@ class BitPacked {
       return insert_index_;
     }
 
+    // Prefetch the entry that Find(word, range) will probe first.
+    void Prefetch(WordIndex word, const NodeRange &range) const {
+      if (range.begin == range.end) return;
+      uint64_t pivot = range.begin + util::Pivot32::Calc(word, max_vocab_, range.end - range.begin);
+      UTIL_PREFETCH(base_ + ((pivot * total_bits_) >> 3));
+    }
+
   protected:
     static uint64_t BaseSize(uint64_t entries, uint64_t max_vocab, uint8_t remaining_bits);
 
@@ -3,6 +3,7 @@
 #include "lm/config.hh"
 #include "lm/lm_exception.hh"
 #include "lm/read_arpa.hh"
+#include "lm/read_intermediate.hh"
 #include "lm/vocab.hh"
 #include "lm/weights.hh"
 #include "lm/word_index.hh"
@@ -106,6 +107,15 @@ FILE *WriteContextFile(uint8_t *begin, uint8_t *end, const std::string &temp_pre
   return out.release();
 }
 
+// lmplz writes n-grams in this order when it renumbers the vocabulary for the trie.
+bool IsSorted(const uint8_t *begin, const uint8_t *end, std::size_t entry_size, unsigned char order) {
+  EntryCompare less(order);
+  for (const uint8_t *i = begin + entry_size; i < end; i += entry_size) {
+    if (less(i, i - entry_size)) return false;
+  }
+  return true;
+}
+
 struct ThrowCombine {
   void operator()(std::size_t entry_size, unsigned char order, const void *first, const void *second, FILE * /*out*/) const {
     const WordIndex *base = reinterpret_cast<const WordIndex*>(first);
@@ -188,6 +198,14 @@ void RecordReader::Rewind() {
 }
 
 SortedFiles::SortedFiles(const Config &config, util::FilePiece &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
+  Initialize(config, f, counts, buffer, file_prefix, vocab);
+}
+
+SortedFiles::SortedFiles(const Config &config, IntermediateReader &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
+  Initialize(config, f, counts, buffer, file_prefix, vocab);
+}
+
+template <class Source> void SortedFiles::Initialize(const Config &config, Source &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
   PositiveProbWarn warn(config.positive_log_probability);
   unigram_.reset(util::MakeTemp(file_prefix));
   {
@@ -237,7 +255,7 @@ class Closer {
 };
 } // namespace
 
-void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
+template <class Source> void SortedFiles::ConvertToSorted(Source &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
   ReadNGramHeader(f, order);
   const size_t count = counts[order - 1];
   // Size of weights.  Does it include backoff?
@@ -265,14 +283,16 @@ void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vo
       }
     }
     // Sort full records by full n-gram.
-    util::SizedProxy proxy_begin(begin, entry_size), proxy_end(out_end, entry_size);
-    // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.
+    if (!IsSorted(begin, out_end, entry_size, order)) {
+      util::SizedProxy proxy_begin(begin, entry_size), proxy_end(out_end, entry_size);
+      // parallel_sort uses too much RAM.  TODO: figure out why windows sort doesn't like my proxies.
 #if defined(_WIN32) || defined(_WIN64)
-    std::stable_sort
+      std::stable_sort
 #else
-    std::sort
+      std::sort
 #endif
-        (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order)));
+          (NGramIter(proxy_begin), NGramIter(proxy_end), util::SizedCompare<EntryCompare>(EntryCompare(order)));
+    }
     files.push_back(DiskFlush(begin, out_end, file_prefix));
     contexts.push_back(WriteContextFile(begin, out_end, file_prefix, entry_size, order));
 
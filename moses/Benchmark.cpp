@@ -0,0 +1,186 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "Benchmark.h"
+#include "Parameter.h"
+#include "StaticData.h"
+
+using namespace std;
+
+namespace Moses
+{
+namespace Benchmark
+{
+
+unsigned int Next(unsigned int &seed)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) & 0xffffff;
+}
+
+string MakeWord(const char *prefix, size_t id)
+{
+  return prefix + boost::lexical_cast<string>(id);
+}
+
+SyntheticModel::SyntheticModel(const string &name, const Config &config)
+  : m_config(config)
+  , m_dir(boost::filesystem::temp_directory_path()
+          / boost::filesystem::unique_path("moses-" + name + "-%%%%%%"))
+{
+  boost::filesystem::create_directories(m_dir);
+}
+
+SyntheticModel::~SyntheticModel()
+{
+  boost::system::error_code ignored;
+  boost::filesystem::remove_all(m_dir, ignored);
+}
+
+bool SyntheticModel::Load(const char *argv0) const
+{
+  string ptPath = (m_dir / "phrase-table").string();
+  string lmPath = m_config.languageModel ? (m_dir / "lm.arpa").string() : "";
+  string iniPath = (m_dir / "moses.ini").string();
+  WritePhraseTable(ptPath);
+  if (m_config.languageModel) {
+    WriteLanguageModel(lmPath);
+  }
+  WriteConfig(iniPath, ptPath, lmPath);
+
+  // StaticData keeps a pointer to it
+  Parameter *params = new Parameter;
+  const char *args[] = { argv0, "-f", iniPath.c_str(), "-v", "0" };
+  if (!params->LoadParam(5, args) || !StaticData::LoadDataStatic(params, argv0)) {
+    cerr << "Unable to load " << iniPath << endl;
+    return false;
+  }
+  return true;
+}
+
+string SyntheticModel::MakeSentence(size_t length, unsigned int &seed) const
+{
+  string ret;
+  size_t id = Next(seed) % m_config.vocabSize;
+  for (size_t i = 0; i < length; ++i) {
+    if (i) ret += " ";
+    ret += MakeWord("w", id);
+    bool pair = m_config.translationsPerPair && Next(seed) % 3 == 0
+                && id + 1 < m_config.vocabSize;
+    id = pair ? id + 1 : Next(seed) % m_config.vocabSize;
+  }
+  return ret;
+}
+
+void SyntheticModel::WritePhraseTable(const string &path) const
+{
+  ofstream out(path.c_str());
+  unsigned int seed = 1;
+  size_t vocabSize = m_config.vocabSize;
+  for (size_t i = 0; i < vocabSize; ++i) {
+    for (size_t t = 0; t < m_config.translationsPerWord; ++t) {
+      out << MakeWord("w", i) << " ||| " << MakeWord("t", Next(seed) % vocabSize) << " ||| ";
+      for (size_t s = 0; s < 4; ++s) {
+        out << (Next(seed) % 1000 + 1) / 1000.0 << " ";
+      }
+      out << "||| 0-0" << endl;
+    }
+  }
+  for (size_t i = 0; i + 1 < vocabSize; ++i) {
+    for (size_t t = 0; t < m_config.translationsPerPair; ++t) {
+      out << MakeWord("w", i) << " " << MakeWord("w", i + 1) << " ||| "
+          << MakeWord("t", Next(seed) % vocabSize) << " " << MakeWord("t", Next(seed) % vocabSize) << " ||| ";
+      for (size_t s = 0; s < 4; ++s) {
+        out << (Next(seed) % 1000 + 1) / 1000.0 << " ";
+      }
+      out << "||| 0-0 1-1" << endl;
+    }
+  }
+}
+
+// every target word as a unigram, and a few bigrams for each
+void SyntheticModel::WriteLanguageModel(const string &path) const
+{
+  ofstream out(path.c_str());
+  unsigned int seed = 2;
+  size_t vocabSize = m_config.vocabSize;
+  const size_t bigramsPerWord = 5;
+  out << "\n\\data\\\n"
+      << "ngram 1=" << vocabSize + 3 << "\n"
+      << "ngram 2=" << vocabSize * bigramsPerWord << "\n\n"
+      << "\\1-grams:\n"
+      << "-5\t<unk>\t0\n"
+      << "-99\t<s>\t-0.5\n"
+      << "-2\t</s>\t0\n";
+  for (size_t i = 0; i < vocabSize; ++i) {
+    out << -1.0 - (Next(seed) % 3000) / 1000.0 << "\t" << MakeWord("t", i)
+        << "\t" << -(Next(seed) % 1000 / 1000.0) << "\n";
+  }
+  out << "\n\\2-grams:\n";
+  for (size_t i = 0; i < vocabSize; ++i) {
+    vector<size_t> seen;
+    while (seen.size() < bigramsPerWord) {
+      size_t next = Next(seed) % vocabSize;
+      if (find(seen.begin(), seen.end(), next) != seen.end()) continue;
+      seen.push_back(next);
+      out << -(Next(seed) % 2000 / 1000.0) << "\t" << MakeWord("t", i) << " " << MakeWord("t", next) << "\n";
+    }
+  }
+  out << "\n\\end\\\n";
+}
+
+void SyntheticModel::WriteConfig(const string &path, const string &ptPath,
+                                 const string &lmPath) const
+{
+  ofstream out(path.c_str());
+  out << "[input-factors]\n0\n"
+      << "[mapping]\n0 T 0\n"
+      << "[distortion-limit]\n6\n"
+      << "[feature]\n"
+      << "UnknownWordPenalty\n"
+      << "WordPenalty\n"
+      << "PhrasePenalty\n"
+      << "PhraseDictionaryMemory name=TranslationModel0 num-features=4 path=" << ptPath
+      << " input-factor=0 output-factor=0 table-limit=20\n"
+      << "Distortion\n";
+  if (!lmPath.empty()) {
+    out << "KENLM name=LM0 factor=0 order=2 path=" << lmPath << "\n";
+  }
+  out << "[weight]\n"
+      << "UnknownWordPenalty0= 1\n"
+      << "WordPenalty0= -1\n"
+      << "PhrasePenalty0= 0.2\n"
+      << "TranslationModel0= 0.2 0.2 0.2 0.2\n"
+      << "Distortion0= 0.3\n";
+  if (!lmPath.empty()) {
+    out << "LM0= 0.5\n";
+  }
+}
+
+}
+}
@@ -0,0 +1,88 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_Benchmark_h
+#define moses_Benchmark_h
+
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+
+namespace Moses
+{
+
+/** Made up data for the *Benchmark programs, so they need no model files. */
+namespace Benchmark
+{
+
+//! pseudo-random numbers below 2^24, the same on every platform
+unsigned int Next(unsigned int &seed);
+
+//! eg. w12
+std::string MakeWord(const char *prefix, size_t id);
+
+/** A phrase-based model of made up words, written to a temporary directory
+ *  that is removed again with the object.
+ *  Source words are w0, w1... and target words t0, t1...
+ */
+class SyntheticModel
+{
+public:
+  struct Config {
+    size_t vocabSize;
+    size_t translationsPerWord;
+    //! translations of each pair of consecutive source words
+    size_t translationsPerPair;
+    //! a bigram language model over the target words. It keeps hypotheses
+    //! from recombining, so the stacks fill
+    bool languageModel;
+
+    Config()
+      : vocabSize(1000)
+      , translationsPerWord(5)
+      , translationsPerPair(0)
+      , languageModel(false) {
+    }
+  };
+
+  //! name is part of the name of the temporary directory
+  SyntheticModel(const std::string &name, const Config &config);
+  ~SyntheticModel();
+
+  //! into StaticData. False, with a message on stderr, if it fails
+  bool Load(const char *argv0) const;
+
+  //! with pair translations, consecutive ids now and then so they get used
+  std::string MakeSentence(size_t length, unsigned int &seed) const;
+
+protected:
+  Config m_config;
+  boost::filesystem::path m_dir;
+
+  void WritePhraseTable(const std::string &path) const;
+  void WriteLanguageModel(const std::string &path) const;
+  void WriteConfig(const std::string &path, const std::string &ptPath,
+                   const std::string &lmPath) const;
+};
+
+}
+}
+
+#endif
@@ -27,65 +27,77 @@ namespace Moses
 
 TO_STRING_BODY(Bitmap);
 
-Bitmap::Bitmap(size_t size, const std::vector<bool>& initializer)
-  :m_bitmap(initializer.begin(), initializer.end())
+void Bitmap::Allocate(size_t size)
 {
+  m_size = size;
+  size_t numBlocks = NumBlocks(size);
+  m_blocks = numBlocks <= BITMAP_INLINE_BLOCKS ? m_inline : new Block[numBlocks];
+}
 
-  // The initializer may not be of the same length.  Change to the desired
-  // length.  If we need to add any elements, initialize them to false.
-  m_bitmap.resize(size, false);
-
-  m_numWordsCovered = std::count(m_bitmap.begin(), m_bitmap.end(), true);
+Bitmap::Bitmap(size_t size, const std::vector<bool>& initializer)
+{
+  Allocate(size);
+  std::fill(m_blocks, m_blocks + NumBlocks(m_size), 0);
+
+  // The initializer may not be of the same length.  Only the first size
+  // values are used, any others are false.
+  m_numWordsCovered = 0;
+  for (size_t pos = 0; pos < initializer.size() && pos < m_size; ++pos) {
+    if (initializer[pos]) {
+      m_blocks[pos / BITS_PER_BLOCK] |= Block(1) << (pos % BITS_PER_BLOCK);
+      ++m_numWordsCovered;
+    }
+  }
 
   // Find the first gap, and cache it.
-  std::vector<char>::const_iterator first_gap = std::find(
-        m_bitmap.begin(), m_bitmap.end(), false);
-  m_firstGap = (
-                 (first_gap == m_bitmap.end()) ?
-                 NOT_FOUND : first_gap - m_bitmap.begin());
+  m_firstGap = FindNext(0, false);
 }
 
 //! Create Bitmap of length size and initialise.
 Bitmap::Bitmap(size_t size)
-  :m_bitmap(size, false)
-  ,m_firstGap(0)
+  :m_firstGap(0)
   ,m_numWordsCovered(0)
-
 {
+  Allocate(size);
+  std::fill(m_blocks, m_blocks + NumBlocks(m_size), 0);
 }
 
 //! Deep copy.
 Bitmap::Bitmap(const Bitmap &copy)
-  :m_bitmap(copy.m_bitmap)
-  ,m_firstGap(copy.m_firstGap)
+  :m_firstGap(copy.m_firstGap)
   ,m_numWordsCovered(copy.m_numWordsCovered)
 {
+  Allocate(copy.m_size);
+  std::copy(copy.m_blocks, copy.m_blocks + NumBlocks(m_size), m_blocks);
 }
 
 Bitmap::Bitmap(const Bitmap &copy, const Range &range)
-  :m_bitmap(copy.m_bitmap)
-  ,m_firstGap(copy.m_firstGap)
+  :m_firstGap(copy.m_firstGap)
   ,m_numWordsCovered(copy.m_numWordsCovered)
 {
+  Allocate(copy.m_size);
+  std::copy(copy.m_blocks, copy.m_blocks + NumBlocks(m_size), m_blocks);
   SetValueNonOverlap(range);
 }
 
 // for unordered_set in stack
 size_t Bitmap::hash() const
 {
-  size_t ret = boost::hash_value(m_bitmap);
+  size_t ret = m_size;
+  boost::hash_range(ret, m_blocks, m_blocks + NumBlocks(m_size));
   return ret;
 }
 
 bool Bitmap::operator==(const Bitmap& other) const
 {
-  return m_bitmap == other.m_bitmap;
+  return m_size == other.m_size
+         && std::equal(m_blocks, m_blocks + NumBlocks(m_size), other.m_blocks);
 }
 
 // friend
 std::ostream& operator<<(std::ostream& out, const Bitmap& bitmap)
 {
-  for (size_t i = 0 ; i < bitmap.m_bitmap.size() ; i++) {
+  for (size_t i = 0 ; i < bitmap.m_size ; i++) {
     out << int(bitmap.GetValue(i));
   }
   return out;
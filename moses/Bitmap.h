@@ -29,47 +29,106 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
+#include <stdint.h>
 #include "TypeDef.h"
 #include "Range.h"
 
+//! 64 bit blocks kept inside each Bitmap, longer sentences use the heap
+#ifndef BITMAP_INLINE_BLOCKS
+#define BITMAP_INLINE_BLOCKS 4
+#endif
+
 namespace Moses
 {
 typedef unsigned long WordsBitmapID;
 
 /** Vector of boolean to represent whether a word has been translated or not.
  *
- * Implemented using a vector of char, which is usually the same representation
- * for the elements that a C array of bool would use.  A vector of bool, or a
- * Boost dynamic_bitset, could be much more efficient in theory.  Unfortunately
- * algorithms like std::find() are not optimized for vector<bool> on gcc or
- * clang, and dynamic_bitset lacks all the optimized search operations we want.
- * Only benchmarking will tell what works best.  Perhaps dynamic_bitset could
- * still be a dramatic improvement, if we flip the meaning of the bits around
- * so we can use its find_first() and find_next() for the most common searches.
+ * The bits are packed into 64 bit blocks, kept inside the object for
+ * sentences up to BITMAP_INLINE_BLOCKS * 64 words and on the heap beyond
+ * that. Searches for the next or previous set or unset bit look at a whole
+ * block at a time with count-trailing/leading-zeros, and hashing and
+ * comparison are per block. Bits past the end are always 0.
  */
 class Bitmap
 {
   friend std::ostream& operator<<(std::ostream& out, const Bitmap& bitmap);
 private:
-  std::vector<char> m_bitmap; //! Ticks of words in sentence that have been done.
+  typedef uint64_t Block;
+  static const size_t BITS_PER_BLOCK = 64;
+
+  Block m_inline[BITMAP_INLINE_BLOCKS];
+  Block *m_blocks; //! Ticks of words in sentence that have been done. m_inline or heap
+  size_t m_size;
   size_t m_firstGap; //! Cached position of first gap, or NOT_FOUND.
   size_t m_numWordsCovered;
 
   Bitmap(); // not implemented
   Bitmap& operator= (const Bitmap& other);
 
+  static size_t NumBlocks(size_t size) {
+    return (size + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
+  }
+  //! bits of pos and above in its block
+  static Block MaskFrom(size_t pos) {
+    return ~Block(0) << (pos % BITS_PER_BLOCK);
+  }
+  //! bits of pos and below in its block
+  static Block MaskTo(size_t pos) {
+    return ~Block(0) >> (BITS_PER_BLOCK - 1 - pos % BITS_PER_BLOCK);
+  }
+  static size_t CountTrailingZeros(Block block) {
+#ifdef __GNUC__
+    return __builtin_ctzll(block);
+#else
+    size_t ret = 0;
+    for (; !(block & 1); block >>= 1) ++ret;
+    return ret;
+#endif
+  }
+  static size_t HighestBit(Block block) {
+#ifdef __GNUC__
+    return BITS_PER_BLOCK - 1 - __builtin_clzll(block);
+#else
+    size_t ret = 0;
+    while (block >>= 1) ++ret;
+    return ret;
+#endif
+  }
+
+  void Allocate(size_t size);
+
+  //! first position from pos on that has the given value, or NOT_FOUND
+  size_t FindNext(size_t pos, bool value) const {
+    if (pos >= m_size) return NOT_FOUND;
+    size_t numBlocks = NumBlocks(m_size);
+    size_t i = pos / BITS_PER_BLOCK;
+    Block block = (value ? m_blocks[i] : ~m_blocks[i]) & MaskFrom(pos);
+    while (!block) {
+      if (++i == numBlocks) return NOT_FOUND;
+      block = value ? m_blocks[i] : ~m_blocks[i];
+    }
+    size_t ret = i * BITS_PER_BLOCK + CountTrailingZeros(block);
+    return ret < m_size ? ret : NOT_FOUND;
+  }
+
+  //! last position up to and including pos that has the given value, or NOT_FOUND
+  size_t FindPrev(size_t pos, bool value) const {
+    size_t i = pos / BITS_PER_BLOCK;
+    Block block = (value ? m_blocks[i] : ~m_blocks[i]) & MaskTo(pos);
+    while (!block) {
+      if (i-- == 0) return NOT_FOUND;
+      block = value ? m_blocks[i] : ~m_blocks[i];
+    }
+    return i * BITS_PER_BLOCK + HighestBit(block);
+  }
+
   /** Update the first gap, when bits are flipped */
   void UpdateFirstGap(size_t startPos, size_t endPos, bool value) {
     if (value) {
       //may remove gap
       if (startPos <= m_firstGap && m_firstGap <= endPos) {
-        m_firstGap = NOT_FOUND;
-        for (size_t i = endPos + 1 ; i < m_bitmap.size(); ++i) {
-          if (!m_bitmap[i]) {
-            m_firstGap = i;
-            break;
-          }
-        }
+        m_firstGap = FindNext(endPos + 1, false);
       }
 
     } else {
@@ -86,8 +145,15 @@ private:
     size_t startPos = range.GetStartPos();
     size_t endPos = range.GetEndPos();
 
-    for(size_t pos = startPos ; pos <= endPos ; pos++) {
-      m_bitmap[pos] = true;
+    size_t first = startPos / BITS_PER_BLOCK, last = endPos / BITS_PER_BLOCK;
+    if (first == last) {
+      m_blocks[first] |= MaskFrom(startPos) & MaskTo(endPos);
+    } else {
+      m_blocks[first] |= MaskFrom(startPos);
+      for (size_t i = first + 1; i < last; ++i) {
+        m_blocks[i] = ~Block(0);
+      }
+      m_blocks[last] |= MaskTo(endPos);
     }
 
     m_numWordsCovered += range.GetNumWordsCovered();
@@ -106,6 +172,12 @@ public:
 
   explicit Bitmap(const Bitmap &copy, const Range &range);
 
+  ~Bitmap() {
+    if (m_blocks != m_inline) {
+      delete[] m_blocks;
+    }
+  }
+
   //! Count of words translated.
   size_t GetNumWordsCovered() const {
     return m_numWordsCovered;
@@ -119,38 +191,26 @@ public:
 
   //! position of last word not yet translated, or NOT_FOUND if everything already translated
   size_t GetLastGapPos() const {
-    for (int pos = int(m_bitmap.size()) - 1 ; pos >= 0 ; pos--) {
-      if (!m_bitmap[pos]) {
-        return pos;
-      }
-    }
-    // no starting pos
-    return NOT_FOUND;
+    return m_size ? FindPrev(m_size - 1, false) : NOT_FOUND;
   }
 
 
   //! position of last translated word
   size_t GetLastPos() const {
-    for (int pos = int(m_bitmap.size()) - 1 ; pos >= 0 ; pos--) {
-      if (m_bitmap[pos]) {
-        return pos;
-      }
-    }
-    // no starting pos
-    return NOT_FOUND;
+    return m_size ? FindPrev(m_size - 1, true) : NOT_FOUND;
   }
 
   //! whether a word has been translated at a particular position
   bool GetValue(size_t pos) const {
-    return bool(m_bitmap[pos]);
+    return (m_blocks[pos / BITS_PER_BLOCK] >> (pos % BITS_PER_BLOCK)) & 1;
   }
   //! set value at a particular position
   void SetValue( size_t pos, bool value ) {
-    bool origValue = m_bitmap[pos];
+    bool origValue = GetValue(pos);
     if (origValue == value) {
       // do nothing
     } else {
-      m_bitmap[pos] = value;
+      m_blocks[pos / BITS_PER_BLOCK] ^= Block(1) << (pos % BITS_PER_BLOCK);
       UpdateFirstGap(pos, pos, value);
       if (value) {
         ++m_numWordsCovered;
@@ -166,40 +226,33 @@ public:
   }
   //! whether the wordrange overlaps with any translated word in this bitmap
   bool Overlap(const Range &compare) const {
-    for (size_t pos = compare.GetStartPos() ; pos <= compare.GetEndPos() ; pos++) {
-      if (m_bitmap[pos])
-        return true;
-    }
-    return false;
+    size_t next = FindNext(compare.GetStartPos(), true);
+    return next != NOT_FOUND && next <= compare.GetEndPos();
   }
   //! number of elements
   size_t GetSize() const {
-    return m_bitmap.size();
+    return m_size;
   }
 
   inline size_t GetEdgeToTheLeftOf(size_t l) const {
     if (l == 0) return l;
-    while (l && !m_bitmap[l-1]) {
-      --l;
-    }
-    return l;
+    size_t prev = FindPrev(l - 1, true);
+    return prev == NOT_FOUND ? 0 : prev + 1;
   }
 
   inline size_t GetEdgeToTheRightOf(size_t r) const {
-    if (r+1 == m_bitmap.size()) return r;
-    return (
-             std::find(m_bitmap.begin() + r + 1, m_bitmap.end(), true) -
-             m_bitmap.begin()
-           ) - 1;
+    if (r+1 == m_size) return r;
+    size_t next = FindNext(r + 1, true);
+    return (next == NOT_FOUND ? m_size : next) - 1;
   }
 
 
   //! converts bitmap into an integer ID: it consists of two parts: the first 16 bit are the pattern between the first gap and the last word-1, the second 16 bit are the number of filled positions. enforces a sentence length limit of 65535 and a max distortion of 16
   WordsBitmapID GetID() const {
-    assert(m_bitmap.size() < (1<<16));
+    assert(m_size < (1<<16));
 
     size_t start = GetFirstGapPos();
-    if (start == NOT_FOUND) start = m_bitmap.size(); // nothing left
+    if (start == NOT_FOUND) start = m_size; // nothing left
 
     size_t end = GetLastPos();
     if (end == NOT_FOUND) end = 0; // nothing translated yet
@@ -214,10 +267,10 @@ public:
 
   //! converts bitmap into an integer ID, with an additional span covered
   WordsBitmapID GetIDPlus( size_t startPos, size_t endPos ) const {
-    assert(m_bitmap.size() < (1<<16));
+    assert(m_size < (1<<16));
 
     size_t start = GetFirstGapPos();
-    if (start == NOT_FOUND) start = m_bitmap.size(); // nothing left
+    if (start == NOT_FOUND) start = m_size; // nothing left
 
     size_t end = GetLastPos();
     if (end == NOT_FOUND) end = 0; // nothing translated yet
@@ -126,10 +126,10 @@ BackwardsEdge::BackwardsEdge(const BitmapContainer &prevBitmapContainer
   : m_initialized(false)
   , m_prevBitmapContainer(prevBitmapContainer)
   , m_parent(parent)
+  , m_index(0)
   , m_translations(translations)
   , m_estimatedScores(estimatedScores)
   , m_deterministic(deterministic)
-  , m_seenPosition()
 {
 
   // If either dimension is empty, we haven't got anything to do.
@@ -195,7 +195,6 @@ BackwardsEdge::BackwardsEdge(const BitmapContainer &prevBitmapContainer
 
 BackwardsEdge::~BackwardsEdge()
 {
-  m_seenPosition.clear();
   m_hypotheses.clear();
 }
 
@@ -214,13 +213,12 @@ BackwardsEdge::Initialize()
 
   Hypothesis *expanded = CreateHypothesis(*m_hypotheses[0], *m_translations.Get(0));
   m_parent.Enqueue(0, 0, expanded, this);
-  SetSeenPosition(0, 0);
+  m_seenPosition.Insert(0, 0);
   m_initialized = true;
 }
 
-Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
+Hypothesis *BackwardsEdge::NewHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
 {
-  // create hypothesis and calculate all its scores
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StartTimeBuildHyp();
   }
@@ -229,25 +227,16 @@ Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StopTimeBuildHyp();
   }
-  newHypo->EvaluateWhenApplied(m_estimatedScore);
-
   return newHypo;
 }
 
-bool
-BackwardsEdge::SeenPosition(const size_t x, const size_t y)
-{
-  boost::unordered_set< int >::iterator iter = m_seenPosition.find((x<<16) + y);
-  return (iter != m_seenPosition.end());
-}
-
-void
-BackwardsEdge::SetSeenPosition(const size_t x, const size_t y)
+Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
 {
-  UTIL_THROW_IF2(x >= (1<<17), "Error");
-  UTIL_THROW_IF2(y >= (1<<17), "Error");
+  // create hypothesis and calculate all its scores
+  Hypothesis *newHypo = NewHypothesis(hypothesis, transOpt);
+  newHypo->EvaluateWhenApplied(m_estimatedScore);
 
-  m_seenPosition.insert((x<<16) + y);
+  return newHypo;
 }
 
 
@@ -268,20 +257,71 @@ BackwardsEdge::PushSuccessors(const size_t x, const size_t y)
 {
   Hypothesis *newHypo;
 
-  if(y + 1 < m_translations.size() && !SeenPosition(x, y + 1)) {
-    SetSeenPosition(x, y + 1);
+  if(y + 1 < m_translations.size() && m_seenPosition.Insert(x, y + 1)) {
     newHypo = CreateHypothesis(*m_hypotheses[x], *m_translations.Get(y + 1));
     if(newHypo != NULL) {
-      m_parent.Enqueue(x, y + 1, newHypo, (BackwardsEdge*)this);
+      m_parent.Enqueue(x, y + 1, newHypo, this);
     }
   }
 
-  if(x + 1 < m_hypotheses.size() && !SeenPosition(x + 1, y)) {
-    SetSeenPosition(x + 1, y);
+  if(x + 1 < m_hypotheses.size() && m_seenPosition.Insert(x + 1, y)) {
     newHypo = CreateHypothesis(*m_hypotheses[x + 1], *m_translations.Get(y));
     if(newHypo != NULL) {
-      m_parent.Enqueue(x + 1, y, newHypo, (BackwardsEdge*)this);
+      m_parent.Enqueue(x + 1, y, newHypo, this);
+    }
+  }
+}
+
+void
+BackwardsEdge::CollectSuccessors(const size_t x, const size_t y, std::vector<CubeSuccessor> &successors)
+{
+  if(y + 1 < m_translations.size() && m_seenPosition.Insert(x, y + 1)) {
+    CubeSuccessor successor = { this, (uint32_t) x, (uint32_t) (y + 1) };
+    successors.push_back(successor);
+  }
+
+  if(x + 1 < m_hypotheses.size() && m_seenPosition.Insert(x + 1, y)) {
+    CubeSuccessor successor = { this, (uint32_t) (x + 1), (uint32_t) y };
+    successors.push_back(successor);
+  }
+}
+
+void
+BackwardsEdge::PushSuccessors(const std::vector<CubeSuccessor> &successors)
+{
+  std::vector<Hypothesis*> hypos(successors.size());
+  std::vector<float> estimatedScores(successors.size());
+  for (size_t i = 0; i < successors.size(); ++i) {
+    const CubeSuccessor &successor = successors[i];
+    BackwardsEdge &edge = *successor.edge;
+    hypos[i] = edge.NewHypothesis(*edge.m_hypotheses[successor.hypothesisPos]
+                                  , *edge.m_translations.Get(successor.translationPos));
+    estimatedScores[i] = edge.m_estimatedScore;
+  }
+
+  Hypothesis::EvaluateWhenApplied(hypos, estimatedScores);
+
+  for (size_t i = 0; i < successors.size(); ++i) {
+    const CubeSuccessor &successor = successors[i];
+    successor.edge->m_parent.Enqueue(successor.hypothesisPos, successor.translationPos
+                                     , hypos[i], successor.edge);
+  }
+}
+
+void
+CubePositionSet::Grow()
+{
+  std::vector<uint64_t> slots;
+  slots.swap(m_slots);
+  m_slots.resize(slots.empty() ? 16 : 2 * slots.size(), 0);
+  size_t mask = m_slots.size() - 1;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (slots[i] == 0) continue;
+    size_t pos = Hash(slots[i]) & mask;
+    while (m_slots[pos] != 0) {
+      pos = (pos + 1) & mask;
     }
+    m_slots[pos] = slots[i];
   }
 }
 
@@ -298,21 +338,13 @@ BitmapContainer::BitmapContainer(const Bitmap &bitmap
   , m_numStackInsertions(0)
   , m_deterministic(deterministic)
 {
-  m_hypotheses = HypothesisSet();
-  m_edges = BackwardsEdgeSet();
-  m_queue = HypothesisQueue();
 }
 
 BitmapContainer::~BitmapContainer()
 {
-  // As we have created the square position objects we clean up now.
-
-  while (!m_queue.empty()) {
-    HypothesisQueueItem *item = m_queue.top();
-    m_queue.pop();
-
-    delete item->GetHypothesis();
-    delete item;
+  // The hypotheses still in the queue never made it to a stack.
+  for (size_t i = 0; i < m_queue.size(); ++i) {
+    delete m_items[m_queue[i].item].hypothesis;
   }
 
   // Delete all edges.
@@ -322,49 +354,89 @@ BitmapContainer::~BitmapContainer()
   m_edges.clear();
 }
 
-
-void
-BitmapContainer::Enqueue(int hypothesis_pos
-                         , int translation_pos
-                         , Hypothesis *hypothesis
-                         , BackwardsEdge *edge)
-{
-  // Only supply target phrase if running deterministic search mode
-  const TargetPhrase *target_phrase = m_deterministic ? &(hypothesis->GetCurrTargetPhrase()) : NULL;
-  HypothesisQueueItem *item = new HypothesisQueueItem(hypothesis_pos
-      , translation_pos
-      , hypothesis
-      , edge
-      , target_phrase);
-  IFVERBOSE(2) {
-    item->GetHypothesis()->GetManager().GetSentenceStats().StartTimeManageCubes();
+bool
+BitmapContainer::Worse(const HypothesisQueueEntry &a, const HypothesisQueueEntry &b) const
+{
+  if (a.score != b.score) {
+    return a.score < b.score;
   }
-  m_queue.push(item);
-  IFVERBOSE(2) {
-    item->GetHypothesis()->GetManager().GetSentenceStats().StopTimeManageCubes();
+  // The queued hypotheses are alive, so their target phrases can be used
+  // to break ties instead of keeping copies of them.
+  if (m_deterministic) {
+    return m_items[a.item].hypothesis->GetCurrTargetPhrase().Compare(
+             m_items[b.item].hypothesis->GetCurrTargetPhrase()) > 0;
   }
+  return false;
 }
 
-HypothesisQueueItem*
-BitmapContainer::Dequeue(bool keepValue)
+void
+BitmapContainer::SiftUp(size_t pos)
 {
-  if (!m_queue.empty()) {
-    HypothesisQueueItem *item = m_queue.top();
+  HypothesisQueueEntry entry = m_queue[pos];
+  while (pos > 0) {
+    size_t parent = (pos - 1) / 2;
+    if (!Worse(m_queue[parent], entry)) break;
+    m_queue[pos] = m_queue[parent];
+    pos = parent;
+  }
+  m_queue[pos] = entry;
+}
 
-    if (!keepValue) {
-      m_queue.pop();
+void
+BitmapContainer::SiftDown(size_t pos)
+{
+  HypothesisQueueEntry entry = m_queue[pos];
+  const size_t size = m_queue.size();
+  while (2 * pos + 1 < size) {
+    size_t child = 2 * pos + 1;
+    if (child + 1 < size && Worse(m_queue[child], m_queue[child + 1])) {
+      ++child;
     }
-
-    return item;
+    if (!Worse(entry, m_queue[child])) break;
+    m_queue[pos] = m_queue[child];
+    pos = child;
   }
+  m_queue[pos] = entry;
+}
 
-  return NULL;
+void
+BitmapContainer::Enqueue(size_t hypothesis_pos
+                         , size_t translation_pos
+                         , Hypothesis *hypothesis
+                         , const BackwardsEdge *edge)
+{
+  IFVERBOSE(2) {
+    hypothesis->GetManager().GetSentenceStats().StartTimeManageCubes();
+  }
+  HypothesisQueueItem item(hypothesis, hypothesis_pos, translation_pos, edge->m_index);
+  HypothesisQueueEntry entry;
+  entry.score = hypothesis->GetFutureScore();
+  if (m_freeItems.empty()) {
+    entry.item = m_items.size();
+    m_items.push_back(item);
+  } else {
+    entry.item = m_freeItems.back();
+    m_freeItems.pop_back();
+    m_items[entry.item] = item;
+  }
+  m_queue.push_back(entry);
+  SiftUp(m_queue.size() - 1);
+  IFVERBOSE(2) {
+    hypothesis->GetManager().GetSentenceStats().StopTimeManageCubes();
+  }
 }
 
-HypothesisQueueItem*
-BitmapContainer::Top() const
+HypothesisQueueItem
+BitmapContainer::Pop()
 {
-  return m_queue.top();
+  const uint32_t index = m_queue.front().item;
+  m_queue.front() = m_queue.back();
+  m_queue.pop_back();
+  if (!m_queue.empty()) {
+    SiftDown(0);
+  }
+  m_freeItems.push_back(index);
+  return m_items[index];
 }
 
 size_t
@@ -391,7 +463,7 @@ BitmapContainer::GetHypothesesSize() const
   return m_hypotheses.size();
 }
 
-const BackwardsEdgeSet&
+const BackwardsEdgeList&
 BitmapContainer::GetBackwardsEdges()
 {
   return m_edges;
@@ -420,20 +492,15 @@ BitmapContainer::AddHypothesis(Hypothesis *hypothesis)
 void
 BitmapContainer::AddBackwardsEdge(BackwardsEdge *edge)
 {
-  m_edges.insert(edge);
+  edge->m_index = m_edges.size();
+  m_edges.push_back(edge);
 }
 
 void
 BitmapContainer::InitializeEdges()
 {
-  BackwardsEdgeSet::iterator iter = m_edges.begin();
-  BackwardsEdgeSet::iterator iterEnd = m_edges.end();
-
-  while (iter != iterEnd) {
-    BackwardsEdge *edge = *iter;
-    edge->Initialize();
-
-    ++iter;
+  for (size_t i = 0; i < m_edges.size(); ++i) {
+    m_edges[i]->Initialize();
   }
 }
 
@@ -446,34 +513,32 @@ BitmapContainer::EnsureMinStackHyps(const size_t minNumHyps)
 }
 
 void
-BitmapContainer::ProcessBestHypothesis()
+BitmapContainer::ProcessBestHypothesis(std::vector<CubeSuccessor> *batch)
 {
   if (m_queue.empty()) {
     return;
   }
 
   // Get the currently best hypothesis from the queue.
-  HypothesisQueueItem *item = Dequeue();
-
-  // If the priority queue is exhausted, we are done and should have exited
-  UTIL_THROW_IF2(item == NULL, "Null object");
+  const HypothesisQueueItem item = Pop();
+  Hypothesis *hypothesis = item.hypothesis;
 
   // check we are pulling things off of priority queue in right order
   if (!Empty()) {
-    HypothesisQueueItem *check = Dequeue(true);
-    UTIL_THROW_IF2(item->GetHypothesis()->GetFutureScore() < check->GetHypothesis()->GetFutureScore(),
+    const Hypothesis *check = Top();
+    UTIL_THROW_IF2(hypothesis->GetFutureScore() < check->GetFutureScore(),
                    "Non-monotonic total score: "
-                   << item->GetHypothesis()->GetFutureScore() << " vs. "
-                   << check->GetHypothesis()->GetFutureScore());
+                   << hypothesis->GetFutureScore() << " vs. "
+                   << check->GetFutureScore());
   }
 
   // Logging for the criminally insane
   IFVERBOSE(3) {
-    item->GetHypothesis()->PrintHypothesis();
+    hypothesis->PrintHypothesis();
   }
 
   // Add best hypothesis to hypothesis stack.
-  const bool newstackentry = m_stack.AddPrune(item->GetHypothesis());
+  const bool newstackentry = m_stack.AddPrune(hypothesis);
   if (newstackentry)
     m_numStackInsertions++;
 
@@ -482,10 +547,12 @@ BitmapContainer::ProcessBestHypothesis()
   }
 
   // Create new hypotheses for the two successors of the hypothesis just added.
-  item->GetBackwardsEdge()->PushSuccessors(item->GetHypothesisPos(), item->GetTranslationPos());
-
-  // We are done with the queue item, we delete it.
-  delete item;
+  BackwardsEdge *edge = m_edges[item.edge];
+  if (batch) {
+    edge->CollectSuccessors(item.hypothesisPos, item.translationPos, *batch);
+  } else {
+    edge->PushSuccessors(item.hypothesisPos, item.translationPos);
+  }
 }
 
 void
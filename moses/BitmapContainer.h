@@ -22,9 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef moses_BitmapContainer_h
 #define moses_BitmapContainer_h
 
-#include <queue>
-#include <set>
 #include <vector>
+#include <stdint.h>
 
 #include "Hypothesis.h"
 #include "HypothesisStackCubePruning.h"
@@ -33,8 +32,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TypeDef.h"
 #include "Bitmap.h"
 
-#include <boost/unordered_set.hpp>
-
 namespace Moses
 {
 
@@ -42,96 +39,80 @@ class BitmapContainer;
 class BackwardsEdge;
 class Hypothesis;
 class HypothesisStackCubePruning;
-class HypothesisQueueItem;
-class QueueItemOrderer;
 class TranslationOptionList;
 
 typedef std::vector< Hypothesis* > HypothesisSet;
-typedef std::set< BackwardsEdge* > BackwardsEdgeSet;
-typedef std::priority_queue< HypothesisQueueItem*, std::vector< HypothesisQueueItem* >, QueueItemOrderer> HypothesisQueue;
+typedef std::vector< BackwardsEdge* > BackwardsEdgeList;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Hypothesis Priority Queue Code
 ////////////////////////////////////////////////////////////////////////////////
 
-//! 1 item in the priority queue for stack decoding (phrase-based)
-class HypothesisQueueItem
-{
-private:
-  size_t m_hypothesis_pos, m_translation_pos;
-  Hypothesis *m_hypothesis;
-  BackwardsEdge *m_edge;
-  boost::shared_ptr<TargetPhrase> m_target_phrase;
-
-  HypothesisQueueItem();
-
-public:
-  HypothesisQueueItem(const size_t hypothesis_pos
-                      , const size_t translation_pos
-                      , Hypothesis *hypothesis
-                      , BackwardsEdge *edge
-                      , const TargetPhrase *target_phrase = NULL)
-    : m_hypothesis_pos(hypothesis_pos)
-    , m_translation_pos(translation_pos)
-    , m_hypothesis(hypothesis)
-    , m_edge(edge) {
-    if (target_phrase != NULL) {
-      m_target_phrase.reset(new TargetPhrase(*target_phrase));
-    }
-  }
-
-  ~HypothesisQueueItem() {
-  }
-
-  int GetHypothesisPos() {
-    return m_hypothesis_pos;
-  }
-
-  int GetTranslationPos() {
-    return m_translation_pos;
-  }
-
-  Hypothesis *GetHypothesis() {
-    return m_hypothesis;
+//! 1 item in the priority queue of a BitmapContainer: the hypothesis made from a cube position of one of its edges
+struct HypothesisQueueItem {
+  Hypothesis *hypothesis;
+  uint32_t hypothesisPos, translationPos;
+  uint32_t edge; // index in the edges of the container
+
+  HypothesisQueueItem(Hypothesis *hypo, size_t hypoPos, size_t transPos, size_t edgeInd)
+    : hypothesis(hypo)
+    , hypothesisPos(hypoPos)
+    , translationPos(transPos)
+    , edge(edgeInd) {
   }
+};
 
-  BackwardsEdge *GetBackwardsEdge() {
-    return m_edge;
-  }
+//! entry of the heap of a BitmapContainer, the score is inline so that sifting doesn't touch the items
+struct HypothesisQueueEntry {
+  float score;
+  uint32_t item; // index in the items of the container
+};
 
-  boost::shared_ptr<TargetPhrase> GetTargetPhrase() {
-    return m_target_phrase;
-  }
+//! a hypothesis still to be made from a cube position, so that a batch of them can be scored together
+struct CubeSuccessor {
+  BackwardsEdge *edge;
+  uint32_t hypothesisPos, translationPos;
 };
 
-//! Allows comparison of two HypothesisQueueItem objects by the corresponding scores.
-class QueueItemOrderer
+/** Set of the cube positions an edge has explored. Open addressing with
+ *  linear probing in a flat array, which is grown to keep it at most half
+ *  full.
+ */
+class CubePositionSet
 {
 public:
-  bool operator()(HypothesisQueueItem* itemA, HypothesisQueueItem* itemB) const {
-    float scoreA = itemA->GetHypothesis()->GetFutureScore();
-    float scoreB = itemB->GetHypothesis()->GetFutureScore();
+  CubePositionSet()
+    : m_size(0) {
+  }
 
-    if (scoreA < scoreB) {
-      return true;
-    } else if (scoreA > scoreB) {
-      return false;
-    } else {
-      // Equal scores: break ties by comparing target phrases (if they exist)
-      // *Important*: these are pointers to copies of the target phrases from the
-      // hypotheses.  This class is used to keep priority queues ordered in the
-      // background, so comparisons made as those data structures are cleaned up
-      // may occur *after* the target phrases in hypotheses have been cleaned up,
-      // leading to segfaults if relying on hypotheses to provide target phrases.
-      boost::shared_ptr<TargetPhrase> phrA = itemA->GetTargetPhrase();
-      boost::shared_ptr<TargetPhrase> phrB = itemB->GetTargetPhrase();
-      if (!phrA || !phrB) {
-        // Fallback: scoreA < scoreB == false, non-deterministic sort
+  //! false if the position was already in the set
+  bool Insert(size_t x, size_t y) {
+    if (2 * (m_size + 1) > m_slots.size()) {
+      Grow();
+    }
+    uint64_t key = (((uint64_t) x << 32) | y) + 1; // 0 is an empty slot
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = Hash(key) & mask; ; i = (i + 1) & mask) {
+      if (m_slots[i] == key) {
         return false;
       }
-      return (phrA->Compare(*phrB) > 0);
+      if (m_slots[i] == 0) {
+        m_slots[i] = key;
+        ++m_size;
+        return true;
+      }
     }
   }
+
+protected:
+  std::vector<uint64_t> m_slots;
+  size_t m_size;
+
+  static size_t Hash(uint64_t key) {
+    return (key * 0x9e3779b97f4a7c15ULL) >> 32;
+  }
+
+  void Grow();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -183,6 +164,7 @@ private:
 
   const BitmapContainer &m_prevBitmapContainer;
   BitmapContainer &m_parent;
+  size_t m_index; // in the edges of m_parent
   const TranslationOptionList &m_translations;
   const SquareMatrix &m_estimatedScores;
   float m_estimatedScore;
@@ -190,14 +172,13 @@ private:
   bool m_deterministic;
 
   std::vector< const Hypothesis* > m_hypotheses;
-  boost::unordered_set< int > m_seenPosition;
+  CubePositionSet m_seenPosition;
 
   // We don't want to instantiate "empty" objects.
   BackwardsEdge();
 
   Hypothesis *CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt);
-  bool SeenPosition(const size_t x, const size_t y);
-  void SetSeenPosition(const size_t x, const size_t y);
+  Hypothesis *NewHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt);
 
 protected:
   void Initialize();
@@ -215,6 +196,11 @@ public:
   const BitmapContainer &GetBitmapContainer() const;
   int GetDistortionPenalty();
   void PushSuccessors(const size_t x, const size_t y);
+  //! the unseen successors of a position, to be made with PushSuccessors() below
+  void CollectSuccessors(const size_t x, const size_t y, std::vector<CubeSuccessor> &successors);
+
+  //! make and score the hypotheses of a batch of successors together, and queue them
+  static void PushSuccessors(const std::vector<CubeSuccessor> &successors);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -223,6 +209,8 @@ public:
 // A BitmapContainer encodes an ordered set of hypotheses and a set of edges
 // pointing to the "generating" BitmapContainers.  It also stores a priority
 // queue that contains expanded hypotheses from the connected edges.
+// The queue is a binary heap of (score, item index) entries, the items
+// themselves stay in place in an arena and their slots are reused.
 ////////////////////////////////////////////////////////////////////////////////
 
 class BitmapContainer
@@ -231,14 +219,23 @@ private:
   const Bitmap &m_bitmap;
   HypothesisStackCubePruning &m_stack;
   HypothesisSet m_hypotheses;
-  BackwardsEdgeSet m_edges;
-  HypothesisQueue m_queue;
+  BackwardsEdgeList m_edges;
+  std::vector<HypothesisQueueItem> m_items;
+  std::vector<uint32_t> m_freeItems; // unused slots of m_items
+  std::vector<HypothesisQueueEntry> m_queue; // heap, best on top
   size_t m_numStackInsertions;
   bool m_deterministic;
 
   // We always require a corresponding bitmap to be supplied.
   BitmapContainer();
   BitmapContainer(const BitmapContainer &);
+
+  //! ordering of the heap, with the target phrases to break ties in deterministic mode
+  bool Worse(const HypothesisQueueEntry &a, const HypothesisQueueEntry &b) const;
+  void SiftUp(size_t pos);
+  void SiftDown(size_t pos);
+  HypothesisQueueItem Pop();
+
 public:
   BitmapContainer(const Bitmap &bitmap
                   , HypothesisStackCubePruning &stack
@@ -248,22 +245,33 @@ public:
   // connected to this BitmapContainer.
   ~BitmapContainer();
 
-  void Enqueue(int hypothesis_pos, int translation_pos, Hypothesis *hypothesis, BackwardsEdge *edge);
-  HypothesisQueueItem *Dequeue(bool keepValue=false);
-  HypothesisQueueItem *Top() const;
+  void Enqueue(size_t hypothesis_pos, size_t translation_pos, Hypothesis *hypothesis, const BackwardsEdge *edge);
+
+  //! the best hypothesis in the queue, which must not be empty
+  const Hypothesis *Top() const {
+    return m_items[m_queue.front().item].hypothesis;
+  }
+
   size_t Size();
   bool Empty() const;
 
+  bool IsDeterministic() const {
+    return m_deterministic;
+  }
+
   const Bitmap &GetWordsBitmap() const {
     return m_bitmap;
   }
 
   const HypothesisSet &GetHypotheses() const;
   size_t GetHypothesesSize() const;
-  const BackwardsEdgeSet &GetBackwardsEdges();
+  const BackwardsEdgeList &GetBackwardsEdges();
 
   void InitializeEdges();
-  void ProcessBestHypothesis();
+  /** add the best hypothesis of the queue to the stack and push its
+   *  successors. With a batch, the successors are only added to it, for
+   *  BackwardsEdge::PushSuccessors() */
+  void ProcessBestHypothesis(std::vector<CubeSuccessor> *batch = NULL);
   void EnsureMinStackHyps(const size_t minNumHyps);
   void AddHypothesis(Hypothesis *hypothesis);
   void AddBackwardsEdge(BackwardsEdge *edge);
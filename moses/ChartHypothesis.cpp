@@ -188,6 +188,7 @@ void ChartHypothesis::EvaluateWhenApplied()
     StatelessFeatureFunction::GetStatelessFeatureFunctions();
   for (unsigned i = 0; i < sfs.size(); ++i) {
     if (! staticData.IsFeatureFunctionIgnored( *sfs[i] )) {
+      Profiler::Scope profile(sfs[i]->GetProfilerEvent(Profiler::EvaluateWhenApplied));
       sfs[i]->EvaluateWhenApplied(*this,&m_currScoreBreakdown);
     }
   }
@@ -196,6 +197,7 @@ void ChartHypothesis::EvaluateWhenApplied()
     StatefulFeatureFunction::GetStatefulFeatureFunctions();
   for (unsigned i = 0; i < ffs.size(); ++i) {
     if (! staticData.IsFeatureFunctionIgnored( *ffs[i] )) {
+      Profiler::Scope profile(ffs[i]->GetProfilerEvent(Profiler::EvaluateWhenApplied));
       m_ffStates[i] = ffs[i]->EvaluateWhenApplied(*this,i,&m_currScoreBreakdown);
     }
   }
@@ -35,6 +35,7 @@
 #include "moses/ChartKBestExtractor.h"
 #include "moses/HypergraphOutput.h"
 #include "moses/TranslationTask.h"
+#include "moses/Profiler.h"
 
 using namespace std;
 
@@ -85,15 +86,21 @@ void ChartManager::Decode()
 
       // create trans opt
       m_translationOptionList.Clear();
-      m_parser.Create(range, m_translationOptionList);
-      m_translationOptionList.ApplyThreshold(options()->search.trans_opt_threshold);
+      {
+        Profiler::Scope profile(Profiler::CollectTranslationOptions);
+        m_parser.Create(range, m_translationOptionList);
+        m_translationOptionList.ApplyThreshold(options()->search.trans_opt_threshold);
 
-      const InputPath &inputPath = m_parser.GetInputPath(range);
-      m_translationOptionList.EvaluateWithSourceContext(m_source, inputPath);
+        const InputPath &inputPath = m_parser.GetInputPath(range);
+        m_translationOptionList.EvaluateWithSourceContext(m_source, inputPath);
+      }
 
       // decode
       ChartCell &cell = m_hypoStackColl.Get(range);
-      cell.Decode(m_translationOptionList, m_hypoStackColl);
+      {
+        Profiler::Scope profile(Profiler::Search);
+        cell.Decode(m_translationOptionList, m_hypoStackColl);
+      }
 
       m_translationOptionList.Clear();
       cell.PruneToSize();
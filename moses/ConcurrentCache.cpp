@@ -0,0 +1,108 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+#include <algorithm>
+#include "ConcurrentCache.h"
+
+namespace Moses
+{
+
+namespace
+{
+const size_t SKETCH_ROWS = 4;
+const unsigned char SKETCH_MAX_COUNT = 15;
+}
+
+ConcurrentCacheStats::ConcurrentCacheStats()
+  : hits(0), misses(0)
+  , inserted(0), rejected(0), evicted(0)
+  , entries(0), bytes(0), capacity(0)
+{
+}
+
+ConcurrentCacheStats &ConcurrentCacheStats::operator+=(const ConcurrentCacheStats &other)
+{
+  hits += other.hits;
+  misses += other.misses;
+  inserted += other.inserted;
+  rejected += other.rejected;
+  evicted += other.evicted;
+  entries += other.entries;
+  bytes += other.bytes;
+  capacity += other.capacity;
+  return *this;
+}
+
+std::ostream &operator<<(std::ostream &out, const ConcurrentCacheStats &stats)
+{
+  uint64_t lookups = stats.hits + stats.misses;
+  out << "lookups=" << lookups
+      << " hits=" << stats.hits;
+  if (lookups) {
+    out << " (" << (100.0 * stats.hits / lookups) << "%)";
+  }
+  out << " inserted=" << stats.inserted
+      << " rejected=" << stats.rejected
+      << " evicted=" << stats.evicted
+      << " entries=" << stats.entries
+      << " bytes=" << stats.bytes << "/" << stats.capacity;
+  return out;
+}
+
+FrequencySketch::FrequencySketch(size_t width)
+  : m_mask(64)
+  , m_additions(0)
+{
+  while (m_mask < width) {
+    m_mask <<= 1;
+  }
+  m_table.resize(m_mask * SKETCH_ROWS, 0);
+  m_sampleSize = 10 * m_mask;
+  --m_mask;
+}
+
+void FrequencySketch::Increment(uint64_t hash)
+{
+  for (size_t row = 0; row < SKETCH_ROWS; ++row) {
+    unsigned char &counter = m_table[Index(hash, row)];
+    if (counter < SKETCH_MAX_COUNT) {
+      ++counter;
+    }
+  }
+  if (++m_additions >= m_sampleSize) {
+    Age();
+  }
+}
+
+void FrequencySketch::Clear()
+{
+  std::fill(m_table.begin(), m_table.end(), 0);
+  m_additions = 0;
+}
+
+unsigned int FrequencySketch::Estimate(uint64_t hash) const
+{
+  unsigned int ret = SKETCH_MAX_COUNT;
+  for (size_t row = 0; row < SKETCH_ROWS; ++row) {
+    ret = std::min<unsigned int>(ret, m_table[Index(hash, row)]);
+  }
+  return ret;
+}
+
+size_t FrequencySketch::Index(uint64_t hash, size_t row) const
+{
+  // a different multiplier per row makes the rows independent enough
+  static const uint64_t seeds[SKETCH_ROWS] = {
+    0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL,
+    0x94d049bb133111ebULL, 0xd6e8feb86659fd93ULL
+  };
+  return row * (m_mask + 1) + ((hash * seeds[row]) >> 40 & m_mask);
+}
+
+void FrequencySketch::Age()
+{
+  for (size_t i = 0; i < m_table.size(); ++i) {
+    m_table[i] >>= 1;
+  }
+  m_additions /= 2;
+}
+
+}
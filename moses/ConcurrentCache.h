@@ -0,0 +1,293 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_ConcurrentCache_h
+#define moses_ConcurrentCache_h
+
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+namespace Moses
+{
+
+//! counters of a ConcurrentCache
+struct ConcurrentCacheStats {
+  uint64_t hits, misses;
+  uint64_t inserted, rejected, evicted;
+  size_t entries, bytes, capacity;
+
+  ConcurrentCacheStats();
+  ConcurrentCacheStats &operator+=(const ConcurrentCacheStats &other);
+};
+
+std::ostream &operator<<(std::ostream &out, const ConcurrentCacheStats &stats);
+
+/** Count-min sketch of how often keys were looked up recently, with 4 bit
+ *  counters in 4 rows. Every counter is halved after a sample of 10 lookups
+ *  per column, so old popularity fades. Not thread safe.
+ */
+class FrequencySketch
+{
+public:
+  explicit FrequencySketch(size_t width);
+
+  void Increment(uint64_t hash);
+  unsigned int Estimate(uint64_t hash) const;
+  //! forget all counts
+  void Clear();
+
+protected:
+  std::vector<unsigned char> m_table;
+  size_t m_mask;
+  size_t m_sampleSize, m_additions;
+
+  size_t Index(uint64_t hash, size_t row) const;
+  void Age();
+};
+
+//! spreads the bits of a hash
+inline uint64_t MixHash(uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+/** Cache of values shared by all threads, with a memory limit.
+ *
+ *  Keys are split over shards, each with its own lock, entries and CLOCK
+ *  hand, and each holding at most its share of the byte capacity. When a new
+ *  entry doesn't fit, CLOCK picks a victim that hasn't been used since the
+ *  hand last passed. TinyLFU admission then keeps whichever of the two has
+ *  been asked for more often recently, according to a FrequencySketch of all
+ *  lookups. So a stream of one-off keys can't flush out the frequent ones.
+ *
+ *  Values are copied in and out under the shard lock, so they should be
+ *  cheap to copy, eg. shared pointers to immutable data.
+ */
+template <class Key, class Value, class Hash = boost::hash<Key> >
+class ConcurrentCache
+{
+public:
+  typedef ConcurrentCacheStats Stats;
+
+  explicit ConcurrentCache(size_t capacityBytes, size_t numShards = 64)
+    : m_capacity(capacityBytes) {
+    for (size_t i = 0; i < numShards; ++i) {
+      m_shards.push_back(new Shard(capacityBytes / numShards));
+    }
+  }
+
+  ~ConcurrentCache() {
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+      delete m_shards[i];
+    }
+  }
+
+  //! false if not cached. Counts the lookup either way
+  bool Find(const Key &key, Value &value) const {
+    uint64_t hash = MixHash(m_hash(key));
+    return GetShard(hash).Find(key, hash, value);
+  }
+
+  //! bytes is the approximate memory used by the entry
+  void Insert(const Key &key, const Value &value, size_t bytes) const {
+    uint64_t hash = MixHash(m_hash(key));
+    GetShard(hash).Insert(key, hash, value, bytes);
+  }
+
+  //! remove all entries and forget how often keys were looked up
+  void Clear() const {
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+      m_shards[i]->Clear();
+    }
+  }
+
+  Stats GetStats() const {
+    Stats ret;
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+      ret += m_shards[i]->GetStats();
+    }
+    ret.capacity = m_capacity;
+    return ret;
+  }
+
+protected:
+  class Shard
+  {
+  public:
+    explicit Shard(size_t capacity)
+      : m_capacity(capacity)
+      , m_bytes(0)
+      , m_hand(0)
+      , m_sketch(capacity / TYPICAL_ENTRY_BYTES) {
+    }
+
+    bool Find(const Key &key, uint64_t hash, Value &value) {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_mutex);
+#endif
+      m_sketch.Increment(hash);
+      typename Index::const_iterator iter = m_index.find(key);
+      if (iter == m_index.end()) {
+        ++m_stats.misses;
+        return false;
+      }
+      Entry &entry = m_entries[iter->second];
+      entry.referenced = true;
+      value = entry.value;
+      ++m_stats.hits;
+      return true;
+    }
+
+    void Insert(const Key &key, uint64_t hash, const Value &value, size_t bytes) {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_mutex);
+#endif
+      if (m_index.find(key) != m_index.end()) {
+        // another thread got there first
+        return;
+      }
+      if (bytes > m_capacity) {
+        ++m_stats.rejected;
+        return;
+      }
+
+      unsigned int frequency = m_sketch.Estimate(hash);
+      while (m_bytes + bytes > m_capacity) {
+        size_t victim = FindVictim();
+        if (frequency <= m_sketch.Estimate(m_entries[victim].hash)) {
+          ++m_stats.rejected;
+          return;
+        }
+        Remove(victim);
+        ++m_stats.evicted;
+      }
+
+      m_index[key] = m_entries.size();
+      m_entries.push_back(Entry(key, hash, value, bytes));
+      m_bytes += bytes;
+      ++m_stats.inserted;
+    }
+
+    void Clear() {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_mutex);
+#endif
+      m_stats.evicted += m_entries.size();
+      m_index.clear();
+      m_entries.clear();
+      m_bytes = 0;
+      m_hand = 0;
+      m_sketch.Clear();
+    }
+
+    Stats GetStats() {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_mutex);
+#endif
+      Stats ret = m_stats;
+      ret.entries = m_entries.size();
+      ret.bytes = m_bytes;
+      return ret;
+    }
+
+  protected:
+    // to size the sketch
+    static const size_t TYPICAL_ENTRY_BYTES = 1024;
+
+    struct Entry {
+      Key key;
+      uint64_t hash;
+      Value value;
+      size_t bytes;
+      bool referenced; // used since the hand last passed
+
+      Entry(const Key &k, uint64_t h, const Value &v, size_t b)
+        : key(k), hash(h), value(v), bytes(b), referenced(false) {
+      }
+    };
+    typedef boost::unordered_map<Key, size_t, Hash> Index;
+
+#ifdef WITH_THREADS
+    boost::mutex m_mutex;
+#endif
+    Index m_index; // key -> position in m_entries
+    std::vector<Entry> m_entries; // the clock
+    size_t m_capacity, m_bytes;
+    size_t m_hand;
+    FrequencySketch m_sketch;
+    Stats m_stats;
+
+    // the first entry from the hand on that hasn't been used recently.
+    // Clears the used bit of the ones it passes. Needs a non-empty clock
+    size_t FindVictim() {
+      while (true) {
+        if (m_hand >= m_entries.size()) {
+          m_hand = 0;
+        }
+        Entry &entry = m_entries[m_hand];
+        if (!entry.referenced) {
+          return m_hand;
+        }
+        entry.referenced = false;
+        ++m_hand;
+      }
+    }
+
+    void Remove(size_t pos) {
+      m_bytes -= m_entries[pos].bytes;
+      m_index.erase(m_entries[pos].key);
+      if (pos + 1 != m_entries.size()) {
+        m_entries[pos] = m_entries.back();
+        m_index[m_entries[pos].key] = pos;
+      }
+      m_entries.pop_back();
+    }
+  };
+
+  std::vector<Shard*> m_shards;
+  size_t m_capacity;
+  Hash m_hash;
+
+  // top bits pick the shard, the sketch uses the rest
+  Shard &GetShard(uint64_t hash) const {
+    return *m_shards[(hash >> 48) % m_shards.size()];
+  }
+
+private:
+  ConcurrentCache(const ConcurrentCache &);
+  ConcurrentCache &operator=(const ConcurrentCache &);
+};
+
+}
+
+#endif
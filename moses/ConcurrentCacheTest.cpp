@@ -0,0 +1,157 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2010- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include "ConcurrentCache.h"
+
+using namespace Moses;
+using namespace std;
+
+// the tests with one shard of 100 bytes make every entry compete for it
+typedef ConcurrentCache<int, int> Cache;
+
+BOOST_AUTO_TEST_SUITE(concurrent_cache)
+
+BOOST_AUTO_TEST_CASE(hit_miss)
+{
+  Cache cache(100, 1);
+  int value = 0;
+  BOOST_CHECK(!cache.Find(1, value));
+  cache.Insert(1, 11, 10);
+  BOOST_CHECK(cache.Find(1, value));
+  BOOST_CHECK_EQUAL(value, 11);
+  BOOST_CHECK(!cache.Find(2, value));
+
+  ConcurrentCacheStats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.hits, 1);
+  BOOST_CHECK_EQUAL(stats.misses, 2);
+  BOOST_CHECK_EQUAL(stats.inserted, 1);
+  BOOST_CHECK_EQUAL(stats.rejected, 0);
+  BOOST_CHECK_EQUAL(stats.evicted, 0);
+  BOOST_CHECK_EQUAL(stats.entries, 1);
+  BOOST_CHECK_EQUAL(stats.bytes, 10);
+  BOOST_CHECK_EQUAL(stats.capacity, 100);
+}
+
+BOOST_AUTO_TEST_CASE(too_big)
+{
+  Cache cache(100, 1);
+  cache.Insert(1, 11, 101);
+  int value;
+  BOOST_CHECK(!cache.Find(1, value));
+  BOOST_CHECK_EQUAL(cache.GetStats().rejected, 1);
+  BOOST_CHECK_EQUAL(cache.GetStats().entries, 0);
+}
+
+BOOST_AUTO_TEST_CASE(admission)
+{
+  Cache cache(100, 1);
+  int value;
+  for (int key = 0; key < 10; ++key) {
+    cache.Insert(key, key, 10);
+    for (size_t i = 0; i < 3; ++i) {
+      BOOST_CHECK(cache.Find(key, value));
+    }
+  }
+
+  // never asked for, so less popular than any entry
+  cache.Insert(100, 100, 10);
+  ConcurrentCacheStats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.rejected, 1);
+  BOOST_CHECK_EQUAL(stats.evicted, 0);
+  BOOST_CHECK_EQUAL(stats.entries, 10);
+  for (int key = 0; key < 10; ++key) {
+    BOOST_CHECK(cache.Find(key, value));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(eviction)
+{
+  Cache cache(100, 1);
+  int value;
+  for (int key = 0; key < 10; ++key) {
+    cache.Insert(key, key, 10);
+  }
+  BOOST_CHECK_EQUAL(cache.GetStats().bytes, 100);
+
+  // more popular than the entries, which were never looked up
+  for (size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK(!cache.Find(100, value));
+  }
+  cache.Insert(100, 100, 30);
+  BOOST_CHECK(cache.Find(100, value));
+  BOOST_CHECK_EQUAL(value, 100);
+
+  ConcurrentCacheStats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.evicted, 3);
+  BOOST_CHECK_EQUAL(stats.entries, 8);
+  BOOST_CHECK_EQUAL(stats.bytes, 100);
+}
+
+BOOST_AUTO_TEST_CASE(clear)
+{
+  Cache cache(100, 1);
+  int value;
+  for (int key = 0; key < 10; ++key) {
+    cache.Insert(key, key, 10);
+    BOOST_CHECK(cache.Find(key, value));
+  }
+  for (size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK(!cache.Find(50, value));
+  }
+
+  cache.Clear();
+  ConcurrentCacheStats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.entries, 0);
+  BOOST_CHECK_EQUAL(stats.bytes, 0);
+  BOOST_CHECK_EQUAL(stats.evicted, 10);
+  BOOST_CHECK(!cache.Find(0, value));
+
+  for (int key = 10; key < 20; ++key) {
+    cache.Insert(key, key, 10);
+  }
+  BOOST_CHECK_EQUAL(cache.GetStats().entries, 10);
+
+  // the lookups of 50 before the clear are forgotten, so it is no more
+  // popular than the entries
+  cache.Insert(50, 50, 10);
+  BOOST_CHECK_EQUAL(cache.GetStats().rejected, 1);
+  BOOST_CHECK(!cache.Find(50, value));
+}
+
+BOOST_AUTO_TEST_CASE(shards)
+{
+  Cache cache(1000, 4);
+  int value;
+  for (int key = 0; key < 20; ++key) {
+    cache.Insert(key, key, 10);
+  }
+  for (int key = 0; key < 20; ++key) {
+    BOOST_CHECK(cache.Find(key, value));
+    BOOST_CHECK_EQUAL(value, key);
+  }
+  ConcurrentCacheStats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.entries, 20);
+  BOOST_CHECK_EQUAL(stats.bytes, 200);
+  BOOST_CHECK_EQUAL(stats.hits, 20);
+  BOOST_CHECK_EQUAL(stats.capacity, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
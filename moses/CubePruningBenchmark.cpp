@@ -0,0 +1,96 @@
+// End to end benchmark of cube pruning.
+// Decodes random sentences of the synthetic model, with its bigram language
+// model, with cube pruning, popping one hypothesis at a time (exact) and with
+// cube-pruning-batch-size from 2 to the given maximum, where the successors
+// of a batch are scored together and the language model prefetches.
+// Reports the time, hypotheses made and the sum of the best scores, which
+// may differ a little from the exact search with batches.
+//
+// Usage: CubePruningBenchmark [sentences] [sentence-length] [vocab-size] [pop-limit] [max-batch]
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Benchmark.h"
+#include "Hypothesis.h"
+#include "Manager.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationTask.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace
+{
+
+struct Result {
+  double seconds;
+  size_t hypotheses;
+  double totalScore;
+};
+
+Result Decode(const vector<string> &sentences, size_t popLimit, size_t batchSize)
+{
+  Result ret = { 0, 0, 0 };
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    AllOptions *options = new AllOptions(*StaticData::Instance().options());
+    options->search.algo = CubePruning;
+    options->cube.pop_limit = popLimit;
+    options->cube.batch_size = batchSize;
+    AllOptions::ptr opts(options);
+    boost::shared_ptr<Sentence> sentence(new Sentence(opts, i, sentences[i]));
+    ttasksptr ttask = TranslationTask::create(sentence);
+    Manager manager(ttask);
+
+    double begin = util::WallTime();
+    manager.Decode();
+    ret.seconds += util::WallTime() - begin;
+    ret.hypotheses += manager.GetNextHypoId();
+    const Hypothesis *best = manager.GetBestHypothesis();
+    if (best) ret.totalScore += best->GetFutureScore();
+  }
+  return ret;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  size_t numSentences = argc > 1 ? atoi(argv[1]) : 5;
+  size_t length = argc > 2 ? atoi(argv[2]) : 20;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 1000;
+  size_t popLimit = argc > 4 ? atoi(argv[4]) : 1000;
+  size_t maxBatch = argc > 5 ? atoi(argv[5]) : 64;
+
+  Benchmark::SyntheticModel::Config config;
+  config.vocabSize = vocabSize;
+  config.translationsPerWord = 8;
+  config.languageModel = true;
+  Benchmark::SyntheticModel model("cube-bench", config);
+  if (!model.Load(argv[0])) {
+    return 1;
+  }
+
+  vector<string> sentences;
+  unsigned int seed = 42;
+  for (size_t i = 0; i < numSentences; ++i) {
+    sentences.push_back(model.MakeSentence(length, seed));
+  }
+
+  Result exact = Decode(sentences, popLimit, 1);
+  cout << "batch\tseconds\thypotheses\tscore" << endl;
+  cout << 1 << "\t" << exact.seconds << "\t" << exact.hypotheses << "\t" << exact.totalScore << endl;
+  for (size_t batchSize = 2; batchSize <= maxBatch; batchSize *= 4) {
+    Result batched = Decode(sentences, popLimit, batchSize);
+    cout << batchSize << "\t" << batched.seconds << "\t" << batched.hypotheses
+         << "\t" << batched.totalScore << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+// End to end benchmark of heap allocations while decoding.
+// Writes a synthetic phrase table and moses.ini to a temporary directory,
+// decodes random sentences with the normal search, and counts calls to
+// operator new made by Manager::Decode() per hypothesis created.
+// It also counts the allocations made by copying a ScoreComponentCollection,
+// which happens for every hypothesis and translation option.
+//
+// Compare builds with the default --inline-dense-scores and with
+// --inline-dense-scores=0 to see the effect of the inline dense scores.
+//
+// Usage: DecodeAllocationBenchmark [sentences] [sentence-length] [vocab-size]
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Benchmark.h"
+#include "Manager.h"
+#include "ScoreComponentCollection.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationTask.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace
+{
+boost::atomic<size_t> g_numAllocs(0);
+}
+
+void *operator new(size_t size)
+{
+  g_numAllocs.fetch_add(1, boost::memory_order_relaxed);
+  void *ret = malloc(size ? size : 1);
+  if (!ret) throw std::bad_alloc();
+  return ret;
+}
+
+void operator delete(void *ptr) throw()
+{
+  free(ptr);
+}
+
+int main(int argc, char *argv[])
+{
+  size_t numSentences = argc > 1 ? atoi(argv[1]) : 20;
+  size_t length = argc > 2 ? atoi(argv[2]) : 30;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 1000;
+
+  // every source word has 5 translations, and every pair of consecutive ids
+  // 3 more, so there are plenty of overlapping options to build hypotheses from
+  Benchmark::SyntheticModel::Config config;
+  config.vocabSize = vocabSize;
+  config.translationsPerWord = 5;
+  config.translationsPerPair = 3;
+  Benchmark::SyntheticModel model("alloc-bench", config);
+  if (!model.Load(argv[0])) {
+    return 1;
+  }
+
+  size_t totalAllocs = 0, totalHypos = 0;
+  double begin = util::WallTime();
+  unsigned int seed = 42;
+  for (size_t i = 0; i < numSentences; ++i) {
+    AllOptions::ptr opts(new AllOptions(*StaticData::Instance().options()));
+    boost::shared_ptr<Sentence> sentence(new Sentence(opts, i, model.MakeSentence(length, seed)));
+    ttasksptr ttask = TranslationTask::create(sentence);
+    Manager manager(ttask);
+
+    size_t before = g_numAllocs.load();
+    manager.Decode();
+    totalAllocs += g_numAllocs.load() - before;
+    totalHypos += manager.GetNextHypoId();
+  }
+  double decodeTime = util::WallTime() - begin;
+
+  // allocations made by copying the scores of a translation option with a
+  // sparse feature and adding dense scores to the copy, as a hypothesis does
+  ScoreComponentCollection scores, dense;
+  scores.SparsePlusEquals(FName("sparse_feature"), 1.0);
+  const size_t numCopies = 100000;
+  size_t before = g_numAllocs.load();
+  for (size_t i = 0; i < numCopies; ++i) {
+    ScoreComponentCollection copy(scores);
+    copy.PlusEquals(dense);
+  }
+  double allocsPerCopy = (double) (g_numAllocs.load() - before) / numCopies;
+
+  cout << "dense features             " << scores.getCoreFeatures().size()
+       << " (" << FVECTOR_INLINE_CORE << " inline)" << endl
+       << "sentences                  " << numSentences << endl
+       << "hypotheses                 " << totalHypos << endl
+       << "allocations while decoding " << totalAllocs << endl
+       << "allocations per hypothesis " << (totalHypos ? (double) totalAllocs / totalHypos : 0) << endl
+       << "allocations per score copy " << allocsPerCopy << endl
+       << "decoding time (s)          " << decodeTime << endl;
+
+  return 0;
+}
@@ -47,6 +47,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "FF/StatefulFeatureFunction.h"
 #include "FF/StatelessFeatureFunction.h"
 #include "TranslationTask.h"
+#include "Profiler.h"
 #include "ExportInterface.h"
 
 #ifdef HAVE_PROTOBUF
@@ -298,6 +299,13 @@ batch_run()
 
 //  cerr << "g_numHypos=" << Moses::g_numHypos << endl;
 
+  string profileFile;
+  params.SetParameter<string>(profileFile, "profile-file", "");
+  if (!profileFile.empty()) {
+    std::ofstream profileOut(profileFile.c_str());
+    Profiler::WriteJson(profileOut);
+  }
+
   FeatureFunction::Destroy();
 
   IFVERBOSE(0) util::PrintUsage(std::cerr);
@@ -88,6 +88,12 @@ public:
                            , ScoreComponentCollection &estimatedScores) const {
   }
 
+  //! does nothing in isolation. Phrase tables are only looked up on the
+  //! decoding thread, generation tables only read
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   void SetContainer(const DecodeStep *container) {
     m_container = container;
   }
@@ -35,6 +35,10 @@ public:
     return true;
   }
 
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   static float CalculateDistortionScore(const Hypothesis& hypo,
                                         const Range &prev, const Range &curr, const int FirstGapPosition);
 
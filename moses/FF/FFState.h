@@ -4,6 +4,7 @@
 #include <vector>
 #include <stddef.h>
 #include "util/exception.hh"
+#include "moses/SentenceArena.h"
 
 namespace Moses
 {
@@ -12,6 +13,14 @@ class FFState
 {
 public:
   virtual ~FFState();
+
+  //! from the Manager's SentenceArena while it decodes
+  static void *operator new(size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
   virtual size_t hash() const = 0;
   virtual bool operator==(const FFState& other) const = 0;
 
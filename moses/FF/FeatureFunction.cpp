@@ -51,6 +51,7 @@ FeatureFunction(const std::string& line, bool registerNow)
   , m_verbosity(std::numeric_limits<std::size_t>::max())
   , m_numScoreComponents(1)
   , m_index(0)
+  , m_profilerEvent(Profiler::MaxEvents)
 {
   m_numTuneableComponents = m_numScoreComponents;
   ParseLine(line);
@@ -64,6 +65,7 @@ FeatureFunction::FeatureFunction(size_t numScoreComponents, const std::string& l
   , m_verbosity(std::numeric_limits<std::size_t>::max())
   , m_numScoreComponents(numScoreComponents)
   , m_index(0)
+  , m_profilerEvent(Profiler::MaxEvents)
 {
   m_numTuneableComponents = m_numScoreComponents;
   ParseLine(line);
@@ -77,6 +79,7 @@ Register(FeatureFunction* ff)
 {
   ScoreComponentCollection::RegisterScoreProducer(ff);
   s_staticColl.push_back(ff);
+  ff->m_profilerEvent = Profiler::RegisterFeatureFunction();
 }
 
 FeatureFunction::~FeatureFunction() {}
@@ -8,6 +8,7 @@
 #include "moses/FeatureVector.h"
 #include "moses/TypeDef.h"
 #include "moses/parameters/AllOptions.h"
+#include "moses/Profiler.h"
 #include <boost/shared_ptr.hpp>
 
 namespace Moses
@@ -29,6 +30,7 @@ class InputPath;
 class StackVec;
 class DistortionScoreProducer;
 class TranslationTask;
+struct ConcurrentCacheStats;
 
 /** base class for all feature functions.
  */
@@ -45,6 +47,7 @@ protected:
   size_t m_verbosity;
   size_t m_numScoreComponents;
   size_t m_index; // index into vector covering ALL feature function values
+  size_t m_profilerEvent; // first of the Profiler events of this feature
   std::vector<bool> m_tuneableComponents;
   size_t m_numTuneableComponents;
   AllOptions::ptr m_options;
@@ -126,6 +129,23 @@ public:
   size_t GetIndex() const;
   size_t SetIndex(size_t const idx);
 
+  //! for Profiler::Scope
+  size_t GetProfilerEvent(Profiler::FeatureFunctionCall call) const {
+    return m_profilerEvent + call;
+  }
+
+  //! true if EvaluateInIsolation() can score the target phrases of a
+  //! sentence on several threads at once, see translation-option-threads.
+  //! Only if the FF keeps no mutable or per input state
+  virtual bool IsThreadSafeInIsolation() const {
+    return false;
+  }
+
+  //! statistics of a cache shared across sentences, false if there is none
+  virtual bool GetCacheStats(ConcurrentCacheStats &stats) const {
+    return false;
+  }
+
 protected:
   virtual void
   CleanUpAfterSentenceProcessing(InputType const& source) { }
@@ -31,6 +31,10 @@ public:
     return true;
   }
 
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   size_t GetNumInputScores() const {
     return m_numInputScores;
   }
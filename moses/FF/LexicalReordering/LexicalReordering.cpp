@@ -18,6 +18,7 @@ namespace Moses
 LexicalReordering::
 LexicalReordering(const std::string &line)
   : StatefulFeatureFunction(line,false)
+  , m_cacheMB(0)
 {
   VERBOSE(1, "Initializing Lexical Reordering Feature.." << std::endl);
 
@@ -36,6 +37,8 @@ LexicalReordering(const std::string &line)
       m_factorsE =Tokenize<FactorType>(args[1]);
     else if (args[0] == "path")
       m_filePath = args[1];
+    else if (args[0] == "cache-mb")
+      m_cacheMB = Scan<size_t>(args[1]);
     else if (starts_with(args[0], "sparse-"))
       sparseArgs[args[0].substr(7)] = args[1];
     else if (args[0] == "default-scores") {
@@ -90,7 +93,8 @@ Load(AllOptions::ptr const& opts)
   typedef LexicalReorderingTable LRTable;
   if (m_filePath.size())
     m_table.reset(LRTable::LoadAvailable(m_filePath, m_factorsF,
-                                         m_factorsE, std::vector<FactorType>()));
+                                         m_factorsE, std::vector<FactorType>(),
+                                         m_cacheMB << 20));
 }
 
 Scores
@@ -100,6 +104,17 @@ GetProb(const Phrase& f, const Phrase& e) const
   return m_table->GetScore(f, e, Phrase(ARRAY_SIZE_INCR));
 }
 
+bool
+LexicalReordering::
+GetCacheStats(ConcurrentCacheStats &stats) const
+{
+  const LexicalReorderingTableTree *tree
+    = dynamic_cast<const LexicalReorderingTableTree*>(m_table.get());
+  if (!tree || !tree->GetCache()) return false;
+  stats = tree->GetCache()->GetStats();
+  return true;
+}
+
 FFState*
 LexicalReordering::
 EvaluateWhenApplied(const Hypothesis& hypo,
@@ -39,6 +39,12 @@ public:
   bool
   IsUseable(const FactorMask &mask) const;
 
+  //! scores nothing in isolation
+  bool
+  IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   virtual
   FFState const*
   EmptyHypothesisState(const InputType &input) const;
@@ -51,6 +57,9 @@ public:
   Scores
   GetProb(const Phrase& f, const Phrase& e) const;
 
+  bool
+  GetCacheStats(ConcurrentCacheStats &stats) const;
+
   virtual
   FFState*
   EvaluateWhenApplied(const Hypothesis& cur_hypo,
@@ -94,6 +103,7 @@ private:
   std::vector<LRModel::Condition> m_condition;
   std::vector<FactorType> m_factorsE, m_factorsF;
   std::string m_filePath;
+  size_t m_cacheMB; // lookups cached across sentences, binary tables only. 0 = off
   bool m_haveDefaultScores;
   Scores m_defaultScores;
 public:
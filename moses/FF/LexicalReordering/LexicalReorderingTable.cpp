@@ -50,7 +50,8 @@ LexicalReorderingTable::
 LoadAvailable(const std::string& filePath,
               const FactorList& f_factors,
               const FactorList& e_factors,
-              const FactorList& c_factors)
+              const FactorList& c_factors,
+              size_t cacheBytes)
 {
   //decide use Compact or Tree or Memory table
 #ifdef HAVE_CMPH
@@ -62,7 +63,7 @@ LoadAvailable(const std::string& filePath,
   LexicalReorderingTable* ret;
   if (FileExists(filePath+".binlexr.idx") )
     ret = new LexicalReorderingTableTree(filePath, f_factors,
-                                         e_factors, c_factors);
+                                         e_factors, c_factors, cacheBytes);
   else
     ret = new LexicalReorderingTableMemory(filePath, f_factors,
                                            e_factors, c_factors);
@@ -213,18 +214,26 @@ LexicalReorderingTableTree::
 LexicalReorderingTableTree(const std::string& filePath,
                            const std::vector<FactorType>& f_factors,
                            const std::vector<FactorType>& e_factors,
-                           const std::vector<FactorType>& c_factors)
+                           const std::vector<FactorType>& c_factors,
+                           size_t cacheBytes)
   : LexicalReorderingTable(f_factors, e_factors, c_factors)
-  , m_UseCache(false)
   , m_FilePath(filePath)
 {
+  if (cacheBytes) {
+    m_Cache.reset(new CacheType(cacheBytes));
+  }
   m_Table.reset(new PrefixTreeMap());
   m_Table->Read(m_FilePath+".binlexr");
 }
 
 LexicalReorderingTableTree::
 ~LexicalReorderingTableTree()
-{ }
+{
+  if (m_Cache) {
+    VERBOSE(1, "Lexical reordering cache for " << m_FilePath << ": "
+            << m_Cache->GetStats() << std::endl);
+  }
+}
 
 Scores
 LexicalReorderingTableTree::
@@ -239,27 +248,23 @@ GetScore(const Phrase& f, const Phrase& e, const Phrase& c)
     return Scores();
   }
 
-  CacheType::iterator i;
-
-  if(m_UseCache) {
-    std::pair<CacheType::iterator, bool> r;
-    r = m_Cache.insert(std::make_pair(MakeCacheKey(f,e),Candidates()));
-    if(!r.second) return auxFindScoreForContext((r.first)->second, c);
-    i = r.first;
-  } else if((i = m_Cache.find(MakeCacheKey(f,e))) != m_Cache.end())
-    // although we might not be caching now, cache might be none empty!
-    return auxFindScoreForContext(i->second, c);
-
-  // not in cache => go to file...
-  Candidates cands;
-  m_Table->GetCandidates(MakeTableKey(f,e), &cands);
-  if(cands.empty()) return Scores();
-  if(m_UseCache) i->second = cands;
+  if(!m_Cache) {
+    Candidates cands;
+    m_Table->GetCandidates(MakeTableKey(f,e), &cands);
+    return auxFindScoreForContext(cands, c);
+  }
 
-  if(m_FactorsC.empty()) {
-    UTIL_THROW_IF2(1 != cands.size(), "Error");
-    return cands[0].GetScore(0);
-  } else return auxFindScoreForContext(cands, c);
+  CacheKey key;
+  MakeCacheKey(f, e, key);
+  CandidatesPtr cands;
+  if(!m_Cache->Find(key, cands)) {
+    // not in cache => go to file...
+    Candidates *found = new Candidates;
+    cands.reset(found);
+    m_Table->GetCandidates(MakeTableKey(f,e), found);
+    auxCache(key, cands);
+  }
+  return auxFindScoreForContext(*cands, c);
 };
 
 Scores
@@ -293,14 +298,7 @@ void
 LexicalReorderingTableTree::
 InitializeForInput(ttasksptr const& ttask)
 {
-  const InputType& input = *ttask->GetSource();
-  ClearCache();
-  if(ConfusionNet const* cn = dynamic_cast<ConfusionNet const*>(&input)) {
-    Cache(*cn);
-  } else if (dynamic_cast<Sentence const*>(&input)) {
-    // Cache(*s); ... this just takes up too much memory, we cache elsewhere
-    DisableCache();
-  }
+  // the cache is shared and kept across sentences, nothing to do for it
   if (!m_Table.get()) {
     //load thread specific table.
     m_Table.reset(new PrefixTreeMap());
@@ -474,23 +472,52 @@ Create(std::istream& inFile, const std::string& outFileName)
   return true;
 }
 
-std::string
+void
 LexicalReorderingTableTree::
-MakeCacheKey(const Phrase& f, const Phrase& e) const
+MakeCacheKey(const Phrase& f, const Phrase& e, CacheKey& key) const
 {
-  std::string key;
-  if(!m_FactorsF.empty())
-    key += auxClearString(f.GetStringRep(m_FactorsF));
-
-  if(!m_FactorsE.empty()) {
-    if(!key.empty()) {
-      key += "|||";
+  // ids rather than strings, so no string is built per lookup
+  static const size_t NoFactor = NOT_FOUND - 1;
+  static const size_t Separator = NOT_FOUND;
+
+  key.clear();
+  key.reserve(f.GetSize() * m_FactorsF.size() + 1
+              + e.GetSize() * m_FactorsE.size());
+  for(size_t i = 0; i < f.GetSize(); ++i) {
+    const Word &word = f.GetWord(i);
+    for(size_t j = 0; j < m_FactorsF.size(); ++j) {
+      const Factor *factor = word[m_FactorsF[j]];
+      key.push_back(factor ? factor->GetId() : NoFactor);
+    }
+  }
+  key.push_back(Separator);
+  for(size_t i = 0; i < e.GetSize(); ++i) {
+    const Word &word = e.GetWord(i);
+    for(size_t j = 0; j < m_FactorsE.size(); ++j) {
+      const Factor *factor = word[m_FactorsE[j]];
+      key.push_back(factor ? factor->GetId() : NoFactor);
     }
-    key += auxClearString(e.GetStringRep(m_FactorsE));
   }
-  return key;
 };
 
+void
+LexicalReorderingTableTree::
+auxCache(const CacheKey& key, const CandidatesPtr& cands) const
+{
+  // rough memory used by the entry, for the cache's limit
+  size_t bytes = 64 + sizeof(CacheKey) + key.size() * sizeof(size_t)
+                 + sizeof(Candidates);
+  for(size_t i = 0; i < cands->size(); ++i) {
+    const GenericCandidate &cand = (*cands)[i];
+    bytes += sizeof(GenericCandidate);
+    for(size_t j = 0; j < cand.NumPhrases(); ++j)
+      bytes += sizeof(IPhrase) + cand.GetPhrase(j).size() * sizeof(LabelId);
+    for(size_t j = 0; j < cand.NumScores(); ++j)
+      bytes += sizeof(Scores) + cand.GetScore(j).size() * sizeof(float);
+  }
+  m_Cache->Insert(key, cands, bytes);
+}
+
 IPhrase
 LexicalReorderingTableTree::
 MakeTableKey(const Phrase& f, const Phrase& e) const
@@ -512,82 +539,5 @@ MakeTableKey(const Phrase& f, const Phrase& e) const
   return key;
 };
 
-
-struct State {
-  State(PPimp* t, const std::string& p)
-    : pos(t), path(p) { }
-
-  PPimp*      pos;
-  std::string path;
-};
-
-void
-LexicalReorderingTableTree::
-auxCacheForSrcPhrase(const Phrase& f)
-{
-  if(m_FactorsE.empty()) {
-    //f is all of key...
-    Candidates cands;
-    m_Table->GetCandidates(MakeTableKey(f,Phrase(ARRAY_SIZE_INCR)),&cands);
-    m_Cache[MakeCacheKey(f,Phrase(ARRAY_SIZE_INCR))] = cands;
-  } else {
-    ObjectPool<PPimp> pool;
-    PPimp* pPos  = m_Table->GetRoot();
-
-    // 1) goto subtree for f
-    for(size_t i = 0; i < f.GetSize() && 0 != pPos && pPos->isValid(); ++i)
-      pPos = m_Table->Extend(pPos, f.GetWord(i).GetString(m_FactorsF, false), SourceVocId);
-
-    if(pPos && pPos->isValid())
-      pPos = m_Table->Extend(pPos, PrefixTreeMap::MagicWord);
-
-    if(!pPos || !pPos->isValid())
-      return;
-
-    //2) explore whole subtree depth first & cache
-    std::string cache_key = auxClearString(f.GetStringRep(m_FactorsF)) + "|||";
-
-    std::vector<State> stack;
-    stack.push_back(State(pool.get(PPimp(pPos->ptr()->getPtr(pPos->idx),0,0)),""));
-    Candidates cands;
-    while(!stack.empty()) {
-      if(stack.back().pos->isValid()) {
-        LabelId w = stack.back().pos->ptr()->getKey(stack.back().pos->idx);
-        std::string next_path = stack.back().path + " " + m_Table->ConvertWord(w,TargetVocId);
-        //cache this
-        m_Table->GetCandidates(*stack.back().pos,&cands);
-        if(!cands.empty()) m_Cache[cache_key + auxClearString(next_path)] = cands;
-        cands.clear();
-        PPimp* next_pos = pool.get(PPimp(stack.back().pos->ptr()->getPtr(stack.back().pos->idx),0,0));
-        ++stack.back().pos->idx;
-        stack.push_back(State(next_pos,next_path));
-      } else stack.pop_back();
-    }
-  }
-}
-
-void
-LexicalReorderingTableTree::
-Cache(const ConfusionNet& /*input*/)
-{
-  return;
-}
-
-void
-LexicalReorderingTableTree::
-Cache(const Sentence& input)
-{
-  //only works with sentences...
-  size_t prev_cache_size = m_Cache.size();
-  size_t max_phrase_length = input.GetSize();
-  for(size_t len = 0; len <= max_phrase_length; ++len) {
-    for(size_t start = 0; start+len <= input.GetSize(); ++start) {
-      Phrase f    = input.GetSubString(Range(start, start+len));
-      auxCacheForSrcPhrase(f);
-    }
-  }
-  std::cerr << "Cached " << m_Cache.size() - prev_cache_size
-            << " new primary reordering table keys\n";
-}
 }
 
@@ -8,6 +8,9 @@
 #include <string>
 #include <iostream>
 
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
 #endif
@@ -18,6 +21,7 @@
 #include "moses/ConfusionNet.h"
 #include "moses/Sentence.h"
 #include "moses/PrefixTreeMap.h"
+#include "moses/ConcurrentCache.h"
 
 namespace Moses
 {
@@ -46,7 +50,8 @@ public:
   LoadAvailable(const std::string& filePath,
                 const FactorList& f_factors,
                 const FactorList& e_factors,
-                const FactorList& c_factors);
+                const FactorList& c_factors,
+                size_t cacheBytes = 0);
 
   virtual
   Scores
@@ -129,7 +134,10 @@ class LexicalReorderingTableTree
 {
   //implements LexicalReorderingTable using the crafty PDT code...
 
-  typedef std::map< std::string, Candidates > CacheType;
+  // factor ids of the source phrase, a separator, then those of the target
+  typedef std::vector<size_t> CacheKey;
+  typedef boost::shared_ptr<const Candidates> CandidatesPtr;
+  typedef ConcurrentCache<CacheKey, CandidatesPtr> CacheType;
 
 #ifdef WITH_THREADS
   typedef boost::thread_specific_ptr<PrefixTreeMap> TableType;
@@ -140,9 +148,9 @@ class LexicalReorderingTableTree
   static const int SourceVocId = 0;
   static const int TargetVocId = 1;
 
-  bool        m_UseCache;
   std::string m_FilePath;
-  CacheType   m_Cache;
+  // shared by all threads and kept across sentences. NULL = no caching
+  boost::scoped_ptr<CacheType> m_Cache;
   TableType   m_Table;
 
 public:
@@ -151,26 +159,24 @@ public:
   bool
   Create(std::istream& inFile, const std::string& outFileName);
 
+  //! cacheBytes limits the memory used to cache lookups, 0 = no cache
   LexicalReorderingTableTree(const std::string& filePath,
                              const std::vector<FactorType>& f_factors,
                              const std::vector<FactorType>& e_factors,
-                             const std::vector<FactorType>& c_factors);
+                             const std::vector<FactorType>& c_factors,
+                             size_t cacheBytes = 0);
 
   ~LexicalReorderingTableTree();
 
   bool IsCacheEnabled() const {
-    return m_UseCache;
-  };
-  void EnableCache()  {
-    m_UseCache = true;
-  };
-  void DisableCache() {
-    m_UseCache = false;
-  };
-  void ClearCache()   {
-    if (m_UseCache) m_Cache.clear();
+    return m_Cache.get() != NULL;
   };
 
+  //! NULL if not caching
+  const CacheType *GetCache() const {
+    return m_Cache.get();
+  }
+
   virtual
   std::vector<float>
   GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
@@ -179,29 +185,16 @@ public:
   void
   InitializeForInput(ttasksptr const& ttask);
 
-  virtual
-  void
-  InitializeForInputPhrase(const Phrase& f) {
-    ClearCache();
-    auxCacheForSrcPhrase(f);
-  }
-
 
 private:
-  std::string
-  MakeCacheKey(const Phrase& f, const Phrase& e) const;
+  void
+  MakeCacheKey(const Phrase& f, const Phrase& e, CacheKey& key) const;
 
   IPhrase
   MakeTableKey(const Phrase& f, const Phrase& e) const;
 
   void
-  Cache(const ConfusionNet& input);
-
-  void
-  Cache(const Sentence& input);
-
-  void
-  auxCacheForSrcPhrase(const Phrase& f);
+  auxCache(const CacheKey& key, const CandidatesPtr& cands) const;
 
   Scores
   auxFindScoreForContext(const Candidates& cands, const Phrase& contex);
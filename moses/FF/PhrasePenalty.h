@@ -14,6 +14,10 @@ public:
     return true;
   }
 
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   virtual void EvaluateInIsolation(const Phrase &source
                                    , const TargetPhrase &targetPhrase
                                    , ScoreComponentCollection &scoreBreakdown
@@ -42,6 +42,17 @@ public:
     const FFState* prev_state,
     ScoreComponentCollection* accumulator) const = 0;
 
+  /**
+   * Hint that EvaluateWhenApplied() will soon be called with these
+   * arguments, made for all hypotheses of a batch before scoring any of
+   * them. Feature functions that look things up in large tables can start
+   * fetching the memory here. Does nothing by default.
+   */
+  virtual void PrefetchWhenApplied(
+    const Hypothesis& /* cur_hypo */,
+    const FFState* /* prev_state */) const {
+  }
+
   // virtual FFState* EvaluateWhenAppliedWithContext(
   //   ttasksptr const& ttasks,
   //   const Hypothesis& cur_hypo,
@@ -29,6 +29,9 @@ public:
   bool IsUseable(const FactorMask &mask) const {
     return true;
   }
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
   std::vector<float> DefaultWeights() const;
 
   void EvaluateWhenApplied(const Hypothesis& hypo,
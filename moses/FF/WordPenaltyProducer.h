@@ -27,6 +27,10 @@ public:
     return true;
   }
 
+  bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   virtual void EvaluateInIsolation(const Phrase &source
                                    , const TargetPhrase &targetPhrase
                                    , ScoreComponentCollection &scoreBreakdown
@@ -0,0 +1,133 @@
+// Microbenchmark for factor interning under N threads.
+// Compares FactorCollection::Table against the reader-writer locked
+// unordered_set which FactorCollection used previously.
+//
+// Usage: FactorCollectionBenchmark [max-threads] [lookups-per-thread] [vocab-size]
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "FactorCollection.h"
+#include "util/murmur_hash.hh"
+#include "util/pool.hh"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace
+{
+
+// the old implementation: one shared_mutex around a boost::unordered_set
+class LockedSet
+{
+public:
+  const StringPiece *FindOrInsert(const StringPiece &str) {
+    {
+      boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+      Set::const_iterator i = m_set.find(str);
+      if (i != m_set.end()) return &*i;
+    }
+    boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+    std::pair<Set::iterator, bool> ret(m_set.insert(str));
+    if (ret.second) {
+      char *backing = static_cast<char*>(m_backing.Allocate(str.size()));
+      memcpy(backing, str.data(), str.size());
+      const_cast<StringPiece&>(*ret.first) = StringPiece(backing, str.size());
+    }
+    return &*ret.first;
+  }
+
+protected:
+  struct Hash {
+    size_t operator()(const StringPiece &str) const {
+      return util::MurmurHashNative(str.data(), str.size());
+    }
+  };
+  typedef boost::unordered_set<StringPiece, Hash> Set;
+  Set m_set;
+  util::Pool m_backing;
+  boost::shared_mutex m_accessLock;
+};
+
+struct TableAdapter {
+  FactorCollection::Table table;
+  boost::atomic<size_t> nextId;
+
+  TableAdapter() : nextId(0) {}
+
+  const void *FindOrInsert(const StringPiece &str) {
+    return table.FindOrInsert(str, nextId);
+  }
+};
+
+// zipf-ish word stream. Most lookups hit a small set of frequent words,
+// with a tail of words seen for the first time.
+void MakeWords(size_t vocabSize, size_t count, unsigned int seed, vector<string> &words)
+{
+  words.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    seed = seed * 1103515245 + 12345;
+    double r = (double) ((seed >> 8) & 0xffffff) / 0x1000000;
+    size_t rank = (size_t) (vocabSize * r * r * r);
+    words[i] = "w" + boost::lexical_cast<string>(rank);
+  }
+}
+
+template <class Coll> void Worker(Coll *coll, const vector<string> *words, boost::barrier *start)
+{
+  start->wait();
+  size_t twiddle = 0;
+  for (size_t i = 0; i < words->size(); ++i) {
+    twiddle ^= (size_t) coll->FindOrInsert((*words)[i]);
+  }
+  if (twiddle == 1) cerr << "unlikely" << endl;
+}
+
+template <class Coll> double Run(size_t numThreads, const vector<vector<string> > &words)
+{
+  Coll coll;
+  boost::barrier start(numThreads + 1);
+  boost::thread_group threads;
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.create_thread(boost::bind(&Worker<Coll>, &coll, &words[i], &start));
+  }
+  double begin = util::WallTime();
+  start.wait();
+  threads.join_all();
+  return util::WallTime() - begin;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  size_t maxThreads = argc > 1 ? atoi(argv[1]) : boost::thread::hardware_concurrency();
+  size_t perThread = argc > 2 ? atoi(argv[2]) : 1000000;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 100000;
+  if (maxThreads == 0) maxThreads = 1;
+
+  vector<vector<string> > words(maxThreads);
+  for (size_t i = 0; i < maxThreads; ++i) {
+    MakeWords(vocabSize, perThread, i + 1, words[i]);
+  }
+
+  cout << "threads\tlocked-set Mops/s\tsharded-table Mops/s" << endl;
+  for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+    double total = (double) numThreads * perThread / 1000000;
+    double locked = Run<LockedSet>(numThreads, words);
+    double sharded = Run<TableAdapter>(numThreads, words);
+    cout << numThreads << "\t" << total / locked << "\t" << total / sharded << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,219 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_FactorTable_h
+#define moses_FactorTable_h
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+#include <boost/atomic.hpp>
+
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "util/murmur_hash.hh"
+#include "util/pool.hh"
+#include "util/string_piece.hh"
+
+namespace Moses
+{
+
+/** Lock-free readable hash table of factors, shared by the FactorCollection
+ * of moses and moses2.
+ * The table is split in shards of open-addressing slots. Writers are
+ * serialized per shard. Entries and grown tables are published with
+ * release stores so readers never see a half-constructed factor.
+ * Tables replaced by a larger one are kept until destruction since readers
+ * may still be probing them.
+ *
+ * FactorFriendT holds the factor in its member 'in' and sets its string
+ * and id with Init(string, id).
+ */
+template <class FactorT, class FactorFriendT>
+class FactorTable
+{
+public:
+  FactorTable() {}
+
+  //! wait-free. NULL if the string hasn't been added
+  const FactorT *Find(const StringPiece &str) const {
+    uint64_t hash = Hash(str);
+    return GetShard(hash).Find(hash, str);
+  }
+
+  //! return existing factor or create a new one with the id taken from nextId
+  const FactorT *FindOrInsert(const StringPiece &str, boost::atomic<size_t> &nextId) {
+    uint64_t hash = Hash(str);
+    Shard &shard = GetShard(hash);
+    const FactorT *ret = shard.Find(hash, str);
+    if (ret) {
+      return ret;
+    }
+    return shard.FindOrInsert(hash, str, nextId);
+  }
+
+  //! append every factor in the table. Not for use while other threads insert
+  void GetAll(std::vector<const FactorT*> &out) const {
+    for (size_t i = 0; i < NUM_SHARDS; ++i) {
+      m_shards[i].GetAll(out);
+    }
+  }
+
+  static uint64_t Hash(const StringPiece &str) {
+    return util::MurmurHashNative(str.data(), str.size());
+  }
+
+protected:
+  struct Slot {
+    boost::atomic<const FactorT*> factor;
+    uint64_t hash;
+  };
+
+  struct Buckets {
+    Slot *slots;
+    size_t mask;
+
+    explicit Buckets(size_t size)
+      : slots(new Slot[size])
+      , mask(size - 1) {
+      for (size_t i = 0; i < size; ++i) {
+        slots[i].factor.store(NULL, boost::memory_order_relaxed);
+        slots[i].hash = 0;
+      }
+    }
+    ~Buckets() {
+      delete [] slots;
+    }
+  };
+
+  class Shard
+  {
+  public:
+    Shard()
+      : m_buckets(new Buckets(64))
+      , m_size(0) {
+    }
+
+    ~Shard() {
+      delete m_buckets.load();
+      for (size_t i = 0; i < m_retired.size(); ++i) {
+        delete m_retired[i];
+      }
+    }
+
+    const FactorT *Find(uint64_t hash, const StringPiece &str) const {
+      const Buckets &buckets = *m_buckets.load(boost::memory_order_acquire);
+      for (size_t i = hash & buckets.mask; ; i = (i + 1) & buckets.mask) {
+        const FactorT *factor = buckets.slots[i].factor.load(boost::memory_order_acquire);
+        if (factor == NULL) {
+          return NULL;
+        }
+        if (buckets.slots[i].hash == hash && factor->GetString() == str) {
+          return factor;
+        }
+      }
+    }
+
+    const FactorT *FindOrInsert(uint64_t hash, const StringPiece &str, boost::atomic<size_t> &nextId) {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(m_writeLock);
+#endif
+      // another thread may have added it since the unlocked lookup
+      const FactorT *ret = Find(hash, str);
+      if (ret) {
+        return ret;
+      }
+
+      FactorFriendT *to_ins = new (m_factorBacking.Allocate(sizeof(FactorFriendT))) FactorFriendT;
+      to_ins->Init(
+        StringPiece(static_cast<const char*>(memcpy(m_stringBacking.Allocate(str.size()), str.data(), str.size())), str.size()),
+        nextId.fetch_add(1));
+
+      // keep load factor <= 0.5 so probe sequences stay short
+      if ((m_size + 1) * 2 > m_buckets.load(boost::memory_order_relaxed)->mask + 1) {
+        Grow();
+      }
+      Insert(*m_buckets.load(boost::memory_order_relaxed), hash, &to_ins->in);
+      ++m_size;
+
+      return &to_ins->in;
+    }
+
+    void GetAll(std::vector<const FactorT*> &out) const {
+      const Buckets &buckets = *m_buckets.load(boost::memory_order_acquire);
+      for (size_t i = 0; i <= buckets.mask; ++i) {
+        const FactorT *factor = buckets.slots[i].factor.load(boost::memory_order_acquire);
+        if (factor) {
+          out.push_back(factor);
+        }
+      }
+    }
+
+  protected:
+    boost::atomic<Buckets*> m_buckets;
+    std::vector<Buckets*> m_retired;
+    size_t m_size;
+    util::Pool m_factorBacking;
+    util::Pool m_stringBacking;
+#ifdef WITH_THREADS
+    boost::mutex m_writeLock;
+#endif
+
+    static void Insert(Buckets &buckets, uint64_t hash, const FactorT *factor) {
+      size_t i = hash & buckets.mask;
+      while (buckets.slots[i].factor.load(boost::memory_order_relaxed)) {
+        i = (i + 1) & buckets.mask;
+      }
+      buckets.slots[i].hash = hash;
+      buckets.slots[i].factor.store(factor, boost::memory_order_release);
+    }
+
+    void Grow() {
+      Buckets *old = m_buckets.load(boost::memory_order_relaxed);
+      Buckets *buckets = new Buckets((old->mask + 1) * 2);
+      for (size_t i = 0; i <= old->mask; ++i) {
+        const FactorT *factor = old->slots[i].factor.load(boost::memory_order_relaxed);
+        if (factor) {
+          Insert(*buckets, old->slots[i].hash, factor);
+        }
+      }
+      m_buckets.store(buckets, boost::memory_order_release);
+      m_retired.push_back(old);
+    }
+  };
+
+  // top bits of the hash pick the shard, low bits the slot within it
+  static const size_t NUM_SHARD_BITS = 6;
+  static const size_t NUM_SHARDS = 1 << NUM_SHARD_BITS;
+
+  Shard m_shards[NUM_SHARDS];
+
+  const Shard &GetShard(uint64_t hash) const {
+    return m_shards[hash >> (64 - NUM_SHARD_BITS)];
+  }
+  Shard &GetShard(uint64_t hash) {
+    return m_shards[hash >> (64 - NUM_SHARD_BITS)];
+  }
+};
+
+}
+#endif
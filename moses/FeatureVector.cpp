@@ -166,7 +166,7 @@ FVector::FVector(size_t coreFeatures) : m_coreFeatures(coreFeatures) {}
 
 void FVector::resize(size_t newsize)
 {
-  valarray<FValue> oldValues(m_coreFeatures);
+  FCoreValues oldValues(m_coreFeatures);
   m_coreFeatures.resize(newsize);
   for (size_t i = 0; i < min(m_coreFeatures.size(), oldValues.size()); ++i) {
     m_coreFeatures[i] = oldValues[i];
@@ -176,7 +176,26 @@ void FVector::resize(size_t newsize)
 void FVector::clear()
 {
   m_coreFeatures.resize(m_coreFeatures.size(), 0);
-  m_features.clear();
+  m_features.reset();
+}
+
+FVector::FNVmap &FVector::features()
+{
+  if (!m_features) {
+    m_features.reset(new FNVmap());
+  } else if (m_features.use_count() != 1) {
+    // The count can only drop under us: another thread gets at the map by
+    // copying this vector, which it must not do while we write to it. At
+    // worst the map is copied once more than needed
+    m_features.reset(new FNVmap(*m_features));
+  }
+  return *m_features;
+}
+
+const FVector::FNVmap &FVector::emptyFeatures()
+{
+  static const FNVmap empty;
+  return empty;
 }
 
 bool FVector::load(const std::string& filename)
@@ -305,8 +324,8 @@ ostream& operator<<(ostream& out, const FVector& fv)
 const FValue& FVector::get(const FName& name) const
 {
   static const FValue DEFAULT = 0;
-  const_iterator fi = m_features.find(name);
-  if (fi == m_features.end()) {
+  const_iterator fi = sparse().find(name);
+  if (fi == sparse().end()) {
     return DEFAULT;
   } else {
     return fi->second;
@@ -315,8 +334,8 @@ const FValue& FVector::get(const FName& name) const
 
 FValue FVector::getBackoff(const FName& name, float backoff) const
 {
-  const_iterator fi = m_features.find(name);
-  if (fi == m_features.end()) {
+  const_iterator fi = sparse().find(name);
+  if (fi == sparse().end()) {
     return backoff;
   } else {
     return fi->second;
@@ -351,7 +370,7 @@ void FVector::capMin(FValue minValue)
 
 void FVector::set(const FName& name, const FValue& value)
 {
-  m_features[name] = value;
+  features()[name] = value;
 }
 
 void FVector::printCoreFeatures()
@@ -451,7 +470,7 @@ size_t FVector::pruneSparseFeatures(size_t threshold)
   }
 
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    features().erase(toErase[i]);
 
   return count;
 }
@@ -471,7 +490,7 @@ size_t FVector::pruneZeroWeightFeatures()
   }
 
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    features().erase(toErase[i]);
 
   return count;
 }
@@ -726,7 +745,7 @@ size_t FVector::l1regularize(float lambda)
 
   // erase features that have become zero
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    features().erase(toErase[i]);
   numberPruned -= size();
   return numberPruned;
 }
@@ -776,7 +795,7 @@ size_t FVector::sparseL1regularize(float lambda)
 
   // erase features that have become zero
   for (size_t i = 0; i < toErase.size(); ++i)
-    m_features.erase(toErase[i]);
+    features().erase(toErase[i]);
   numberPruned -= size();
   return numberPruned;
 }
@@ -830,10 +849,10 @@ void FVector::merge(const FVector &other)
 
   // sparse
   FNVmap::const_iterator iter;
-  for (iter = other.m_features.begin(); iter != other.m_features.end(); ++iter) {
+  for (iter = other.cbegin(); iter != other.cend(); ++iter) {
     const FName  &otherKey = iter->first;
     const FValue otherVal = iter->second;
-    m_features[otherKey] = otherVal;
+    features()[otherKey] = otherVal;
   }
 }
 
@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef FEATUREVECTOR_H
 #define FEATUREVECTOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -30,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <vector>
 
 #include <boost/functional/hash.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/unordered_map.hpp>
 
 #ifdef MPI_ENABLE
@@ -37,7 +39,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/serialization/split_member.hpp>
 #include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
-#include <boost/serialization/valarray.hpp>
 #endif
 
 #ifdef WITH_THREADS
@@ -121,6 +122,116 @@ struct FNameHash
 
 class ProxyFVector;
 
+// Number of core features stored inside each FVector rather than on the heap.
+// Set with --inline-dense-scores. 0 puts them all on the heap
+#ifndef FVECTOR_INLINE_CORE
+#define FVECTOR_INLINE_CORE 32
+#endif
+
+/**
+ * The core (dense) features of an FVector.
+ * Up to FVECTOR_INLINE_CORE values live in the object itself, so copying the
+ * scores of a model with no more dense features than that does not allocate.
+ * The interface is the part of std::valarray that FVector used to need.
+ **/
+class FCoreValues
+{
+public:
+  explicit FCoreValues(size_t size = 0)
+    : m_size(0), m_values(m_inline) {
+    Allocate(size);
+    std::fill(m_values, m_values + m_size, FValue(0));
+  }
+  FCoreValues(const FCoreValues &other)
+    : m_size(0), m_values(m_inline) {
+    Allocate(other.m_size);
+    std::copy(other.m_values, other.m_values + m_size, m_values);
+  }
+  ~FCoreValues() {
+    if (m_values != m_inline) {
+      delete [] m_values;
+    }
+  }
+
+  FCoreValues &operator=(const FCoreValues &other) {
+    if (this != &other) {
+      if (m_size != other.m_size) {
+        Allocate(other.m_size);
+      }
+      std::copy(other.m_values, other.m_values + m_size, m_values);
+    }
+    return *this;
+  }
+
+  size_t size() const {
+    return m_size;
+  }
+
+  FValue &operator[](size_t index) {
+    return m_values[index];
+  }
+  FValue operator[](size_t index) const {
+    return m_values[index];
+  }
+
+  //! like std::valarray, the old values are lost. Every value becomes value
+  void resize(size_t size, FValue value = 0) {
+    if (size != m_size) {
+      Allocate(size);
+    }
+    std::fill(m_values, m_values + m_size, value);
+  }
+
+  FValue sum() const {
+    FValue ret = 0;
+    for (size_t i = 0; i < m_size; ++i) {
+      ret += m_values[i];
+    }
+    return ret;
+  }
+
+  FCoreValues &operator*=(FValue rhs) {
+    for (size_t i = 0; i < m_size; ++i) {
+      m_values[i] *= rhs;
+    }
+    return *this;
+  }
+  FCoreValues &operator/=(FValue rhs) {
+    for (size_t i = 0; i < m_size; ++i) {
+      m_values[i] /= rhs;
+    }
+    return *this;
+  }
+
+  void swap(FCoreValues &other) {
+    if (m_values != m_inline && other.m_values != other.m_inline) {
+      std::swap(m_values, other.m_values);
+      std::swap(m_size, other.m_size);
+    } else {
+      FCoreValues tmp(*this);
+      *this = other;
+      other = tmp;
+    }
+  }
+
+private:
+  size_t m_size;
+  FValue *m_values; // m_inline or heap
+  FValue m_inline[FVECTOR_INLINE_CORE ? FVECTOR_INLINE_CORE : 1];
+
+  // contents are undefined afterwards
+  void Allocate(size_t size) {
+    if (m_values != m_inline) {
+      delete [] m_values;
+      m_values = m_inline;
+    }
+    if (size > FVECTOR_INLINE_CORE) {
+      m_values = new FValue[size];
+    }
+    m_size = size;
+  }
+};
+
 /**
  * A sparse feature (or weight) vector.
  **/
@@ -145,21 +256,22 @@ public:
   /** Iterators */
   typedef FNVmap::iterator iterator;
   typedef FNVmap::const_iterator const_iterator;
+  //! non-const iterators take a private copy of shared sparse features
   iterator begin() {
-    return m_features.begin();
+    return features().begin();
   }
   iterator end() {
-    return m_features.end();
+    return features().end();
   }
   const_iterator cbegin() const {
-    return m_features.cbegin();
+    return sparse().cbegin();
   }
   const_iterator cend() const {
-    return m_features.cend();
+    return sparse().cend();
   }
 
   bool hasNonDefaultValue(FName name) const {
-    return m_features.find(name) != m_features.end();
+    return sparse().find(name) != sparse().end();
   }
   void clear();
 
@@ -177,14 +289,14 @@ public:
 
   /** Size */
   size_t size() const {
-    return m_features.size() + m_coreFeatures.size();
+    return sparse().size() + m_coreFeatures.size();
   }
 
   size_t coreSize() const {
     return m_coreFeatures.size();
   }
 
-  const std::valarray<FValue> &getCoreFeatures() const {
+  const FCoreValues &getCoreFeatures() const {
     return m_coreFeatures;
   }
 
@@ -272,8 +384,19 @@ private:
   FValue getBackoff(const FName& name, float backoff) const;
   void set(const FName& name, const FValue& value);
 
-  FNVmap m_features;
-  std::valarray<FValue> m_coreFeatures;
+  // Sparse features, shared between copies of a vector until one of them
+  // writes. NULL while there are none, which is the usual case when decoding
+  boost::shared_ptr<FNVmap> m_features;
+  FCoreValues m_coreFeatures;
+
+  //! sparse features for reading
+  const FNVmap &sparse() const {
+    return m_features ? *m_features : emptyFeatures();
+  }
+  //! sparse features for writing. Copies them if they are shared
+  FNVmap &features();
+  //! what sparse() returns without features of our own
+  static const FNVmap &emptyFeatures();
 
 #ifdef MPI_ENABLE
   //serialization
@@ -287,9 +410,13 @@ private:
       names.push_back(ostr.str());
       values.push_back(i->second);
     }
+    std::vector<FValue> coreFeatures(m_coreFeatures.size());
+    for (size_t i = 0; i < coreFeatures.size(); ++i) {
+      coreFeatures[i] = m_coreFeatures[i];
+    }
     ar << names;
     ar << values;
-    ar << m_coreFeatures;
+    ar << coreFeatures;
   }
 
   template<class Archive>
@@ -297,9 +424,14 @@ private:
     clear();
     std::vector<std::string> names;
     std::vector<FValue> values;
+    std::vector<FValue> coreFeatures;
     ar >> names;
     ar >> values;
-    ar >> m_coreFeatures;
+    ar >> coreFeatures;
+    m_coreFeatures.resize(coreFeatures.size());
+    for (size_t i = 0; i < coreFeatures.size(); ++i) {
+      m_coreFeatures[i] = coreFeatures[i];
+    }
     UTIL_THROW_IF2(names.size() != values.size(), "Error");
     for (size_t i = 0; i < names.size(); ++i) {
       set(FName(names[i]), values[i]);
@@ -314,8 +446,8 @@ private:
 
 inline void swap(FVector &first, FVector &second)
 {
-  swap(first.m_features, second.m_features);
-  swap(first.m_coreFeatures, second.m_coreFeatures);
+  first.m_features.swap(second.m_features);
+  first.m_coreFeatures.swap(second.m_coreFeatures);
 }
 
 std::ostream& operator<<( std::ostream& out, const FVector& fv);
@@ -367,15 +499,15 @@ public:
    }*/
 
   FValue operator++() {
-    return ++m_fv->m_features[m_name];
+    return ++m_fv->features()[m_name];
   }
 
   FValue operator +=(FValue lhs) {
-    return (m_fv->m_features[m_name] += lhs);
+    return (m_fv->features()[m_name] += lhs);
   }
 
   FValue operator -=(FValue lhs) {
-    return (m_fv->m_features[m_name] -= lhs);
+    return (m_fv->features()[m_name] -= lhs);
   }
 
 private:
@@ -307,5 +307,28 @@ BOOST_AUTO_TEST_CASE(ip)
 }
 
 
+BOOST_AUTO_TEST_CASE(copy_on_write)
+{
+  FName n1("a");
+  FVector f1;
+  f1[n1] = 1.5;
+  FVector f2(f1);
+  f2[n1] = 2;
+  BOOST_CHECK_CLOSE((FValue)f1[n1], 1.5, TOL);
+  BOOST_CHECK_CLOSE((FValue)f2[n1], 2, TOL);
+
+  // writing through the iterators of a vector without sparse features
+  // must not reach other vectors
+  FVector empty1, empty2;
+  BOOST_CHECK(empty1.begin() == empty1.end());
+  BOOST_CHECK(empty2.cbegin() == empty2.cend());
+  FVector f3(f1);
+  for (FVector::iterator i = f3.begin(); i != f3.end(); ++i) {
+    i->second = 3;
+  }
+  BOOST_CHECK_CLOSE((FValue)f1[n1], 1.5, TOL);
+  BOOST_CHECK_CLOSE((FValue)f3[n1], 3, TOL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
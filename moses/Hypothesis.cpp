@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <limits>
 #include <vector>
 #include <algorithm>
+#include <new>
 
 #include "TranslationOption.h"
 #include "TranslationOptionCollection.h"
@@ -45,6 +46,21 @@ namespace Moses
 {
 //size_t g_numHypos = 0;
 
+namespace
+{
+// ArcList is a plain vector, so it can't have its own operator new
+ArcList *NewArcList()
+{
+  return new (SentenceArena::Allocate(sizeof(ArcList))) ArcList();
+}
+
+void DeleteArcList(ArcList *arcList)
+{
+  arcList->~ArcList();
+  SentenceArena::Free(arcList);
+}
+}
+
 Hypothesis::
 Hypothesis(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt, const Bitmap &bitmap, int id)
   : m_prevHypo(NULL)
@@ -113,7 +129,7 @@ Hypothesis::
     }
     m_arcList->clear();
 
-    delete m_arcList;
+    DeleteArcList(m_arcList);
     m_arcList = NULL;
   }
 }
@@ -127,7 +143,7 @@ AddArc(Hypothesis *loserHypo)
       this->m_arcList = loserHypo->m_arcList;  // take ownership, we'll delete
       loserHypo->m_arcList = 0;                // prevent a double deletion
     } else {
-      this->m_arcList = new ArcList();
+      this->m_arcList = NewArcList();
     }
   } else {
     if (loserHypo->m_arcList) {  // both have an arc list: merge. delete loser
@@ -135,7 +151,7 @@ AddArc(Hypothesis *loserHypo)
       size_t add_size = loserHypo->m_arcList->size();
       this->m_arcList->resize(my_size + add_size, 0);
       std::memcpy(&(*m_arcList)[0] + my_size, &(*loserHypo->m_arcList)[0], add_size * sizeof(Hypothesis *));
-      delete loserHypo->m_arcList;
+      DeleteArcList(loserHypo->m_arcList);
       loserHypo->m_arcList = 0;
     } else { // loserHypo doesn't have any arcs
       // DO NOTHING
@@ -165,7 +181,8 @@ EvaluateWhenApplied(float estimatedScore)
   for (unsigned i = 0; i < sfs.size(); ++i) {
     const StatelessFeatureFunction &ff = *sfs[i];
     if(!staticData.IsFeatureFunctionIgnored(ff)) {
-      ff.EvaluateWhenApplied(*this, &m_currScoreBreakdown);
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateWhenApplied));
+      EvaluateWhenApplied(ff);
     }
   }
 
@@ -174,11 +191,79 @@ EvaluateWhenApplied(float estimatedScore)
   for (unsigned i = 0; i < ffs.size(); ++i) {
     const StatefulFeatureFunction &ff = *ffs[i];
     if(!staticData.IsFeatureFunctionIgnored(ff)) {
-      FFState const* s = m_prevHypo ? m_prevHypo->m_ffStates[i] : NULL;
-      m_ffStates[i] = ff.EvaluateWhenApplied(*this, s, &m_currScoreBreakdown);
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateWhenApplied));
+      EvaluateWhenApplied(ff, i);
+    }
+  }
+
+  SetFutureScore(estimatedScore);
+}
+
+/***
+ * EvaluateWhenApplied() of several hypotheses, feature function by feature
+ * function, so that stateful feature functions can prefetch what all of
+ * them will look up before scoring the first one
+ */
+void
+Hypothesis::
+EvaluateWhenApplied(const std::vector<Hypothesis*> &hypos,
+                    const std::vector<float> &estimatedScores)
+{
+  const StaticData &staticData = StaticData::Instance();
+
+  const vector<const StatelessFeatureFunction*>& sfs =
+    StatelessFeatureFunction::GetStatelessFeatureFunctions();
+  for (unsigned i = 0; i < sfs.size(); ++i) {
+    const StatelessFeatureFunction &ff = *sfs[i];
+    if(!staticData.IsFeatureFunctionIgnored(ff)) {
+      // one call per hypothesis, as when they are scored one at a time
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateWhenApplied), hypos.size());
+      for (size_t h = 0; h < hypos.size(); ++h) {
+        hypos[h]->EvaluateWhenApplied(ff);
+      }
     }
   }
 
+  const vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    const StatefulFeatureFunction &ff = *ffs[i];
+    if(!staticData.IsFeatureFunctionIgnored(ff)) {
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateWhenApplied), hypos.size());
+      for (size_t h = 0; h < hypos.size(); ++h) {
+        const Hypothesis *prevHypo = hypos[h]->m_prevHypo;
+        ff.PrefetchWhenApplied(*hypos[h], prevHypo ? prevHypo->m_ffStates[i] : NULL);
+      }
+      for (size_t h = 0; h < hypos.size(); ++h) {
+        hypos[h]->EvaluateWhenApplied(ff, i);
+      }
+    }
+  }
+
+  for (size_t h = 0; h < hypos.size(); ++h) {
+    hypos[h]->SetFutureScore(estimatedScores[h]);
+  }
+}
+
+void
+Hypothesis::
+EvaluateWhenApplied(const StatelessFeatureFunction &ff)
+{
+  ff.EvaluateWhenApplied(*this, &m_currScoreBreakdown);
+}
+
+void
+Hypothesis::
+EvaluateWhenApplied(const StatefulFeatureFunction &ff, size_t stateIdx)
+{
+  FFState const* s = m_prevHypo ? m_prevHypo->m_ffStates[stateIdx] : NULL;
+  m_ffStates[stateIdx] = ff.EvaluateWhenApplied(*this, s, &m_currScoreBreakdown);
+}
+
+void
+Hypothesis::
+SetFutureScore(float estimatedScore)
+{
   // FUTURE COST
   m_estimatedScore = estimatedScore;
 
@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ScoreComponentCollection.h"
 #include "InputType.h"
 #include "ObjectPool.h"
+#include "SentenceArena.h"
 #include "xmlrpc-c.h"
 
 namespace Moses
@@ -85,6 +86,12 @@ protected:
 
   int m_id; /*! numeric ID of this hypothesis, used for logging */
 
+  //! score with one feature function, the body of EvaluateWhenApplied()
+  void EvaluateWhenApplied(const StatelessFeatureFunction &ff);
+  void EvaluateWhenApplied(const StatefulFeatureFunction &ff, size_t stateIdx);
+  //! total from the scores added so far and the estimate of the rest
+  void SetFutureScore(float estimatedScore);
+
 public:
   /*! used by initial seeding of the translation process */
   Hypothesis(Manager& manager, InputType const& source, const TranslationOption &initialTransOpt, const Bitmap &bitmap, int id);
@@ -92,6 +99,14 @@ public:
   Hypothesis(const Hypothesis &prevHypo, const TranslationOption &transOpt, const Bitmap &bitmap, int id);
   ~Hypothesis();
 
+  //! from the Manager's SentenceArena while it decodes
+  static void *operator new(size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+
   void PrintHypothesis() const;
 
   const InputType& GetInput() const {
@@ -121,6 +136,9 @@ public:
   }
 
   void EvaluateWhenApplied(float estimatedScore);
+  //! the same for several hypotheses at once, letting stateful feature functions prefetch
+  static void EvaluateWhenApplied(const std::vector<Hypothesis*> &hypos,
+                                  const std::vector<float> &estimatedScores);
 
   int GetId()const {
     return m_id;
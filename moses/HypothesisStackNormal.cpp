@@ -36,6 +36,7 @@ HypothesisStackNormal::HypothesisStackNormal(Manager& manager) :
   HypothesisStack(manager)
 {
   m_nBestIsEnabled = manager.options()->nbest.enabled;
+  m_incrementalPruning = manager.options()->search.incremental_pruning;
   m_bestScore = -std::numeric_limits<float>::infinity();
   m_worstScore = -std::numeric_limits<float>::infinity();
 }
@@ -46,6 +47,71 @@ void HypothesisStackNormal::RemoveAll()
   while (m_hypos.begin() != m_hypos.end()) {
     Remove(m_hypos.begin());
   }
+  m_heap.clear();
+}
+
+void HypothesisStackNormal::Detach(const HypothesisStack::iterator &iter)
+{
+  if (UseIncrementalPruning()) {
+    // its heap entry is skipped when it gets to the top
+    m_heapIds.erase((*iter)->GetId());
+  }
+  HypothesisStack::Detach(iter);
+}
+
+void HypothesisStackNormal::PushHeap(Hypothesis *hypo)
+{
+  // entries of hypotheses removed by recombination stay until they reach
+  // the top. Don't let them pile up
+  if (m_heap.size() > 2 * m_hypos.size() + 64) {
+    RebuildHeap();
+    return;
+  }
+
+  HeapEntry entry = { hypo->GetFutureScore(), hypo->GetId(), hypo };
+  m_heap.push_back(entry);
+  push_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+  m_heapIds.insert(entry.id);
+}
+
+void HypothesisStackNormal::RebuildHeap()
+{
+  m_heap.clear();
+  m_heapIds.clear();
+  for (iterator iter = m_hypos.begin(); iter != m_hypos.end(); ++iter) {
+    HeapEntry entry = { (*iter)->GetFutureScore(), (*iter)->GetId(), *iter };
+    m_heap.push_back(entry);
+    m_heapIds.insert(entry.id);
+  }
+  make_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+}
+
+void HypothesisStackNormal::PruneIncremental()
+{
+  while (!m_heap.empty()) {
+    const HeapEntry &worst = m_heap.front();
+    bool inStack = m_heapIds.count(worst.id);
+    if (inStack
+        && m_hypos.size() <= m_maxHypoStackSize
+        && worst.score > m_bestScore + m_beamWidth) {
+      break;
+    }
+
+    // removed by recombination, too many, or fell out of the beam
+    Hypothesis *hypo = worst.hypo;
+    pop_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+    m_heap.pop_back();
+    if (inStack) {
+      iterator iter = m_hypos.find(hypo);
+      assert(iter != m_hypos.end() && *iter == hypo);
+      Remove(iter);
+      m_manager.GetSentenceStats().AddPruning();
+    }
+  }
+
+  if (m_hypos.size() == m_maxHypoStackSize) {
+    m_worstScore = max(m_bestScore + m_beamWidth, m_heap.front().score);
+  }
 }
 
 pair<HypothesisStackNormal::iterator, bool> HypothesisStackNormal::Add(Hypothesis *hypo)
@@ -71,6 +137,13 @@ pair<HypothesisStackNormal::iterator, bool> HypothesisStackNormal::Add(Hypothesi
 
     VERBOSE(3,", now size " << m_hypos.size());
 
+    if (UseIncrementalPruning()) {
+      PushHeap(hypo);
+      PruneIncremental();
+      VERBOSE(3,std::endl);
+      return ret;
+    }
+
     // prune only if stack is twice as big as needed (lazy pruning)
     size_t toleratedSize = 2*m_maxHypoStackSize-1;
     // add in room for stack diversity
@@ -214,6 +287,10 @@ void HypothesisStackNormal::PruneToSize(size_t newSize)
   }
   free(included);
 
+  if (UseIncrementalPruning()) {
+    RebuildHeap();
+  }
+
   // some reporting....
   VERBOSE(3,", pruned to size " << size() << endl);
   IFVERBOSE(3) {
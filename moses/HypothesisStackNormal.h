@@ -24,6 +24,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <limits>
 #include <set>
+#include <vector>
+#include <boost/unordered_set.hpp>
 #include "Hypothesis.h"
 #include "HypothesisStack.h"
 #include "Bitmap.h"
@@ -47,6 +49,31 @@ protected:
   size_t m_maxHypoStackSize; /**< maximum number of hypothesis allowed in this stack */
   size_t m_minHypoStackDiversity; /**< minimum number of hypothesis with different source word coverage */
   bool m_nBestIsEnabled; /**< flag to determine whether to keep track of old arcs */
+  bool m_incrementalPruning; /**< keep the stack within its size on every insert */
+
+  //! score of a hypothesis in the stack, for the heap used by incremental pruning
+  struct HeapEntry {
+    float score;
+    int id;
+    Hypothesis *hypo;
+  };
+  //! puts the worst hypothesis on top of the heap
+  struct HeapOrder {
+    bool operator()(const HeapEntry &a, const HeapEntry &b) const {
+      return a.score > b.score;
+    }
+  };
+  std::vector<HeapEntry> m_heap; /**< heap of the scores in the stack. May hold hypotheses removed by recombination */
+  boost::unordered_set<int> m_heapIds; /**< ids of the hypotheses in m_heap which are still in the stack */
+
+  bool UseIncrementalPruning() const {
+    return m_incrementalPruning && m_maxHypoStackSize && m_minHypoStackDiversity == 0;
+  }
+  void PushHeap(Hypothesis *hypo);
+  void RebuildHeap();
+  /** remove the worst hypotheses until the stack is within its size and
+   * all hypotheses are within the beam. O(log n) each */
+  void PruneIncremental();
 
   /** add hypothesis to stack. Prune if necessary.
    * Returns false if equiv hypo exists in collection, otherwise returns true
@@ -56,6 +83,8 @@ protected:
   /** destroy all instances of Hypothesis in this collection */
   void RemoveAll();
 
+  void Detach(const HypothesisStack::iterator &iter);
+
   void SetWorstScoreForBitmap( WordsBitmapID id, float worstScore ) {
     m_diversityWorstScore[ id ] = worstScore;
   }
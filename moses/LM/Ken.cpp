@@ -104,7 +104,19 @@ template <class Model> void LanguageModelKen<Model>::LoadModel(const std::string
   config.enumerate_vocab = &builder;
   config.load_method = load_method;
 
-  m_ngram.reset(new Model(file.c_str(), config));
+  m_replicas.clear();
+  if (load_method == util::NUMA_REPLICATE && util::NumaNodes() > 1) {
+    // one copy per node, each allocated on its node. The vocab mapping is
+    // the same for all of them so only build it once
+    for (size_t node = 0; node < util::NumaNodes(); ++node) {
+      util::ScopedNumaPreferred preferred(node);
+      config.enumerate_vocab = node ? NULL : &builder;
+      m_replicas.push_back(boost::shared_ptr<Model>(new Model(file.c_str(), config)));
+    }
+    m_ngram = m_replicas[0];
+  } else {
+    m_ngram.reset(new Model(file.c_str(), config));
+  }
   VERBOSE(2, "LanguageModelKen " << m_description << " reset to " << file << "\n");
 }
 
@@ -129,6 +141,7 @@ template <class Model> LanguageModelKen<Model>::LanguageModelKen()
 template <class Model> LanguageModelKen<Model>::LanguageModelKen(const LanguageModelKen<Model> &copy_from)
   :LanguageModel(copy_from.GetArgLine()),
    m_ngram(copy_from.m_ngram),
+   m_replicas(copy_from.m_replicas),
 // TODO: don't copy this.
    m_beginSentenceFactor(copy_from.m_beginSentenceFactor),
    m_factorType(copy_from.m_factorType),
@@ -152,7 +165,7 @@ template <class Model> void LanguageModelKen<Model>::CalcScore(const Phrase &phr
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_beginSentenceFactor == phrase.GetWord(0).GetFactor(m_factorType)) {
@@ -194,6 +207,15 @@ template <class Model> void LanguageModelKen<Model>::CalcScore(const Phrase &phr
   fullScore = TransformLMScore(fullScore);
 }
 
+template <class Model> void LanguageModelKen<Model>::PrefetchWhenApplied(const Hypothesis &hypo, const FFState *ps) const
+{
+  // the first query of EvaluateWhenApplied, the one that misses the cache
+  // the most as it depends on the previous hypothesis
+  if (!ps || !hypo.GetCurrTargetLength()) return;
+  const lm::ngram::State &in_state = static_cast<const KenLMState&>(*ps).state;
+  GetModel().Prefetch(in_state, TranslateID(hypo.GetWord(hypo.GetCurrTargetWordsRange().GetStartPos())));
+}
+
 template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const
 {
   const lm::ngram::State &in_state = static_cast<const KenLMState&>(*ps).state;
@@ -209,15 +231,16 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
   //[begin, end) in STL-like fashion.
   const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
   const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+  const Model &model = GetModel();
 
   std::size_t position = begin;
   typename Model::State aux_state;
   typename Model::State *state0 = &ret->state, *state1 = &aux_state;
 
-  float score = m_ngram->Score(in_state, TranslateID(hypo.GetWord(position)), *state0);
+  float score = model.Score(in_state, TranslateID(hypo.GetWord(position)), *state0);
   ++position;
   for (; position < adjust_end; ++position) {
-    score += m_ngram->Score(*state0, TranslateID(hypo.GetWord(position)), *state1);
+    score += model.Score(*state0, TranslateID(hypo.GetWord(position)), *state1);
     std::swap(state0, state1);
   }
 
@@ -225,12 +248,12 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
     // Score end of sentence.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last, m_ngram->GetVocabulary().EndSentence(), ret->state).prob;
+    score += model.FullScoreForgotState(&indices.front(), last, m_ngram->GetVocabulary().EndSentence(), ret->state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, ret->state);
+    model.GetState(&indices.front(), last, ret->state);
   } else if (state0 != &ret->state) {
     // Short enough phrase that we can just reuse the state.
     ret->state = *state0;
@@ -279,7 +302,7 @@ private:
 template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const ChartHypothesis& hypo, int featureID, ScoreComponentCollection *accumulator) const
 {
   LanguageModelChartStateKenLM *newState = new LanguageModelChartStateKenLM();
-  lm::ngram::RuleScore<Model> ruleScore(*m_ngram, newState->GetChartState());
+  lm::ngram::RuleScore<Model> ruleScore(GetModel(), newState->GetChartState());
   const TargetPhrase &target = hypo.GetCurrTargetPhrase();
   const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
     target.GetAlignNonTerm().GetNonTermIndexMap();
@@ -331,7 +354,7 @@ template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(con
 template <class Model> FFState *LanguageModelKen<Model>::EvaluateWhenApplied(const Syntax::SHyperedge& hyperedge, int featureID, ScoreComponentCollection *accumulator) const
 {
   LanguageModelChartStateKenLM *newState = new LanguageModelChartStateKenLM();
-  lm::ngram::RuleScore<Model> ruleScore(*m_ngram, newState->GetChartState());
+  lm::ngram::RuleScore<Model> ruleScore(GetModel(), newState->GetChartState());
   const TargetPhrase &target = *hyperedge.label.translation;
   const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
     target.GetAlignNonTerm().GetNonTermIndexMap2();
@@ -471,6 +494,10 @@ LanguageModel *ConstructKenLM(const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "numa_interleave") {
+        load_method = util::NUMA_INTERLEAVE;
+      } else if (value == "numa_replicate") {
+        load_method = util::NUMA_REPLICATE;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
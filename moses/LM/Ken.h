@@ -23,10 +23,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define moses_LanguageModelKen_h
 
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 #include "lm/word_index.hh"
 #include "util/mmap.hh"
+#include "util/numa.hh"
 
 #include "moses/LM/Base.h"
 #include "moses/Hypothesis.h"
@@ -59,6 +61,8 @@ public:
 
   virtual void CalcScore(const Phrase &phrase, float &fullScore, float &ngramScore, size_t &oovCount) const;
 
+  virtual void PrefetchWhenApplied(const Hypothesis &hypo, const FFState *ps) const;
+
   virtual FFState *EvaluateWhenApplied(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const;
 
   virtual FFState *EvaluateWhenApplied(const ChartHypothesis& cur_hypo, int featureID, ScoreComponentCollection *accumulator) const;
@@ -70,10 +74,25 @@ public:
 
   virtual bool IsUseable(const FactorMask &mask) const;
 
+  //! only queries the model, which is read-only once loaded
+  virtual bool IsThreadSafeInIsolation() const {
+    return true;
+  }
+
   friend class InMemoryPerSentenceOnDemandLM;
 
 protected:
   boost::shared_ptr<Model> m_ngram;
+  // load=numa_replicate: a copy per NUMA node. m_ngram is the node 0 copy
+  std::vector<boost::shared_ptr<Model> > m_replicas;
+
+  //! model to query from the calling thread. Its node-local copy if replicated
+  const Model &GetModel() const {
+    if (m_replicas.empty()) {
+      return *m_ngram;
+    }
+    return *m_replicas[util::NumaNodeOfCurrentThread() % m_replicas.size()];
+  }
 
   const Factor *m_beginSentenceFactor;
 
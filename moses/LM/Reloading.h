@@ -77,6 +77,11 @@ public:
     LanguageModelKen<Model>::LoadModel(m_file, m_lazy ? util::LAZY : util::POPULATE_OR_READ);
   };
 
+  //! the model is loaded again for each input
+  virtual bool IsThreadSafeInIsolation() const {
+    return false;
+  }
+
 
 protected:
 
@@ -0,0 +1,197 @@
+// Microbenchmark for the lexical reordering table cache.
+// Builds a synthetic binary reordering table in a temporary directory and
+// looks up a zipf-ish stream of phrase pairs from N threads, comparing:
+//   - no cache, every lookup goes to the prefix tree
+//   - the old per-sentence cache, a std::map keyed by the phrase strings
+//     and cleared after every sentence, one per thread
+//   - the shared cache keyed by factor ids, kept across sentences
+//
+// Usage: LexicalReorderingCacheBenchmark [max-threads] [lookups-per-thread] [vocab-size]
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include "Benchmark.h"
+#include "FF/LexicalReordering/LexicalReorderingTable.h"
+#include "Phrase.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+using Moses::Benchmark::Next;
+using Moses::Benchmark::MakeWord;
+
+namespace
+{
+
+const size_t SentenceLength = 500; // lookups between clearing the old cache
+
+// 4 translations for each source word and for some pairs of words,
+// returns the phrase pairs in the table
+vector<pair<string, string> > WriteTable(const string &path, size_t vocabSize)
+{
+  vector<pair<string, string> > pairs;
+  unsigned int seed = 1;
+  for (size_t i = 0; i < vocabSize; ++i) {
+    for (size_t t = 0; t < 4; ++t) {
+      pairs.push_back(make_pair(MakeWord("s", i), MakeWord("t", Next(seed) % vocabSize)));
+    }
+    if (i % 3 == 0 && i + 1 < vocabSize) {
+      pairs.push_back(make_pair(MakeWord("s", i) + " " + MakeWord("s", i + 1),
+                                MakeWord("t", Next(seed) % vocabSize) + " " + MakeWord("t", Next(seed) % vocabSize)));
+    }
+  }
+
+  sort(pairs.begin(), pairs.end());
+  pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+
+  // sorted like processLexicalTable's input
+  vector<string> lines;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    string line = pairs[i].first + " ||| " + pairs[i].second + " |||";
+    for (size_t s = 0; s < 6; ++s) {
+      line += " " + boost::lexical_cast<string>((Next(seed) % 1000 + 1) / 1000.0);
+    }
+    lines.push_back(line);
+  }
+  sort(lines.begin(), lines.end());
+
+  stringstream text;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    text << lines[i] << "\n";
+  }
+  LexicalReorderingTableTree::Create(text, path);
+  return pairs;
+}
+
+struct Query {
+  Phrase f, e;
+};
+
+// frequent phrase pairs are looked up much more often than rare ones
+void MakeQueries(const vector<pair<string, string> > &pairs, size_t count,
+                 unsigned int seed, vector<Query> &queries)
+{
+  vector<FactorType> factors(1, 0);
+  queries.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    double r = (double) Next(seed) / 0x1000000;
+    const pair<string, string> &p = pairs[(size_t) (pairs.size() * r * r * r)];
+    queries[i].f.CreateFromString(Input, factors, p.first, NULL);
+    queries[i].e.CreateFromString(Output, factors, p.second, NULL);
+  }
+}
+
+// what LexicalReorderingTableTree did before
+class StringMapCache
+{
+public:
+  StringMapCache(LexicalReorderingTable &table) : m_table(table), m_factors(1, 0) {}
+
+  Scores GetScore(const Phrase &f, const Phrase &e) {
+    std::string key = f.GetStringRep(m_factors) + "|||" + e.GetStringRep(m_factors);
+    std::map<std::string, Scores>::const_iterator iter = m_cache.find(key);
+    if (iter != m_cache.end()) {
+      return iter->second;
+    }
+    Scores ret = m_table.GetScore(f, e, Phrase(ARRAY_SIZE_INCR));
+    m_cache[key] = ret;
+    return ret;
+  }
+
+  void Clear() {
+    m_cache.clear();
+  }
+
+private:
+  LexicalReorderingTable &m_table;
+  vector<FactorType> m_factors;
+  std::map<std::string, Scores> m_cache;
+};
+
+void Worker(LexicalReorderingTable *table, bool stringMap,
+            const vector<Query> *queries, boost::barrier *start)
+{
+  table->InitializeForInput(ttasksptr());
+  StringMapCache old(*table);
+  start->wait();
+  float twiddle = 0;
+  for (size_t i = 0; i < queries->size(); ++i) {
+    const Query &query = (*queries)[i];
+    Scores scores;
+    if (stringMap) {
+      if (i % SentenceLength == 0) old.Clear();
+      scores = old.GetScore(query.f, query.e);
+    } else {
+      scores = table->GetScore(query.f, query.e, Phrase(ARRAY_SIZE_INCR));
+    }
+    if (!scores.empty()) twiddle += scores[0];
+  }
+  if (twiddle == -1) cerr << "unlikely" << endl;
+}
+
+// lookups per second
+double Run(LexicalReorderingTable &table, bool stringMap,
+           const vector<vector<Query> > &queries, size_t numThreads)
+{
+  boost::barrier start(numThreads + 1);
+  boost::thread_group threads;
+  size_t total = 0;
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.create_thread(boost::bind(&Worker, &table, stringMap, &queries[i], &start));
+    total += queries[i].size();
+  }
+  start.wait();
+  double begin = util::WallTime();
+  threads.join_all();
+  return total / (util::WallTime() - begin);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  size_t maxThreads = argc > 1 ? atoi(argv[1]) : 4;
+  size_t numLookups = argc > 2 ? atoi(argv[2]) : 200000;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 20000;
+
+  boost::filesystem::path dir = boost::filesystem::temp_directory_path()
+                                / boost::filesystem::unique_path("moses-lexr-bench-%%%%%%");
+  boost::filesystem::create_directories(dir);
+  string path = (dir / "reordering-table").string();
+  vector<pair<string, string> > pairs = WriteTable(path, vocabSize);
+
+  vector<vector<Query> > queries(maxThreads);
+  for (size_t i = 0; i < maxThreads; ++i) {
+    MakeQueries(pairs, numLookups, 42 + i, queries[i]);
+  }
+
+  vector<FactorType> factors(1, 0);
+  LexicalReorderingTableTree uncached(path, factors, factors, vector<FactorType>());
+
+  cout << "threads\tno-cache Mlookups/s\tstring-map Mlookups/s\tshared-cache Mlookups/s" << endl;
+  for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+    // a fresh shared cache each time, so it warms up like a new process
+    LexicalReorderingTableTree cached(path, factors, factors, vector<FactorType>(), 64 << 20);
+    double none = Run(uncached, false, queries, numThreads);
+    double stringMap = Run(uncached, true, queries, numThreads);
+    double shared = Run(cached, false, queries, numThreads);
+    cout << numThreads << "\t" << none / 1e6 << "\t" << stringMap / 1e6
+         << "\t" << shared / 1e6 << endl;
+    cerr << "shared cache: " << cached.GetCache()->GetStats() << endl;
+  }
+
+  boost::filesystem::remove_all(dir);
+  return 0;
+}
@@ -59,6 +59,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "util/exception.hh"
 #include "util/random.hh"
 #include "util/string_stream.hh"
+#include "Profiler.h"
 
 using namespace std;
 
@@ -92,6 +93,8 @@ Manager::~Manager()
   delete m_transOptColl;
   delete m_search;
   StaticData::Instance().CleanUpAfterSentenceProcessing(m_ttask.lock());
+  // the hypotheses went with the search
+  m_arena.Reset();
 }
 
 const InputType&
@@ -130,7 +133,10 @@ void Manager::Decode()
   IFVERBOSE(1) {
     GetSentenceStats().StartTimeCollectOpts();
   }
-  m_transOptColl->CreateTranslationOptions();
+  {
+    Profiler::Scope profile(Profiler::CollectTranslationOptions);
+    m_transOptColl->CreateTranslationOptions();
+  }
 
   // some reporting on how long this took
   IFVERBOSE(1) {
@@ -144,7 +150,13 @@ void Manager::Decode()
   // search for best translation with the specified algorithm
   Timer searchTime;
   searchTime.start();
-  m_search->Decode();
+  {
+    SentenceArena::Scope arenaScope(m_arena);
+    Profiler::Scope profile(Profiler::Search);
+    m_search->Decode();
+  }
+  GetSentenceStats().SetArenaStats(m_arena.GetNumAllocated(), m_arena.GetNumReused(),
+                                   m_arena.GetBytesAllocated());
   VERBOSE(1, "Line " << m_source.GetTranslationId()
           << ": Search took " << searchTime << " seconds" << endl);
   IFVERBOSE(2) {
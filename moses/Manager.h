@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Search.h"
 #include "SearchCubePruning.h"
 #include "BaseManager.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -119,6 +120,7 @@ protected:
   size_t interrupted_flag;
   std::auto_ptr<SentenceStats> m_sentenceStats;
   int m_hypoId; //used to number the hypos as they are created.
+  SentenceArena m_arena; /**< hypotheses, FF states and arc lists of this sentence */
 
   void GetConnectedGraph(
     std::map< int, bool >* pConnected,
@@ -87,6 +87,7 @@ Parameter::Parameter()
   AddParam(search_opts,"early-discarding-threshold", "edt", "threshold for constructing hypotheses based on estimate cost");
   AddParam(search_opts,"stack", "s", "maximum stack size for histogram pruning. 0 = unlimited stack size");
   AddParam(search_opts,"stack-diversity", "sd", "minimum number of hypothesis of each coverage in stack (default 0)");
+  AddParam(search_opts,"incremental-stack-pruning", "keep each stack at its maximum size on every insert, using a heap of scores, instead of sorting it when it gets twice as big. Ignored with stack-diversity");
 
   // feature weight-related options
   AddParam(search_opts,"weight-file", "wf", "feature weights file. Do *not* put weights for 'core' features in here - they go in moses.ini");
@@ -104,6 +105,9 @@ Parameter::Parameter()
   AddParam(search_opts,"max-trans-opt-per-coverage", "maximum number of translation options per input span (after applying mapping steps)");
   AddParam(search_opts,"max-phrase-length", "maximum phrase length (default 20)");
   AddParam(search_opts,"translation-option-threshold", "tot", "threshold for translation options relative to best for input phrase");
+  AddParam(search_opts,"translation-option-threads", "number of threads that create the translation options of one sentence, including the decoding thread (default 1). One thread unless every feature function is thread-safe in isolation");
+  AddParam(search_opts,"profile-file", "count the time spent and calls made by each feature function, and write them to this file as JSON when done. The server returns them from the profile method");
+  AddParam(search_opts,"translation-option-cache-mb", "size in MB of a cache of the translation options of source phrases, shared by all sentences and threads (default 0 = no cache)");
 
   // miscellaneous search options
   AddParam(search_opts,"disable-discarding", "dd", "disable hypothesis discarding"); // ??? memory management? UG
@@ -123,6 +127,7 @@ Parameter::Parameter()
   AddParam(cube_opts,"cube-pruning-diversity", "cbd", "How many hypotheses should be created for each coverage. (default = 0)");
   AddParam(cube_opts,"cube-pruning-lazy-scoring", "cbls", "Don't fully score a hypothesis until it is popped");
   AddParam(cube_opts,"cube-pruning-deterministic-search", "cbds", "Break ties deterministically during search");
+  AddParam(cube_opts,"cube-pruning-batch-size", "cbbs", "How many hypotheses to pop before scoring their successors together, with prefetching. Approximate if more than 1 (default = 1)");
 
   ///////////////////////////////////////////////////////////////////////////////////////
   // minimum bayes risk decoding
@@ -0,0 +1,89 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+#include <vector>
+#include <boost/static_assert.hpp>
+#include "Profiler.h"
+#include "ConcurrentCache.h"
+#include "TranslationOptionCache.h"
+#include "FF/FeatureFunction.h"
+
+namespace Moses
+{
+
+namespace
+{
+
+const char *FeatureFunctionCallNames[] = {
+  "EvaluateInIsolation",
+  "EvaluateWithSourceContext",
+  "EvaluateTranslationOptionListWithSourceContext",
+  "EvaluateWhenApplied",
+  "Lookup"
+};
+
+const char *DecoderStepNames[] = {
+  "CollectTranslationOptions",
+  "Search"
+};
+
+// the decoder steps are used as events as they are
+BOOST_STATIC_ASSERT(Profiler::NumDecoderSteps <= Profiler::kFixedEvents);
+
+void WriteCacheStats(std::ostream &out, const ConcurrentCacheStats &stats)
+{
+  uint64_t lookups = stats.hits + stats.misses;
+  out << "{\"lookups\": " << lookups
+      << ", \"hits\": " << stats.hits
+      << ", \"hit_rate\": " << (lookups ? (double) stats.hits / lookups : 0.0)
+      << ", \"inserted\": " << stats.inserted
+      << ", \"rejected\": " << stats.rejected
+      << ", \"evicted\": " << stats.evicted
+      << ", \"entries\": " << stats.entries
+      << ", \"bytes\": " << stats.bytes
+      << ", \"capacity\": " << stats.capacity << "}";
+}
+
+}
+
+void Profiler::WriteJson(std::ostream &out)
+{
+  std::vector<Total> totals;
+  size_t numThreads = Totals(totals);
+
+  out << "{\"threads\": " << numThreads << ",\n \"decoder\": {";
+  bool first = true;
+  for (size_t i = 0; i < NumDecoderSteps; ++i) {
+    WriteJsonTotal(out, DecoderStepNames[i], totals[i], first);
+  }
+  out << "},\n \"features\": [";
+
+  const std::vector<FeatureFunction*> &ffs = FeatureFunction::GetFeatureFunctions();
+  for (size_t f = 0; f < ffs.size(); ++f) {
+    const FeatureFunction &ff = *ffs[f];
+    out << (f ? ",\n  " : "\n  ") << "{\"name\": ";
+    WriteJsonString(out, ff.GetScoreProducerDescription());
+    out << ", \"calls\": {";
+    first = true;
+    for (size_t call = 0; call < NumFeatureFunctionCalls; ++call) {
+      size_t event = ff.GetProfilerEvent((FeatureFunctionCall) call);
+      if (event < MaxEvents) {
+        WriteJsonTotal(out, FeatureFunctionCallNames[call], totals[event], first);
+      }
+    }
+    out << "}";
+    ConcurrentCacheStats stats;
+    if (ff.GetCacheStats(stats)) {
+      out << ", \"cache\": ";
+      WriteCacheStats(out, stats);
+    }
+    out << "}";
+  }
+  out << "],\n \"caches\": {";
+  const TranslationOptionCache *transOptCache = TranslationOptionCache::Instance();
+  if (transOptCache) {
+    out << "\"translation-option-cache\": ";
+    WriteCacheStats(out, transOptCache->GetStats());
+  }
+  out << "}}" << std::endl;
+}
+
+}
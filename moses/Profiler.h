@@ -0,0 +1,69 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_Profiler_h
+#define moses_Profiler_h
+
+#include <iostream>
+#include "util/profiler.hh"
+
+namespace Moses
+{
+
+/** util::Profiler with the events of the decoder: the main steps of decoding
+ *  a sentence and the calls of each feature function. Off unless
+ *  profile-file is given. It is then written there as JSON when the
+ *  decoder exits, and returned by the "profile" method of the server.
+ */
+class Profiler : public util::Profiler
+{
+public:
+  //! the calls timed for each feature function
+  enum FeatureFunctionCall {
+    EvaluateInIsolation,
+    EvaluateWithSourceContext,
+    EvaluateTranslationOptionListWithSourceContext,
+    EvaluateWhenApplied,
+    Lookup, // phrase tables only
+    NumFeatureFunctionCalls
+  };
+
+  //! the steps of decoding a sentence, fixed events
+  enum DecoderStep {
+    CollectTranslationOptions,
+    Search,
+    NumDecoderSteps
+  };
+
+  //! no event, not counted
+  static const size_t MaxEvents = kMaxEvents;
+
+  //! the first of NumFeatureFunctionCalls events, in the order of FeatureFunctionCall
+  static size_t RegisterFeatureFunction() {
+    return Reserve(NumFeatureFunctionCalls);
+  }
+
+  //! all counts so far, with the cache statistics of the feature functions
+  static void WriteJson(std::ostream &out);
+};
+
+}
+
+#endif
@@ -69,6 +69,11 @@ RegisterScoreProducer(FeatureFunction* scoreProducer)
           << scoreProducer->GetScoreProducerDescription()
           << " start: " << start
           << " end: "   << (s_denseVectorSize-1) << endl);
+  if (start <= FVECTOR_INLINE_CORE && s_denseVectorSize > FVECTOR_INLINE_CORE) {
+    VERBOSE(1, "More than " << FVECTOR_INLINE_CORE << " dense features."
+            << " Scores will be stored on the heap. Rebuild with a larger --inline-dense-scores to avoid this"
+            << endl);
+  }
 }
 
 
@@ -4,6 +4,8 @@
 #include "StaticData.h"
 #include "InputType.h"
 #include "TranslationOptionCollection.h"
+#include <algorithm>
+#include <queue>
 #include <boost/foreach.hpp>
 using namespace std;
 
@@ -24,27 +26,22 @@ public:
     }
 
     // Compare the top hypothesis of each bitmap container using the TotalScore, which includes future cost
-    const float scoreA = A->Top()->GetHypothesis()->GetFutureScore();
-    const float scoreB = B->Top()->GetHypothesis()->GetFutureScore();
+    const float scoreA = A->Top()->GetFutureScore();
+    const float scoreB = B->Top()->GetFutureScore();
 
     if (scoreA < scoreB) {
       return true;
     } else if (scoreA > scoreB) {
       return false;
     } else {
-      // Equal scores: break ties by comparing target phrases (if they exist)
-      // *Important*: these are pointers to copies of the target phrases from the
-      // hypotheses.  This class is used to keep priority queues ordered in the
-      // background, so comparisons made as those data structures are cleaned up
-      // may occur *after* the target phrases in hypotheses have been cleaned up,
-      // leading to segfaults if relying on hypotheses to provide target phrases.
-      boost::shared_ptr<TargetPhrase> phrA = A->Top()->GetTargetPhrase();
-      boost::shared_ptr<TargetPhrase> phrB = B->Top()->GetTargetPhrase();
-      if (!phrA || !phrB) {
+      // Equal scores: break ties by comparing target phrases in
+      // deterministic mode. The top hypotheses are alive as long as they
+      // are queued in their containers.
+      if (!A->IsDeterministic() || !B->IsDeterministic()) {
         // Fallback: compare pointers, non-deterministic sort
         return A < B;
       }
-      return (phrA->Compare(*phrB) > 0);
+      return (A->Top()->GetCurrTargetPhrase().Compare(B->Top()->GetCurrTargetPhrase()) > 0);
     }
   }
 };
@@ -129,6 +126,14 @@ void SearchCubePruning::Decode()
     }
 
     // main search loop, pop k best hyps
+    if (m_manager.options()->cube.batch_size > 1) {
+      std::vector<BitmapContainer*> containers;
+      while (!BCQueue.empty()) {
+        containers.push_back(BCQueue.top());
+        BCQueue.pop();
+      }
+      ProcessBatches(containers, PopLimit, m_manager.options()->cube.batch_size);
+    }
     for (size_t numpops = 1; numpops <= PopLimit && !BCQueue.empty(); numpops++) {
       // get currently best hypothesis in queue
       m_manager.GetSentenceStats().StartTimeManageCubes();
@@ -191,6 +196,60 @@ void SearchCubePruning::Decode()
   }
 }
 
+/**
+ * Main search loop with cube-pruning-batch-size: pops batchSize hypotheses,
+ * then makes and scores the successors of all of them together, so the
+ * feature functions can prefetch. The successors of a hypothesis can't be
+ * popped in the same batch, which makes this approximate.
+ */
+void SearchCubePruning::ProcessBatches(std::vector<BitmapContainer*> &containers,
+                                       size_t popLimit, size_t batchSize)
+{
+  BitmapContainerOrderer orderer;
+  std::vector<BitmapContainer*> emptied;
+  std::vector<CubeSuccessor> batch;
+
+  std::make_heap(containers.begin(), containers.end(), orderer);
+  size_t numpops = 0;
+  while (numpops < popLimit && !containers.empty()) {
+    batch.clear();
+    for (size_t i = 0; i < batchSize && numpops < popLimit && !containers.empty(); ++i, ++numpops) {
+      std::pop_heap(containers.begin(), containers.end(), orderer);
+      BitmapContainer *bc = containers.back();
+      containers.pop_back();
+      IFVERBOSE(2) {
+        m_manager.GetSentenceStats().AddPopped();
+      }
+      bc->ProcessBestHypothesis(&batch);
+      if (bc->Empty()) {
+        emptied.push_back(bc);
+      } else {
+        containers.push_back(bc);
+        std::push_heap(containers.begin(), containers.end(), orderer);
+      }
+    }
+
+    IFVERBOSE(2) {
+      m_manager.GetSentenceStats().StartTimeOtherScore();
+    }
+    BackwardsEdge::PushSuccessors(batch);
+    IFVERBOSE(2) {
+      m_manager.GetSentenceStats().StopTimeOtherScore();
+    }
+
+    // the successors changed the tops of their containers
+    m_manager.GetSentenceStats().StartTimeManageCubes();
+    for (size_t i = 0; i < emptied.size(); ++i) {
+      if (!emptied[i]->Empty()) containers.push_back(emptied[i]);
+    }
+    emptied.clear();
+    if (!batch.empty()) {
+      std::make_heap(containers.begin(), containers.end(), orderer);
+    }
+    m_manager.GetSentenceStats().StopTimeManageCubes();
+  }
+}
+
 void SearchCubePruning::CreateForwardTodos(HypothesisStackCubePruning &stack)
 {
   const _BMType &bitmapAccessor = stack.GetBitmapAccessor();
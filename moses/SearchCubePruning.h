@@ -27,6 +27,8 @@ protected:
   //! create a back pointer to this bitmap, with edge that has this words range translation
   void CreateForwardTodos(const Bitmap &bitmap, const Range &range, BitmapContainer &bitmapContainer);
   bool CheckDistortion(const Bitmap &bitmap, const Range &range) const;
+  //! the main search loop for a cube-pruning-batch-size over 1
+  void ProcessBatches(std::vector<BitmapContainer*> &containers, size_t popLimit, size_t batchSize);
 
   void PrintBitmapContainerGraph();
 
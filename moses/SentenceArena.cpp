@@ -0,0 +1,125 @@
+#include <cassert>
+#include <cstdlib>
+#include <boost/thread/tss.hpp>
+#include "SentenceArena.h"
+#include "util/scoped.hh"
+
+namespace Moses
+{
+
+namespace
+{
+
+// in front of every block, whether it came from an arena or the heap.
+// 16 bytes so that the object behind it stays aligned
+union Header {
+  struct {
+    SentenceArena *arena;
+    std::size_t sizeClass;
+  } info;
+  double align[2];
+};
+
+const std::size_t kGranularity = sizeof(Header);
+
+void NoCleanup(SentenceArena *)
+{
+}
+
+boost::thread_specific_ptr<SentenceArena> s_current(&NoCleanup);
+
+}
+
+SentenceArena::SentenceArena()
+  : m_numAllocated(0)
+  , m_numReused(0)
+  , m_bytesAllocated(0)
+  , m_numLive(0)
+  , m_owner(boost::this_thread::get_id())
+{
+}
+
+SentenceArena::~SentenceArena()
+{
+  // the pool frees everything
+  assert(m_numLive == 0);
+}
+
+void SentenceArena::Reset()
+{
+  // a live object would be overwritten by the next sentence's
+  assert(m_numLive == 0);
+  m_pool.FreeAll();
+  m_freeLists.clear();
+}
+
+void *SentenceArena::Allocate(std::size_t size)
+{
+  std::size_t sizeClass = (size + sizeof(Header) + kGranularity - 1) / kGranularity;
+
+  SentenceArena *arena = s_current.get();
+  Header *header;
+  if (arena) {
+    header = static_cast<Header*>(arena->AllocateBlock(sizeClass));
+  } else {
+    header = static_cast<Header*>(util::MallocOrThrow(sizeClass * kGranularity));
+  }
+  header->info.arena = arena;
+  header->info.sizeClass = sizeClass;
+  return header + 1;
+}
+
+void SentenceArena::Free(void *ptr)
+{
+  if (ptr == NULL) {
+    return;
+  }
+  Header *header = static_cast<Header*>(ptr) - 1;
+  if (header->info.arena) {
+    header->info.arena->FreeBlock(header, header->info.sizeClass);
+  } else {
+    std::free(header);
+  }
+}
+
+void *SentenceArena::AllocateBlock(std::size_t sizeClass)
+{
+  ++m_numAllocated;
+  ++m_numLive;
+  if (sizeClass < m_freeLists.size() && m_freeLists[sizeClass]) {
+    // first word of a free block points to the next one
+    void *block = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = *static_cast<void**>(block);
+    ++m_numReused;
+    return block;
+  }
+
+  m_bytesAllocated += sizeClass * kGranularity;
+  return m_pool.Allocate(sizeClass * kGranularity);
+}
+
+void SentenceArena::FreeBlock(void *block, std::size_t sizeClass)
+{
+  assert(boost::this_thread::get_id() == m_owner);
+  assert(m_numLive > 0);
+  --m_numLive;
+  if (sizeClass >= m_freeLists.size()) {
+    m_freeLists.resize(sizeClass + 1, NULL);
+  }
+  *static_cast<void**>(block) = m_freeLists[sizeClass];
+  m_freeLists[sizeClass] = block;
+}
+
+SentenceArena::Scope::Scope(SentenceArena &arena)
+  : m_prev(s_current.get())
+{
+  assert(boost::this_thread::get_id() == arena.m_owner);
+  s_current.reset(&arena);
+}
+
+SentenceArena::Scope::~Scope()
+{
+  s_current.reset(m_prev);
+}
+
+}
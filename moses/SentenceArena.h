@@ -0,0 +1,90 @@
+#ifndef moses_SentenceArena_h
+#define moses_SentenceArena_h
+
+#include <cstddef>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include "util/pool.hh"
+
+namespace Moses
+{
+
+/** Memory for the hypotheses, feature function states and arc lists of one
+ *  sentence, owned by its Manager.
+ *
+ *  Objects are still destroyed one at a time, but the memory of a deleted
+ *  object only goes onto a free list for the next object of the same size.
+ *  Nothing goes back to malloc until Reset(), which the Manager calls once
+ *  the search and its hypotheses are gone.
+ *
+ *  Hypothesis, FFState and ArcList allocations made by a thread come from the
+ *  arena while a SentenceArena::Scope is alive on that thread, and from the
+ *  heap otherwise. Free() can tell the two apart, so an arena object may be
+ *  deleted outside the scope, but only by the thread that created the arena
+ *  and before Reset(). Nothing may outlive the Manager: n-best lists, lattices
+ *  and search graphs must be written out while it is alive. Both rules are
+ *  asserted in debug builds.
+ */
+class SentenceArena
+{
+public:
+  SentenceArena();
+  ~SentenceArena();
+
+  //! from the arena in scope on this thread, if any, else the heap
+  static void *Allocate(std::size_t size);
+  static void Free(void *ptr);
+
+  //! frees all the memory at once. Every object allocated from the arena
+  //! must have been deleted
+  void Reset();
+
+  //! objects allocated, including those that reused freed memory
+  std::size_t GetNumAllocated() const {
+    return m_numAllocated;
+  }
+  std::size_t GetNumReused() const {
+    return m_numReused;
+  }
+  //! memory taken from the pool
+  std::size_t GetBytesAllocated() const {
+    return m_bytesAllocated;
+  }
+
+  /** makes arena the one allocated from by this thread until destruction */
+  class Scope
+  {
+  public:
+    explicit Scope(SentenceArena &arena);
+    ~Scope();
+
+  private:
+    SentenceArena *m_prev;
+
+    Scope(const Scope &);
+    Scope &operator=(const Scope &);
+  };
+
+private:
+  util::Pool m_pool;
+
+  // one singly linked list of freed blocks per size class
+  std::vector<void*> m_freeLists;
+
+  std::size_t m_numAllocated, m_numReused, m_bytesAllocated;
+
+  // objects not deleted yet and the thread that may delete them, for the
+  // assertions
+  std::size_t m_numLive;
+  boost::thread::id m_owner;
+
+  void *AllocateBlock(std::size_t sizeClass);
+  void FreeBlock(void *block, std::size_t sizeClass);
+
+  SentenceArena(const SentenceArena &);
+  SentenceArena &operator=(const SentenceArena &);
+};
+
+}
+
+#endif
@@ -66,6 +66,9 @@ public:
     m_numHyposDiscarded = 0;
     m_numHyposEarlyDiscarded = 0;
     m_numHyposNotBuilt = 0;
+    m_numArenaAllocs = 0;
+    m_numArenaReused = 0;
+    m_arenaBytes = 0;
     m_totalSourceWords = source.GetSize();
     m_recombinationInfos.clear();
     m_deletedWords.clear();
@@ -98,6 +101,16 @@ public:
   unsigned int GetNumHyposNotBuilt() const {
     return m_numHyposNotBuilt;
   }
+  //! objects in the Manager's SentenceArena
+  size_t GetNumArenaAllocs() const {
+    return m_numArenaAllocs;
+  }
+  size_t GetNumArenaReused() const {
+    return m_numArenaReused;
+  }
+  size_t GetArenaBytes() const {
+    return m_arenaBytes;
+  }
   double GetTimeCollectOpts() const {
     return m_timeCollectOpts.get_elapsed_time();
   }
@@ -160,6 +173,11 @@ public:
   void AddNotBuilt() {
     m_numHyposNotBuilt++;
   }
+  void SetArenaStats(size_t numAllocs, size_t numReused, size_t bytes) {
+    m_numArenaAllocs = numAllocs;
+    m_numArenaReused = numReused;
+    m_arenaBytes = bytes;
+  }
   void AddDiscarded() {
     m_numHyposDiscarded++;
   }
@@ -237,6 +255,9 @@ protected:
   unsigned int m_numHyposDiscarded;
   unsigned int m_numHyposEarlyDiscarded;
   unsigned int m_numHyposNotBuilt;
+  size_t m_numArenaAllocs;
+  size_t m_numArenaReused;
+  size_t m_arenaBytes;
   Timer m_timeCollectOpts;
   Timer m_timeBuildHyp;
   Timer m_timeEstimateScore;
@@ -265,6 +286,7 @@ inline std::ostream& operator<<(std::ostream& os, const SentenceStats& ss)
          << "           number discarded = " << ss.GetNumHyposDiscarded() << std::endl
          << "          number recombined = " << ss.GetNumHyposRecombined() << std::endl
          << "              number pruned = " << ss.GetNumHyposPruned() << std::endl
+         << "          arena allocations = " << ss.GetNumArenaAllocs() << " (" << ss.GetNumArenaReused() << " reused, " << ss.GetArenaBytes() << " bytes)" << std::endl
 
          << "time to collect opts    " << ss.GetTimeCollectOpts()   << " (" << (int)(100 * ss.GetTimeCollectOpts()/totalTime) << "%)" << std::endl
          << "        create hyps     " << ss.GetTimeBuildHyp()      << " (" << (int)(100 * ss.GetTimeBuildHyp()/totalTime) << "%)" << std::endl
@@ -0,0 +1,94 @@
+// End to end benchmark of hypothesis stack pruning.
+// Writes a synthetic phrase table, bigram language model and moses.ini to a
+// temporary directory, then decodes the same random sentences with stack
+// sizes from 100 to 10000, once with the default lazy pruning (sort the
+// stack when it gets twice too big) and once with incremental-stack-pruning
+// (a heap of scores, the stack never goes over its size).
+// The language model keeps hypotheses from recombining, so the stacks fill.
+//
+// Usage: StackPruningBenchmark [sentences] [sentence-length] [vocab-size] [max-stack]
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Benchmark.h"
+#include "Hypothesis.h"
+#include "Manager.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationTask.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace
+{
+
+struct Result {
+  double seconds;
+  size_t hypotheses;
+  double totalScore;
+};
+
+Result Decode(const vector<string> &sentences, size_t stackSize, bool incremental)
+{
+  Result ret = { 0, 0, 0 };
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    AllOptions *options = new AllOptions(*StaticData::Instance().options());
+    options->search.stack_size = stackSize;
+    options->search.incremental_pruning = incremental;
+    AllOptions::ptr opts(options);
+    boost::shared_ptr<Sentence> sentence(new Sentence(opts, i, sentences[i]));
+    ttasksptr ttask = TranslationTask::create(sentence);
+    Manager manager(ttask);
+
+    double begin = util::WallTime();
+    manager.Decode();
+    ret.seconds += util::WallTime() - begin;
+    ret.hypotheses += manager.GetNextHypoId();
+    const Hypothesis *best = manager.GetBestHypothesis();
+    if (best) ret.totalScore += best->GetFutureScore();
+  }
+  return ret;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  size_t numSentences = argc > 1 ? atoi(argv[1]) : 5;
+  size_t length = argc > 2 ? atoi(argv[2]) : 20;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 1000;
+  size_t maxStack = argc > 4 ? atoi(argv[4]) : 10000;
+
+  Benchmark::SyntheticModel::Config config;
+  config.vocabSize = vocabSize;
+  config.translationsPerWord = 8;
+  config.languageModel = true;
+  Benchmark::SyntheticModel model("stack-bench", config);
+  if (!model.Load(argv[0])) {
+    return 1;
+  }
+
+  vector<string> sentences;
+  unsigned int seed = 42;
+  for (size_t i = 0; i < numSentences; ++i) {
+    sentences.push_back(model.MakeSentence(length, seed));
+  }
+
+  cout << "stack\tlazy s\tincremental s\tlazy hypos\tincremental hypos\tlazy score\tincremental score" << endl;
+  for (size_t stackSize = 100; stackSize <= maxStack; stackSize *= 10) {
+    Result lazy = Decode(sentences, stackSize, false);
+    Result incremental = Decode(sentences, stackSize, true);
+    cout << stackSize << "\t" << lazy.seconds << "\t" << incremental.seconds
+         << "\t" << lazy.hypotheses << "\t" << incremental.hypotheses
+         << "\t" << lazy.totalScore << "\t" << incremental.totalScore << endl;
+  }
+
+  return 0;
+}
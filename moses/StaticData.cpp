@@ -40,6 +40,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "FactorCollection.h"
 #include "Timer.h"
 #include "TranslationOption.h"
+#include "TranslationOptionCache.h"
+#include "Profiler.h"
 #include "DecodeGraph.h"
 #include "InputFileStream.h"
 #include "ScoreComponentCollection.h"
@@ -67,6 +69,7 @@ StaticData StaticData::s_instance;
 StaticData::StaticData()
   : m_options(new AllOptions)
   , m_requireSortingAfterSourceContext(false)
+  , m_transOptThreadCount(1)
   , m_currentWeightSetting("default")
   , m_treeStructure(NULL)
   , m_coordSpaceNextID(1)
@@ -170,6 +173,27 @@ StaticData
 #endif
     }
   }
+
+  m_parameter->SetParameter<size_t>(m_transOptThreadCount, "translation-option-threads", 1);
+  if (m_transOptThreadCount < 1) m_transOptThreadCount = 1;
+  if (m_transOptThreadCount > 1) {
+#ifdef WITH_THREADS
+    // the decoding thread of the sentence is the other one
+    m_transOptThreadPool.reset(new ThreadPool(m_transOptThreadCount - 1));
+#else
+    std::cerr << "Error: translation-option-threads of " << m_transOptThreadCount
+              << " but moses not built with thread support";
+    return false;
+#endif
+  }
+
+  if (m_parameter->GetParam("profile-file")) {
+    Profiler::Enable();
+  }
+
+  size_t transOptCacheMB;
+  m_parameter->SetParameter<size_t>(transOptCacheMB, "translation-option-cache-mb", 0);
+  TranslationOptionCache::Initialize(transOptCacheMB << 20);
   return true;
 }
 
@@ -213,6 +237,24 @@ bool StaticData::LoadData(Parameter *parameter)
 
   LoadDecodeGraphs();
 
+#ifdef WITH_THREADS
+  // the options of a sentence are only made on several threads if every
+  // feature function can score them that way
+  if (m_transOptThreadPool) {
+    const std::vector<FeatureFunction*> &ffs = FeatureFunction::GetFeatureFunctions();
+    for (size_t i = 0; i < ffs.size(); ++i) {
+      if (!ffs[i]->IsThreadSafeInIsolation()) {
+        std::cerr << "Warning: " << ffs[i]->GetScoreProducerDescription()
+                  << " can't score in isolation on several threads, "
+                  << "translation options are made on one thread" << std::endl;
+        m_transOptThreadPool.reset();
+        m_transOptThreadCount = 1;
+        break;
+      }
+    }
+  }
+#endif
+
   // sanity check that there are no weights without an associated FF
   if (!CheckWeights()) return false;
 
@@ -249,10 +291,18 @@ bool StaticData::LoadData(Parameter *parameter)
   return true;
 }
 
+// translation options cached with the old weights have the wrong scores
+void StaticData::SetAllWeights(const ScoreComponentCollection& weights)
+{
+  m_allWeights = weights;
+  TranslationOptionCache::Invalidate();
+}
+
 void StaticData::SetWeight(const FeatureFunction* sp, float weight)
 {
   m_allWeights.Resize();
   m_allWeights.Assign(sp,weight);
+  TranslationOptionCache::Invalidate();
 }
 
 void StaticData::SetWeights(const FeatureFunction* sp,
@@ -260,6 +310,7 @@ void StaticData::SetWeights(const FeatureFunction* sp,
 {
   m_allWeights.Resize();
   m_allWeights.Assign(sp,weights);
+  TranslationOptionCache::Invalidate();
 }
 
 void StaticData::LoadNonTerminals()
@@ -940,6 +991,7 @@ void StaticData::ResetWeights(const std::string &denseWeights, const std::string
     const FeatureFunction &ff = FeatureFunction::FindFeatureFunction(names[0]);
     m_allWeights.Assign(&ff, names[1], Scan<float>(toks[1]));
   }
+  TranslationOptionCache::Invalidate();
 }
 
 size_t StaticData::GetCoordSpace(string space) const
@@ -40,6 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Parameter.h"
 #include "SentenceStats.h"
+#include "ThreadPool.h"
 #include "ScoreComponentCollection.h"
 #include "moses/FF/Factory.h"
 #include "moses/PP/Factory.h"
@@ -111,6 +112,10 @@ protected:
   UnknownLHSList m_unknownLHS;
 
   int m_threadCount;
+  size_t m_transOptThreadCount;
+#ifdef WITH_THREADS
+  boost::shared_ptr<ThreadPool> m_transOptThreadPool; //! helpers of translation-option-threads
+#endif
   // long m_startTranslationId;
 
   // alternate weight settings
@@ -214,9 +219,7 @@ public:
     return m_allWeights;
   }
 
-  void SetAllWeights(const ScoreComponentCollection& weights) {
-    m_allWeights = weights;
-  }
+  void SetAllWeights(const ScoreComponentCollection& weights);
 
   //Weight for a single-valued feature
   float GetWeight(const FeatureFunction* sp) const {
@@ -265,6 +268,18 @@ public:
     return m_threadCount;
   }
 
+  //! translation-option-threads
+  size_t GetTranslationOptionThreadCount() const {
+    return m_transOptThreadCount;
+  }
+
+#ifdef WITH_THREADS
+  //! threads that help create the translation options of a sentence, NULL if none
+  ThreadPool *GetTranslationOptionThreadPool() const {
+    return m_transOptThreadPool.get();
+  }
+#endif
+
   void SetExecPath(const std::string &path);
   const std::string &GetBinDirectory() const;
 
@@ -190,6 +190,7 @@ void TargetPhrase::EvaluateInIsolation(const Phrase &source, const std::vector<F
     for (size_t i = 0; i < ffs.size(); ++i) {
       const FeatureFunction &ff = *ffs[i];
       if (! staticData.IsFeatureFunctionIgnored( ff )) {
+        Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateInIsolation));
         ff.EvaluateInIsolation(source, *this, m_scoreBreakdown, estimatedScores);
       }
     }
@@ -208,6 +209,7 @@ void TargetPhrase::EvaluateWithSourceContext(const InputType &input, const Input
   for (size_t i = 0; i < ffs.size(); ++i) {
     const FeatureFunction &ff = *ffs[i];
     if (! staticData.IsFeatureFunctionIgnored( ff )) {
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateWithSourceContext));
       ff.EvaluateWithSourceContext(input, inputPath, *this, NULL, m_scoreBreakdown, &futureScoreBreakdown);
     }
   }
@@ -35,6 +35,25 @@ namespace Moses
 {
 std::vector<PhraseDictionary*> PhraseDictionary::s_staticColl;
 
+namespace
+{
+// rough memory used by a cached collection, for the shared cache's limit
+size_t EstimateBytes(const TargetPhraseCollection::shared_ptr &tpc)
+{
+  size_t ret = 64; // the cache entry and the shared count
+  if (tpc) {
+    ret += sizeof(TargetPhraseCollection);
+    TargetPhraseCollection::const_iterator iter;
+    for (iter = tpc->begin(); iter != tpc->end(); ++iter) {
+      const TargetPhrase &tp = **iter;
+      ret += sizeof(TargetPhrase*) + sizeof(TargetPhrase)
+             + tp.GetSize() * sizeof(Word);
+    }
+  }
+  return ret;
+}
+}
+
 PhraseDictionary::PhraseDictionary(const std::string &line, bool registerNow)
   : DecodeFeature(line, registerNow)
   , m_tableLimit(20) // default
@@ -44,6 +63,14 @@ PhraseDictionary::PhraseDictionary(const std::string &line, bool registerNow)
   s_staticColl.push_back(this);
 }
 
+PhraseDictionary::~PhraseDictionary()
+{
+  if (m_sharedCache) {
+    VERBOSE(1, GetScoreProducerDescription() << " shared cache: "
+            << m_sharedCache->GetStats() << endl);
+  }
+}
+
 bool
 PhraseDictionary::
 ProvidesPrefixCheck() const
@@ -57,7 +84,16 @@ GetTargetPhraseCollectionLEGACY(const Phrase& src) const
 {
   TargetPhraseCollection::shared_ptr ret;
   typedef std::pair<TargetPhraseCollection::shared_ptr , clock_t> entry;
-  if (m_maxCacheSize) {
+  if (m_sharedCache) {
+    size_t hash = hash_value(src);
+    if (!m_sharedCache->Find(hash, ret)) {
+      ret = GetTargetPhraseCollectionNonCacheLEGACY(src);
+      if (ret) { // make a copy
+        ret.reset(new TargetPhraseCollection(*ret));
+      }
+      m_sharedCache->Insert(hash, ret, EstimateBytes(ret));
+    }
+  } else if (m_maxCacheSize) {
     CacheColl &cache = GetCache();
 
     size_t hash = hash_value(src);
@@ -105,6 +141,9 @@ SetParameter(const std::string& key, const std::string& value)
 {
   if (key == "cache-size") {
     m_maxCacheSize = Scan<size_t>(value);
+  } else if (key == "shared-cache-mb") {
+    size_t mb = Scan<size_t>(value);
+    m_sharedCache.reset(mb ? new SharedCacheColl(mb << 20) : NULL);
   } else if (key == "path") {
     m_filePath = value;
   } else if (key == "table-limit") {
@@ -167,6 +206,8 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
 // reduce presistent cache by half of maximum size
 void PhraseDictionary::ReduceCache() const
 {
+  if (m_sharedCache) return; // evicts as it goes
+
   Timer reduceCacheTime;
   reduceCacheTime.start();
   CacheColl &cache = GetCache();
@@ -31,11 +31,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <vector>
 #include <string>
 #include <boost/unordered_map.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
 #else
-#include <boost/scoped_ptr.hpp>
 #include <ctime>
 #endif
 
@@ -45,6 +45,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/InputPath.h"
 #include "moses/FF/DecodeFeature.h"
 #include "moses/ContextScope.h"
+#include "moses/ConcurrentCache.h"
 
 namespace Moses
 {
@@ -59,6 +60,8 @@ class ChartParser;
 // typedef std::pair<TargetPhraseCollection::shared_ptr, clock_t> TPCollLastUse;
 typedef std::pair<TargetPhraseCollection::shared_ptr, clock_t> CacheCollEntry;
 typedef boost::unordered_map<size_t, CacheCollEntry> CacheColl;
+// shared by all threads, keyed by the hash of the source phrase like CacheColl
+typedef ConcurrentCache<size_t, TargetPhraseCollection::shared_ptr> SharedCacheColl;
 
 /**
   * Abstract base class for phrase dictionaries (tables).
@@ -71,14 +74,19 @@ class PhraseDictionary :  public DecodeFeature
 public:
   virtual bool ProvidesPrefixCheck() const;
 
+  //! true if the translations of a phrase depend on the translation task,
+  //! eg. its context scope, not only on the phrase
+  virtual bool IsContextDependent() const {
+    return false;
+  }
+
   static const std::vector<PhraseDictionary*>& GetColl() {
     return s_staticColl;
   }
 
   PhraseDictionary(const std::string &line, bool registerNow);
 
-  virtual ~PhraseDictionary() {
-  }
+  virtual ~PhraseDictionary();
 
   //! table limit number.
   size_t GetTableLimit() const {
@@ -145,6 +153,17 @@ public:
     return m_featuresToApply;
   }
 
+  //! NULL unless shared-cache-mb is set
+  const SharedCacheColl *GetSharedCache() const {
+    return m_sharedCache.get();
+  }
+
+  bool GetCacheStats(ConcurrentCacheStats &stats) const {
+    if (!m_sharedCache) return false;
+    stats = m_sharedCache->GetStats();
+    return true;
+  }
+
   void SetParameter(const std::string& key, const std::string& value);
 
   // LEGACY
@@ -178,6 +197,10 @@ protected:
   mutable boost::scoped_ptr<CacheColl> m_cache;
 #endif
 
+  // replaces m_cache when set. One copy of each collection for all threads,
+  // limited in bytes rather than entries
+  boost::scoped_ptr<SharedCacheColl> m_sharedCache;
+
   virtual
   TargetPhraseCollection::shared_ptr
   GetTargetPhraseCollectionNonCacheLEGACY(const Phrase& src) const;
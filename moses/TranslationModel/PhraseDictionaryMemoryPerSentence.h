@@ -22,6 +22,11 @@ public:
 
   void InitializeForInput(ttasksptr const& ttask);
 
+  //! the table is read from the input of each sentence
+  bool IsContextDependent() const {
+    return true;
+  }
+
   // for phrase-based model
   void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const;
 
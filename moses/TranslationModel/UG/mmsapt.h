@@ -254,6 +254,7 @@ namespace Moses
 
 
     bool ProvidesPrefixCheck() const; // return true if prefix /phrase/ check exists
+    bool IsContextDependent() const { return true; } // sampled with the bias of the task
     // bool PrefixExists(Phrase const& phrase, SamplingBias const* const bias) const;
     bool PrefixExists(ttasksptr const& ttask, Phrase const& phrase) const;
 
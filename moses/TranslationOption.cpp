@@ -48,6 +48,15 @@ TranslationOption::TranslationOption(const Range &range
 {
 }
 
+TranslationOption::TranslationOption(const TranslationOption &copy
+                                     , const Range &range)
+  : m_targetPhrase(copy.m_targetPhrase)
+  , m_inputPath(NULL)
+  , m_sourceWordsRange(range)
+  , m_futureScore(copy.m_futureScore)
+{
+}
+
 bool TranslationOption::IsCompatible(const Phrase& phrase, const std::vector<FactorType>& featuresToCheck) const
 {
   if (featuresToCheck.size() == 1) {
@@ -94,6 +94,9 @@ public:
   TranslationOption(const Range &range
                     , const TargetPhrase &targetPhrase);
 
+  /** copy of an option for another span, without its input path */
+  TranslationOption(const TranslationOption &copy, const Range &range);
+
   /** returns true if all feature types in featuresToCheck are compatible between the two phrases */
   bool IsCompatible(const Phrase& phrase, const std::vector<FactorType>& featuresToCheck) const;
 
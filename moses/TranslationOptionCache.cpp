@@ -0,0 +1,121 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+#include <cstring>
+#include "TranslationOptionCache.h"
+#include "TranslationOption.h"
+#include "InputPath.h"
+#include "Factor.h"
+
+namespace Moses
+{
+
+TranslationOptionCache *TranslationOptionCache::s_instance = NULL;
+boost::atomic<size_t> TranslationOptionCache::s_generation(0);
+
+namespace
+{
+size_t EstimateBytes(const TranslationOptionList &transOpts)
+{
+  size_t ret = 64 + sizeof(TranslationOptionList); // the cache entry and the shared count
+  TranslationOptionList::const_iterator iter;
+  for (iter = transOpts.begin(); iter != transOpts.end(); ++iter) {
+    const TranslationOption &transOpt = **iter;
+    ret += sizeof(TranslationOption*) + sizeof(TranslationOption)
+           + transOpt.GetTargetPhrase().GetSize() * sizeof(Word)
+           + transOpt.GetScoreBreakdown().Size() * sizeof(float);
+  }
+  return ret;
+}
+
+size_t FloatBits(float value)
+{
+  uint32_t ret;
+  std::memcpy(&ret, &value, sizeof(ret));
+  return ret;
+}
+}
+
+void TranslationOptionCache::Initialize(size_t capacityBytes)
+{
+  delete s_instance;
+  s_instance = capacityBytes ? new TranslationOptionCache(capacityBytes) : NULL;
+}
+
+void TranslationOptionCache::Invalidate()
+{
+  // entries of the old generation would keep their lookup counts, and
+  // admission would then turn away the new ones
+  ++s_generation;
+  if (s_instance) {
+    s_instance->m_cache.Clear();
+  }
+}
+
+TranslationOptionCache::TranslationOptionCache(size_t capacityBytes)
+  : m_cache(capacityBytes)
+{
+}
+
+TranslationOptionCache::~TranslationOptionCache()
+{
+}
+
+TranslationOptionCache::List
+TranslationOptionCache::Find(const InputPath &inputPath, size_t generation,
+                             size_t maxPartialTransOpt) const
+{
+  Key key;
+  MakeKey(inputPath, generation, maxPartialTransOpt, key);
+  List ret;
+  m_cache.Find(key, ret);
+  return ret;
+}
+
+void TranslationOptionCache::Insert(const InputPath &inputPath, size_t generation,
+                                    size_t maxPartialTransOpt,
+                                    const TranslationOptionList &transOpts) const
+{
+  TranslationOptionList *copy = new TranslationOptionList;
+  TranslationOptionList::const_iterator iter;
+  for (iter = transOpts.begin(); iter != transOpts.end(); ++iter) {
+    const TranslationOption &transOpt = **iter;
+    copy->Add(new TranslationOption(transOpt, transOpt.GetSourceWordsRange()));
+  }
+  List list(copy);
+
+  Key key;
+  MakeKey(inputPath, generation, maxPartialTransOpt, key);
+  m_cache.Insert(key, list, EstimateBytes(*copy));
+}
+
+void TranslationOptionCache::MakeKey(const InputPath &inputPath, size_t generation,
+                                     size_t maxPartialTransOpt, Key &key)
+{
+  const Phrase &phrase = inputPath.GetPhrase();
+  key.reserve(3 + phrase.GetSize() * MAX_NUM_FACTORS);
+  key.push_back(generation);
+  key.push_back(maxPartialTransOpt);
+  key.push_back(phrase.GetSize());
+  for (size_t pos = 0; pos < phrase.GetSize(); ++pos) {
+    const Word &word = phrase.GetWord(pos);
+    for (size_t factorType = 0; factorType < MAX_NUM_FACTORS; ++factorType) {
+      const Factor *factor = word[factorType];
+      key.push_back(factor ? factor->GetId() : NOT_FOUND);
+    }
+  }
+
+  // input feature scores, for confusion networks and lattices
+  const ScorePair *inputScore = inputPath.GetInputScore();
+  if (inputScore) {
+    const std::vector<float> &dense = inputScore->denseScores;
+    for (size_t i = 0; i < dense.size(); ++i) {
+      key.push_back(FloatBits(dense[i]));
+    }
+    std::map<StringPiece, float>::const_iterator iter;
+    for (iter = inputScore->sparseScores.begin(); iter != inputScore->sparseScores.end(); ++iter) {
+      key.push_back(boost::hash_range(iter->first.data(), iter->first.data() + iter->first.size()));
+      key.push_back(FloatBits(iter->second));
+    }
+  }
+}
+
+}
@@ -0,0 +1,103 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width:2  -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_TranslationOptionCache_h
+#define moses_TranslationOptionCache_h
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include "ConcurrentCache.h"
+#include "TranslationOptionList.h"
+
+namespace Moses
+{
+
+class InputPath;
+
+/** Translation options of source phrases seen in earlier sentences, shared
+ *  by all threads and bounded in size (translation-option-cache-mb).
+ *
+ *  An entry holds the options made by all decoding graphs for a source
+ *  phrase: looked up, scored in isolation and with the input scores of the
+ *  path, but not yet scored in the context of the sentence, pruned or
+ *  sorted, as that depends on the rest of the sentence.
+ *  The key is the factors of the phrase, its input scores and the options
+ *  that change what the decoding graphs make.
+ *
+ *  Entries are only valid for the weights and phrase tables they were made
+ *  with. Anything that changes either must call Invalidate(), which empties
+ *  the cache. Keys made before stay unreachable, so options still being
+ *  made with the old weights are never found.
+ *  The key holds nothing of the context of the translation task, so the
+ *  cache isn't used with phrase tables that depend on it.
+ */
+class TranslationOptionCache
+{
+public:
+  typedef boost::shared_ptr<const TranslationOptionList> List;
+
+  //! NULL if the cache is disabled
+  static const TranslationOptionCache *Instance() {
+    return s_instance;
+  }
+
+  //! create the cache, or remove it with 0 bytes. Not thread safe
+  static void Initialize(size_t capacityBytes);
+
+  static void Invalidate();
+
+  //! a key made now stays valid until the next Invalidate()
+  static size_t GetGeneration() {
+    return s_generation.load();
+  }
+
+  explicit TranslationOptionCache(size_t capacityBytes);
+  ~TranslationOptionCache();
+
+  /** the options of a source phrase as the decoding graphs of the
+   *  given generation made them, NULL if unknown */
+  List Find(const InputPath &inputPath, size_t generation,
+            size_t maxPartialTransOpt) const;
+
+  //! the options are copied, without their input path
+  void Insert(const InputPath &inputPath, size_t generation,
+              size_t maxPartialTransOpt,
+              const TranslationOptionList &transOpts) const;
+
+  ConcurrentCacheStats GetStats() const {
+    return m_cache.GetStats();
+  }
+
+protected:
+  typedef std::vector<size_t> Key;
+
+  static TranslationOptionCache *s_instance;
+  static boost::atomic<size_t> s_generation;
+
+  ConcurrentCache<Key, List> m_cache;
+
+  static void MakeKey(const InputPath &inputPath, size_t generation,
+                      size_t maxPartialTransOpt, Key &key);
+};
+
+}
+
+#endif
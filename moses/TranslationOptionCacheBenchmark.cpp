@@ -0,0 +1,142 @@
+// End to end benchmark of the translation option cache.
+// Collects the translation options of "documents" of the synthetic model that
+// repeat the same segments, as in document level traffic, without the cache
+// and with translation-option-cache-mb. Reports the time spent and checks
+// that both give the same options with the same scores.
+// TranslationOptionCacheTest checks the options one by one.
+//
+// Usage: TranslationOptionCacheBenchmark [sentences] [sentence-length] [vocab-size] [segments]
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Benchmark.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOptionCache.h"
+#include "TranslationOptionCollection.h"
+#include "TranslationTask.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace
+{
+
+// sentences are made of a few segments that keep coming back
+vector<string> MakeSentences(size_t numSentences, size_t length,
+                             size_t vocabSize, size_t numSegments)
+{
+  unsigned int seed = 42;
+  vector<vector<string> > segments(numSegments);
+  for (size_t i = 0; i < numSegments; ++i) {
+    size_t id = Benchmark::Next(seed) % vocabSize;
+    for (size_t pos = 0; pos < 5; ++pos) {
+      segments[i].push_back(Benchmark::MakeWord("w", id));
+      id = (Benchmark::Next(seed) % 2 == 0 && id + 1 < vocabSize) ? id + 1 : Benchmark::Next(seed) % vocabSize;
+    }
+  }
+
+  vector<string> ret;
+  for (size_t i = 0; i < numSentences; ++i) {
+    string sentence;
+    size_t words = 0;
+    while (words < length) {
+      const vector<string> &segment = segments[Benchmark::Next(seed) % numSegments];
+      for (size_t pos = 0; pos < segment.size() && words < length; ++pos, ++words) {
+        if (words) sentence += " ";
+        sentence += segment[pos];
+      }
+    }
+    ret.push_back(sentence);
+  }
+  return ret;
+}
+
+struct Result {
+  double seconds;
+  size_t options;
+  double totalScore;
+};
+
+Result Collect(const vector<string> &sentences)
+{
+  Result ret = { 0, 0, 0 };
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    AllOptions::ptr opts(new AllOptions(*StaticData::Instance().options()));
+    boost::shared_ptr<Sentence> sentence(new Sentence(opts, i, sentences[i]));
+    ttasksptr ttask = TranslationTask::create(sentence);
+
+    double begin = util::WallTime();
+    boost::scoped_ptr<TranslationOptionCollection> transOptColl(sentence->CreateTranslationOptionCollection(ttask));
+    transOptColl->CreateTranslationOptions();
+    ret.seconds += util::WallTime() - begin;
+
+    const InputPathList &inputPaths = transOptColl->GetInputPaths();
+    BOOST_FOREACH(const InputPath *inputPath, inputPaths) {
+      const Range &range = inputPath->GetWordsRange();
+      const TranslationOptionList *transOpts
+        = transOptColl->GetTranslationOptionList(range.GetStartPos(), range.GetEndPos());
+      if (transOpts == NULL) continue;
+      BOOST_FOREACH(const TranslationOption *transOpt, *transOpts) {
+        ++ret.options;
+        ret.totalScore += transOpt->GetFutureScore();
+      }
+    }
+  }
+  return ret;
+}
+
+bool Same(const Result &a, const Result &b)
+{
+  return a.options == b.options
+         && std::fabs(a.totalScore - b.totalScore) <= 1e-4 * std::fabs(a.totalScore);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  size_t numSentences = argc > 1 ? atoi(argv[1]) : 200;
+  size_t length = argc > 2 ? atoi(argv[2]) : 30;
+  size_t vocabSize = argc > 3 ? atoi(argv[3]) : 2000;
+  size_t numSegments = argc > 4 ? atoi(argv[4]) : 50;
+
+  Benchmark::SyntheticModel::Config config;
+  config.vocabSize = vocabSize;
+  config.translationsPerWord = 20;
+  config.translationsPerPair = 10;
+  Benchmark::SyntheticModel model("transopt-bench", config);
+  if (!model.Load(argv[0])) {
+    return 1;
+  }
+
+  vector<string> sentences = MakeSentences(numSentences, length, vocabSize, numSegments);
+
+  // the first pass fills the cache, the second one reads it
+  TranslationOptionCache::Initialize(0);
+  Result uncached = Collect(sentences);
+  TranslationOptionCache::Initialize(256 << 20);
+  Result cold = Collect(sentences);
+  Result warm = Collect(sentences);
+
+  cout << "options                 " << uncached.options << endl
+       << "no cache (s)            " << uncached.seconds << endl
+       << "cache, first pass (s)   " << cold.seconds << endl
+       << "cache, second pass (s)  " << warm.seconds << endl
+       << "cache                   " << TranslationOptionCache::Instance()->GetStats() << endl;
+  if (!Same(uncached, cold) || !Same(uncached, warm)) {
+    cerr << "Cached options differ: scores " << uncached.totalScore << " " << cold.totalScore
+         << " " << warm.totalScore << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,172 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2010- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+// a test program of its own, it loads the made up model into StaticData
+#define BOOST_TEST_MODULE TranslationOptionCache
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Benchmark.h"
+#include "InputPath.h"
+#include "Sentence.h"
+#include "StaticData.h"
+#include "TranslationOption.h"
+#include "TranslationOptionCache.h"
+#include "TranslationOptionCollection.h"
+#include "TranslationTask.h"
+#include "FF/WordPenaltyProducer.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+//! loaded into StaticData by the first test, which can be done only once
+const Benchmark::SyntheticModel &Model()
+{
+  static Benchmark::SyntheticModel *model = NULL;
+  if (model == NULL) {
+    Benchmark::SyntheticModel::Config config;
+    config.vocabSize = 50;
+    config.translationsPerPair = 3;
+    model = new Benchmark::SyntheticModel("transopt-cache-test", config);
+    BOOST_REQUIRE(model->Load(boost::unit_test::framework::master_test_suite().argv[0]));
+  }
+  return *model;
+}
+
+//! the options of every span, printed with their scores
+typedef map<pair<size_t, size_t>, vector<string> > Options;
+
+Options Collect(const string &text, XmlInputType xmlPolicy = XmlPassThrough)
+{
+  boost::shared_ptr<AllOptions> opts(new AllOptions(*StaticData::Instance().options()));
+  opts->input.xml_policy = xmlPolicy;
+  boost::shared_ptr<Sentence> sentence(new Sentence(opts, 0, text));
+  ttasksptr ttask = TranslationTask::create(sentence);
+  boost::scoped_ptr<TranslationOptionCollection> transOptColl(sentence->CreateTranslationOptionCollection(ttask));
+  transOptColl->CreateTranslationOptions();
+
+  Options ret;
+  const InputPathList &inputPaths = transOptColl->GetInputPaths();
+  for (InputPathList::const_iterator iter = inputPaths.begin(); iter != inputPaths.end(); ++iter) {
+    const Range &range = (*iter)->GetWordsRange();
+    const TranslationOptionList *transOpts
+      = transOptColl->GetTranslationOptionList(range.GetStartPos(), range.GetEndPos());
+    if (transOpts == NULL) continue;
+    vector<string> &printed = ret[make_pair(range.GetStartPos(), range.GetEndPos())];
+    for (size_t i = 0; i < transOpts->size(); ++i) {
+      ostringstream out;
+      out << *transOpts->Get(i);
+      printed.push_back(out.str());
+    }
+    sort(printed.begin(), printed.end());
+  }
+  return ret;
+}
+
+void CheckSame(const Options &expected, const Options &actual)
+{
+  BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+  Options::const_iterator e = expected.begin(), a = actual.begin();
+  for (; e != expected.end(); ++e, ++a) {
+    BOOST_CHECK(e->first == a->first);
+    BOOST_CHECK_EQUAL_COLLECTIONS(e->second.begin(), e->second.end(),
+                                  a->second.begin(), a->second.end());
+  }
+}
+
+const size_t cacheBytes = 16 << 20;
+
+}
+
+BOOST_AUTO_TEST_CASE(cached_equals_uncached)
+{
+  unsigned int seed = 1;
+  vector<string> sentences;
+  for (size_t i = 0; i < 5; ++i) {
+    sentences.push_back(Model().MakeSentence(12, seed));
+  }
+
+  TranslationOptionCache::Initialize(0);
+  vector<Options> uncached;
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    uncached.push_back(Collect(sentences[i]));
+  }
+
+  // the first pass fills the cache, the second one reads it
+  TranslationOptionCache::Initialize(cacheBytes);
+  for (size_t pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < sentences.size(); ++i) {
+      CheckSame(uncached[i], Collect(sentences[i]));
+    }
+  }
+  ConcurrentCacheStats stats = TranslationOptionCache::Instance()->GetStats();
+  BOOST_CHECK(stats.hits > 0);
+  BOOST_CHECK(stats.entries > 0);
+  TranslationOptionCache::Initialize(0);
+}
+
+BOOST_AUTO_TEST_CASE(xml_options)
+{
+  Model();
+  const string sentence = "w1 <x translation=\"t7\">w2</x> w3 w4";
+  TranslationOptionCache::Initialize(0);
+  Options uncached = Collect(sentence, XmlInclusive);
+  // the xml option and those of the phrase table
+  BOOST_CHECK(uncached[make_pair(1, 1)].size() > 1);
+
+  TranslationOptionCache::Initialize(cacheBytes);
+  for (size_t pass = 0; pass < 2; ++pass) {
+    CheckSame(uncached, Collect(sentence, XmlInclusive));
+  }
+  TranslationOptionCache::Initialize(0);
+}
+
+BOOST_AUTO_TEST_CASE(weight_change)
+{
+  Model();
+  const string sentence = "w1 w2 w3 w4 w5";
+  const WordPenaltyProducer &wordPenalty = WordPenaltyProducer::Instance();
+  float weight = StaticData::Instance().GetWeight(&wordPenalty);
+
+  TranslationOptionCache::Initialize(cacheBytes);
+  Options before = Collect(sentence);
+  BOOST_REQUIRE(TranslationOptionCache::Instance()->GetStats().entries > 0);
+
+  StaticData::InstanceNonConst().SetWeight(&wordPenalty, weight + 1);
+  BOOST_CHECK_EQUAL(TranslationOptionCache::Instance()->GetStats().entries, 0);
+  Options cached = Collect(sentence);
+
+  TranslationOptionCache::Initialize(0);
+  Options uncached = Collect(sentence);
+  CheckSame(uncached, cached);
+  BOOST_CHECK(before != cached);
+
+  StaticData::InstanceNonConst().SetWeight(&wordPenalty, weight);
+}
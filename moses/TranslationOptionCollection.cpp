@@ -42,6 +42,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "util/exception.hh"
 
 #include <boost/foreach.hpp>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
 using namespace std;
 
 namespace Moses
@@ -332,6 +334,20 @@ CalcEstimatedScore()
 void
 TranslationOptionCollection::
 CreateTranslationOptions()
+{
+  CreateTranslationOptionsFromDecodeGraphs();
+  ProcessUnknownWord();
+  EvaluateWithSourceContext();
+  VERBOSE(3,"Translation Option Collection\n " << *this << endl);
+  Prune();
+  Sort();
+  CalcEstimatedScore(); // future score matrix
+  CacheLexReordering(); // Cached lex reodering costs
+}
+
+void
+TranslationOptionCollection::
+CreateTranslationOptionsFromDecodeGraphs()
 {
   // loop over all substrings of the source sentence, look them up
   // in the phraseDictionary (which is the- possibly filtered-- phrase
@@ -345,6 +361,15 @@ CreateTranslationOptions()
   // length of the sentence
   const size_t size = m_source.GetSize();
 
+  // spans are only shared out between threads when there are enough of them
+  const size_t minParallelRanges = 16;
+#ifdef WITH_THREADS
+  const bool parallel = StaticData::Instance().GetTranslationOptionThreadPool()
+                        && CanCreateRangesInParallel();
+#else
+  const bool parallel = false;
+#endif
+
   // loop over all decoding graphs, each generates translation options
   for (size_t gidx = 0 ; gidx < decodeGraphList.size() ; gidx++) {
     if (decodeGraphList.size() > 1)
@@ -352,6 +377,7 @@ CreateTranslationOptions()
 
     const DecodeGraph& dg = *decodeGraphList[gidx];
     size_t backoff = dg.GetBackoff();
+    std::vector<Range> ranges;
     // iterate over spans
     for (size_t sPos = 0 ; sPos < size; sPos++) {
       size_t maxSize = size - sPos; // don't go over end of sentence
@@ -365,17 +391,115 @@ CreateTranslationOptions()
           VERBOSE(3,"No backoff to graph " << gidx << " for span [" << sPos << ";" << ePos << "]" << endl);
           continue;
         }
-        CreateTranslationOptionsForRange(dg, sPos, ePos, true, gidx);
+        if (parallel) {
+          ranges.push_back(Range(sPos, ePos));
+        } else {
+          CreateTranslationOptionsForRange(dg, sPos, ePos, true, gidx);
+        }
+      }
+    }
+
+    if (ranges.size() >= minParallelRanges) {
+      CreateTranslationOptionsForRanges(dg, ranges, gidx);
+    } else {
+      for (size_t i = 0; i < ranges.size(); ++i) {
+        CreateTranslationOptionsForRange(dg, ranges[i].GetStartPos(), ranges[i].GetEndPos(), true, gidx);
       }
     }
   }
-  ProcessUnknownWord();
-  EvaluateWithSourceContext();
-  VERBOSE(3,"Translation Option Collection\n " << *this << endl);
-  Prune();
-  Sort();
-  CalcEstimatedScore(); // future score matrix
-  CacheLexReordering(); // Cached lex reodering costs
+}
+
+#ifdef WITH_THREADS
+/** The spans of one decoding graph, taken one by one by the decoding
+ * thread and by the helper threads that get to this group in time. Each
+ * span only adds options to its own list, in the same order as on one
+ * thread, so the result doesn't depend on who did which span.
+ */
+class TranslationOptionCollection::RangeTasks : public Task
+{
+public:
+  RangeTasks(TranslationOptionCollection &coll, const DecodeGraph &decodeGraph,
+             const std::vector<Range> &ranges, size_t graphInd)
+    : m_coll(coll)
+    , m_decodeGraph(decodeGraph)
+    , m_ranges(ranges)
+    , m_graphInd(graphInd)
+    , m_next(0)
+    , m_active(0)
+    , m_closed(false) {
+  }
+
+  //! in a helper thread
+  void Run() {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      // the decoding thread finished without us
+      if (m_closed) return;
+      ++m_active;
+    }
+    Work();
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (--m_active == 0) m_done.notify_all();
+  }
+
+  //! in the decoding thread, returns once every span is done
+  void RunAndWait() {
+    Work();
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_closed = true;
+    while (m_active) m_done.wait(lock);
+    UTIL_THROW_IF2(!m_error.empty(), m_error);
+  }
+
+private:
+  TranslationOptionCollection &m_coll;
+  const DecodeGraph &m_decodeGraph;
+  const std::vector<Range> &m_ranges;
+  size_t m_graphInd;
+  boost::atomic<size_t> m_next;
+
+  boost::mutex m_mutex;
+  boost::condition_variable m_done;
+  size_t m_active;
+  bool m_closed;
+  std::string m_error;
+
+  void Work() {
+    for (size_t i = m_next++; i < m_ranges.size(); i = m_next++) {
+      try {
+        m_coll.CreateTranslationOptionsForRange(m_decodeGraph, m_ranges[i].GetStartPos(),
+                                                m_ranges[i].GetEndPos(), true, m_graphInd);
+      } catch (const std::exception &e) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_error.empty()) m_error = e.what();
+        m_next = m_ranges.size();
+      }
+    }
+  }
+};
+#endif
+
+void
+TranslationOptionCollection::
+CreateTranslationOptionsForRanges(const DecodeGraph &decodeGraph,
+                                  const std::vector<Range> &ranges,
+                                  size_t graphInd)
+{
+#ifdef WITH_THREADS
+  ThreadPool *pool = StaticData::Instance().GetTranslationOptionThreadPool();
+  if (pool) {
+    const size_t numHelpers = StaticData::Instance().GetTranslationOptionThreadCount() - 1;
+    boost::shared_ptr<RangeTasks> tasks(new RangeTasks(*this, decodeGraph, ranges, graphInd));
+    for (size_t i = 0; i < numHelpers; ++i) {
+      pool->Submit(tasks);
+    }
+    tasks->RunAndWait();
+    return;
+  }
+#endif
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    CreateTranslationOptionsForRange(decodeGraph, ranges[i].GetStartPos(), ranges[i].GetEndPos(), true, graphInd);
+  }
 }
 
 
@@ -509,6 +633,7 @@ void TranslationOptionCollection::EvaluateTranslationOptionListWithSourceContext
   for (size_t i = 0; i < ffs.size(); ++i) {
     const FeatureFunction &ff = *ffs[i];
     if (! staticData.IsFeatureFunctionIgnored(ff)) {
+      Profiler::Scope profile(ff.GetProfilerEvent(Profiler::EvaluateTranslationOptionListWithSourceContext));
       ff.EvaluateTranslationOptionListWithSourceContext(m_source, translationOptionList);
     }
   }
@@ -649,6 +774,13 @@ GetTranslationOptionList(size_t sPos, size_t ePos) const
 void
 TranslationOptionCollection::
 GetTargetPhraseCollectionBatch()
+{
+  GetTargetPhraseCollectionBatch(m_inputPathQueue);
+}
+
+void
+TranslationOptionCollection::
+GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue)
 {
   typedef DecodeStepTranslation Tstep;
   const vector <DecodeGraph*> &dgl = StaticData::Instance().GetDecodeGraphs();
@@ -658,7 +790,8 @@ GetTargetPhraseCollectionBatch()
       const Tstep* tstep = dynamic_cast<const Tstep *>(*i);
       if (tstep) {
         const PhraseDictionary &pdict = *tstep->GetPhraseDictionaryFeature();
-        pdict.GetTargetPhraseCollectionBatch(m_ttask.lock(), m_inputPathQueue);
+        Profiler::Scope profile(pdict.GetProfilerEvent(Profiler::Lookup));
+        pdict.GetTargetPhraseCollectionBatch(m_ttask.lock(), inputPathQueue);
       }
     }
   }
@@ -114,6 +114,24 @@ protected:
   void CacheLexReordering();
 
   void GetTargetPhraseCollectionBatch();
+  void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue);
+
+  //! apply the decoding graphs to every span, the first step of CreateTranslationOptions()
+  virtual void CreateTranslationOptionsFromDecodeGraphs();
+
+  /** whether CreateTranslationOptionsForRange() of different spans may run
+   *  at the same time, see translation-option-threads. Only if it doesn't
+   *  look anything up, as phrase tables may keep per thread state */
+  virtual bool CanCreateRangesInParallel() const {
+    return false;
+  }
+
+  class RangeTasks;
+
+  //! CreateTranslationOptionsForRange() of spans of one decoding graph, shared out between threads
+  void CreateTranslationOptionsForRanges(const DecodeGraph &decodeGraph,
+                                         const std::vector<Range> &ranges,
+                                         size_t graphInd);
 
   bool CreateTranslationOptionsForRange(
     const DecodeGraph &decodeGraph
@@ -25,8 +25,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DecodeStepTranslation.h"
 #include "FactorCollection.h"
 #include "Range.h"
+#include <algorithm>
 #include <list>
+#include <boost/unordered_set.hpp>
 #include "TranslationTask.h"
+#include "TranslationModel/PhraseDictionary.h"
 
 using namespace std;
 
@@ -165,10 +168,101 @@ InputPath &TranslationOptionCollectionText::GetInputPath(size_t startPos, size_t
   return *m_inputPathMatrix[startPos][offset];
 }
 
-void TranslationOptionCollectionText::CreateTranslationOptions()
+namespace
 {
-  GetTargetPhraseCollectionBatch();
-  TranslationOptionCollection::CreateTranslationOptions();
+//! options made for one sentence can't be reused in another
+bool AnyContextDependentTable()
+{
+  const std::vector<PhraseDictionary*> &pts = PhraseDictionary::GetColl();
+  for (size_t i = 0; i < pts.size(); ++i) {
+    if (pts[i]->IsContextDependent()) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+void TranslationOptionCollectionText::CreateTranslationOptionsFromDecodeGraphs()
+{
+  const TranslationOptionCache *cache = TranslationOptionCache::Instance();
+  // the cached scores are only right for the default weights, and the key
+  // holds nothing of the context of the sentence
+  if (cache && !StaticData::Instance().GetHasAlternateWeightSettings()
+      && !AnyContextDependentTable()) {
+    CreateTranslationOptionsFromCache(*cache);
+  } else {
+    GetTargetPhraseCollectionBatch();
+    TranslationOptionCollection::CreateTranslationOptionsFromDecodeGraphs();
+  }
+}
+
+/** the options of spans seen in earlier sentences are copied from the
+ * cache. Only the other spans are looked up, with their prefixes as the
+ * phrase tables continue the lookup of a span from its prefix. Then the
+ * options of the looked up spans are added to the cache.
+ * Spans with xml options are looked up, but neither cached nor taken
+ * from the cache.
+ */
+void TranslationOptionCollectionText::CreateTranslationOptionsFromCache(const TranslationOptionCache &cache)
+{
+  size_t generation = TranslationOptionCache::GetGeneration();
+  size_t size = m_source.GetSize();
+
+  m_cachedTransOpts.resize(size);
+  for (size_t startPos = 0; startPos < size; ++startPos) {
+    m_cachedTransOpts[startPos].resize(std::min(size - startPos, m_max_phrase_length));
+  }
+
+  InputPathList misses;
+  boost::unordered_set<const InputPath*> lookup;
+  InputPathList::const_iterator iter;
+  for (iter = m_inputPathQueue.begin(); iter != m_inputPathQueue.end(); ++iter) {
+    const InputPath *inputPath = *iter;
+    const Range &range = inputPath->GetWordsRange();
+    if (range.GetNumWordsCovered() > m_max_phrase_length) {
+      continue;
+    }
+
+    // the phrase table options of spans with xml options depend on the
+    // xml policy, so they are always looked up
+    if (!HasXmlOptionsOverlappingRange(range.GetStartPos(), range.GetEndPos())) {
+      TranslationOptionCache::List cached
+        = cache.Find(*inputPath, generation, max_partial_trans_opt);
+      if (cached) {
+        m_cachedTransOpts[range.GetStartPos()][range.GetNumWordsCovered() - 1] = cached;
+        continue;
+      }
+      misses.push_back(*iter);
+    }
+
+    while (inputPath && lookup.insert(inputPath).second) {
+      inputPath = inputPath->GetPrevPath();
+    }
+  }
+
+  // look up in the original order, prefixes first
+  InputPathList inputPathQueue;
+  for (iter = m_inputPathQueue.begin(); iter != m_inputPathQueue.end(); ++iter) {
+    if (lookup.count(*iter)) {
+      inputPathQueue.push_back(*iter);
+    }
+  }
+  GetTargetPhraseCollectionBatch(inputPathQueue);
+
+  TranslationOptionCollection::CreateTranslationOptionsFromDecodeGraphs();
+
+  // spans without options aren't cached, they might still get some from
+  // ProcessUnknownWord(), without the table limit
+  for (iter = misses.begin(); iter != misses.end(); ++iter) {
+    const InputPath &inputPath = **iter;
+    const Range &range = inputPath.GetWordsRange();
+    const TranslationOptionList *transOpts
+      = GetTranslationOptionList(range.GetStartPos(), range.GetEndPos());
+    if (transOpts && transOpts->size()) {
+      cache.Insert(inputPath, generation, max_partial_trans_opt, *transOpts);
+    }
+  }
 }
 
 /** create translation options that exactly cover a specific input span.
@@ -187,6 +281,24 @@ CreateTranslationOptionsForRange
 {
   InputPath &inputPath = GetInputPath(startPos, endPos);
 
+  // the cached options are from all decoding graphs
+  if (adhereTableLimit && startPos < m_cachedTransOpts.size()
+      && endPos - startPos < m_cachedTransOpts[startPos].size()) {
+    const TranslationOptionCache::List &cached = m_cachedTransOpts[startPos][endPos - startPos];
+    if (cached) {
+      if (graphInd == 0) {
+        Range range(startPos, endPos);
+        TranslationOptionList::const_iterator iter;
+        for (iter = cached->begin(); iter != cached->end(); ++iter) {
+          TranslationOption *transOpt = new TranslationOption(**iter, range);
+          transOpt->SetInputPath(inputPath);
+          Add(transOpt);
+        }
+      }
+      return true;
+    }
+  }
+
   return
     TranslationOptionCollection::
     CreateTranslationOptionsForRange
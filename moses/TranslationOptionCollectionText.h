@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define moses_TranslationOptionCollectionText_h
 
 #include "TranslationOptionCollection.h"
+#include "TranslationOptionCache.h"
 #include "InputPath.h"
 #include <map>
 #include <vector>
@@ -42,9 +43,18 @@ public:
 
 protected:
   InputPathMatrix	m_inputPathMatrix; /*< contains translation options */
+  std::vector< std::vector<TranslationOptionCache::List> > m_cachedTransOpts; /*< options of spans found in the TranslationOptionCache */
 
   InputPath &GetInputPath(size_t startPos, size_t endPos);
 
+  void CreateTranslationOptionsFromDecodeGraphs();
+  void CreateTranslationOptionsFromCache(const TranslationOptionCache &cache);
+
+  //! the phrase tables are looked up in advance, by GetTargetPhraseCollectionBatch()
+  bool CanCreateRangesInParallel() const {
+    return true;
+  }
+
 public:
   void ProcessUnknownWord(size_t sourcePos);
 
@@ -55,8 +65,6 @@ public:
   bool ViolatesXmlOptionsConstraint(size_t startPosition, size_t endPosition, TranslationOption *transOpt) const;
   void CreateXmlOptionsForRange(size_t startPosition, size_t endPosition);
 
-  void CreateTranslationOptions();
-
   bool CreateTranslationOptionsForRange(const DecodeGraph &decodeStepList
                                         , size_t startPosition
                                         , size_t endPosition
@@ -147,6 +147,53 @@ BOOST_AUTO_TEST_CASE(positions)
 
 }
 
+BOOST_AUTO_TEST_CASE(edges)
+{
+  Bitmap wbm(10);
+  wbm.SetValue(2,true);
+  wbm.SetValue(7,true);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheLeftOf(0), 0);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheLeftOf(2), 0);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheLeftOf(5), 3);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheRightOf(3), 6);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheRightOf(8), 9);
+  BOOST_CHECK_EQUAL(wbm.GetEdgeToTheRightOf(9), 9);
+  BOOST_CHECK(wbm.Overlap(Range(1,2)));
+  BOOST_CHECK(!wbm.Overlap(Range(3,6)));
+  BOOST_CHECK(wbm.Overlap(Range(3,9)));
+}
+
+// sentences longer than a block, and longer than the inline blocks
+BOOST_AUTO_TEST_CASE(long_sentences)
+{
+  const size_t sizes[] = { 63, 64, 65, 200, 256, 257, 1000 };
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    size_t size = sizes[s];
+    Bitmap empty(size);
+    Bitmap wbm(empty, Range(0, size - 2));
+    BOOST_CHECK_EQUAL(wbm.GetNumWordsCovered(), size - 1);
+    BOOST_CHECK_EQUAL(wbm.GetFirstGapPos(), size - 1);
+    BOOST_CHECK_EQUAL(wbm.GetLastGapPos(), size - 1);
+    BOOST_CHECK_EQUAL(wbm.GetLastPos(), size - 2);
+    BOOST_CHECK_EQUAL(wbm.GetEdgeToTheRightOf(size - 1), size - 1);
+
+    Bitmap wbm2(empty, Range(size / 2, size - 1));
+    BOOST_CHECK_EQUAL(wbm2.GetFirstGapPos(), 0);
+    BOOST_CHECK_EQUAL(wbm2.GetLastGapPos(), size / 2 - 1);
+    BOOST_CHECK_EQUAL(wbm2.GetEdgeToTheRightOf(0), size / 2 - 1);
+    BOOST_CHECK_EQUAL(wbm2.GetEdgeToTheLeftOf(size / 2 - 1), 0);
+
+    Bitmap full(wbm2, Range(0, size / 2 - 1));
+    BOOST_CHECK(full.IsComplete());
+    BOOST_CHECK_EQUAL(full.GetFirstGapPos(), NOT_FOUND);
+    BOOST_CHECK_EQUAL(full.GetLastGapPos(), NOT_FOUND);
+
+    Bitmap copy(wbm2);
+    BOOST_CHECK(copy == wbm2);
+    BOOST_CHECK_EQUAL(copy.hash(), wbm2.hash());
+    BOOST_CHECK(copy != wbm);
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -1,4 +1,5 @@
 // -*- mode: c++; indent-tabs-mode: nil; tab-width: 2 -*-
+#include <algorithm>
 #include "CubePruningOptions.h"
 
 namespace Moses 
@@ -10,6 +11,7 @@ namespace Moses
     , diversity(DEFAULT_CUBE_PRUNING_DIVERSITY)
     , lazy_scoring(false)
     , deterministic_search(false)
+    , batch_size(1)
   {}
 
   bool
@@ -22,6 +24,8 @@ namespace Moses
 		       DEFAULT_CUBE_PRUNING_DIVERSITY);
     param.SetParameter(lazy_scoring, "cube-pruning-lazy-scoring", false);
     param.SetParameter(deterministic_search, "cube-pruning-deterministic-search", false);
+    param.SetParameter(batch_size, "cube-pruning-batch-size", size_t(1));
+    if (batch_size == 0) batch_size = 1;
     return true;
   }
 
@@ -37,6 +41,10 @@ namespace Moses
       
       si = params.find("cube-pruning-diversity");
       if (si != params.end()) diversity = xmlrpc_c::value_int(si->second);
+
+      si = params.find("cube-pruning-batch-size");
+      if (si != params.end()) 
+        batch_size = std::max(1, int(xmlrpc_c::value_int(si->second)));
       
       si = params.find("cube-pruning-lazy-scoring");
       if (si != params.end())
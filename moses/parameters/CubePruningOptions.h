@@ -13,6 +13,7 @@ namespace Moses
     size_t  diversity;
     bool lazy_scoring;
     bool deterministic_search;
+    size_t  batch_size; // hypotheses popped and scored together, 1 is exact
 
     bool init(Parameter const& param);
     CubePruningOptions(Parameter const& param);
@@ -10,6 +10,7 @@ namespace Moses
     , stack_size(DEFAULT_MAX_HYPOSTACK_SIZE)
     , stack_diversity(0)
     , disable_discarding(false)
+    , incremental_pruning(false)
     , max_phrase_length(DEFAULT_MAX_PHRASE_LENGTH)
     , max_trans_opt_per_cov(DEFAULT_MAX_TRANS_OPT_SIZE)
     , max_partial_trans_opt(DEFAULT_MAX_PART_TRANS_OPT_SIZE)
@@ -50,6 +51,7 @@ namespace Moses
 
     param.SetParameter(consensus, "consensus-decoding", false);
     param.SetParameter(disable_discarding, "disable-discarding", false);
+    param.SetParameter(incremental_pruning, "incremental-stack-pruning", false);
     
     // transformation to log of a few scores
     beam_width = TransformScore(beam_width);
@@ -0,0 +1,28 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width: -*-
+#include <sstream>
+#include "Profile.h"
+#include "moses/Profiler.h"
+
+namespace MosesServer
+{
+  Profile::
+  Profile()
+  { 
+    this->_signature = "s:";
+    this->_help = "Time spent and calls made by each feature function, as JSON";
+  }
+  
+  void 
+  Profile::
+  execute(xmlrpc_c::paramList const& paramList,
+	  xmlrpc_c::value *   const  retvalP)
+  {
+    if (!Moses::Profiler::IsEnabled())
+      throw xmlrpc_c::fault("Profiling is off, start the server with -profile-file",
+                            xmlrpc_c::fault::CODE_UNSPECIFIED);
+    std::ostringstream out;
+    Moses::Profiler::WriteJson(out);
+    *retvalP = xmlrpc_c::value_string(out.str());
+  }
+  
+}
@@ -0,0 +1,20 @@
+// -*- mode: c++; indent-tabs-mode: nil; tab-width: -*-
+#pragma once
+#include <xmlrpc-c/base.hpp>
+#include <xmlrpc-c/registry.hpp>
+#include <xmlrpc-c/server_abyss.hpp>
+namespace MosesServer
+{
+  //! the Profiler counts so far, as JSON. Needs profile-file
+  class
+  Profile : public xmlrpc_c::method
+  {
+  public:
+    Profile();
+
+    void execute(xmlrpc_c::paramList const& paramList,
+		 xmlrpc_c::value *   const  retvalP);
+    
+  };
+  
+}
@@ -0,0 +1,136 @@
+/*
+ * BatchPipeline.cpp
+ *
+ */
+#include <boost/thread/locks.hpp>
+#include "BatchPipeline.h"
+#include "System.h"
+#include "TranslationTask.h"
+#include "legacy/OutputCollector.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+BatchPipeline::BatchPipeline(System &system, ThreadPool &pool, std::istream &inStream)
+  :m_system(system)
+  ,m_pool(pool)
+  ,m_inStream(inStream)
+  ,m_queueSize(system.batchQueueSize)
+  ,m_maxPending(system.batchMaxPending)
+  ,m_numRead(0)
+  ,m_numDecoded(0)
+  ,m_readBlockedTime(0)
+{
+  size_t numThreads = system.options.server.numThreads;
+  if (m_queueSize == 0) {
+    m_queueSize = 4 * numThreads;
+  }
+  // must at least cover every sentence that can be queued or running,
+  // otherwise the decoder threads would be starved
+  if (m_maxPending < m_queueSize + numThreads) {
+    m_maxPending = m_queueSize + numThreads;
+  }
+  m_pool.SetQueueLimit(m_queueSize);
+}
+
+void BatchPipeline::Run()
+{
+  m_timer.start();
+
+  // the calling thread reads, the pool decodes and the collector writes
+  Read();
+
+  m_pool.Stop(true);
+  m_timer.stop();
+}
+
+void BatchPipeline::Read()
+{
+  const OutputCollector &writer = *m_system.bestCollector;
+  Timer blocked;
+
+  long translationId = 0;
+  string line;
+  while (getline(m_inStream, line)) {
+    // back-pressure. Wait for the writer before reading too far ahead
+    int minWritten = translationId - m_maxPending + 1;
+    if (writer.GetNumWritten() < minWritten) {
+      blocked.start();
+      writer.WaitUntilWritten(minWritten);
+      blocked.stop();
+    }
+
+    boost::shared_ptr<Task> task(new BatchTask(*this, m_system, line, translationId));
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      ++m_numRead;
+    }
+
+    // blocks while the decoder queue is full
+    m_pool.Submit(task);
+    ++translationId;
+  }
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_readBlockedTime = blocked.get_elapsed_time();
+}
+
+void BatchPipeline::Decoded()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  ++m_numDecoded;
+}
+
+void BatchPipeline::Report(std::ostream &out) const
+{
+  int numWritten = m_system.bestCollector->GetNumWritten();
+  double elapsed = m_timer.get_elapsed_time();
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  out << "Batch pipeline: read=" << m_numRead
+      << " decoded=" << m_numDecoded
+      << " written=" << numWritten
+      << " queue-size=" << m_queueSize
+      << " max-pending=" << m_maxPending
+      << " reader-blocked=" << m_readBlockedTime << "s"
+      << " elapsed=" << elapsed << "s";
+  if (elapsed > 0) {
+    out << " sentences/s=" << (numWritten / elapsed);
+  }
+  out << endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+BatchTask::BatchTask(BatchPipeline &pipeline, System &system,
+                     const std::string &line, long translationId)
+  :m_pipeline(pipeline)
+  ,m_system(system)
+  ,m_line(line)
+  ,m_translationId(translationId)
+{
+}
+
+size_t BatchTask::GetCost() const
+{
+  size_t ret = 0;
+  bool inWord = false;
+  for (size_t i = 0; i < m_line.size(); ++i) {
+    bool space = m_line[i] == ' ' || m_line[i] == '\t';
+    if (!space && !inWord) {
+      ++ret;
+    }
+    inWord = !space;
+  }
+  return ret;
+}
+
+void BatchTask::Run()
+{
+  TranslationTask task(m_system, m_line, m_translationId);
+  task.Run();
+  m_pipeline.Decoded();
+}
+
+}
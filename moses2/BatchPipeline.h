@@ -0,0 +1,69 @@
+/*
+ * BatchPipeline.h
+ *
+ *  Streaming batch decoding: reader -> decoder pool -> ordered writer.
+ *  Only a bounded number of sentences are held in memory at any time,
+ *  regardless of the size of the input.
+ */
+#pragma once
+#include <iostream>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "legacy/ThreadPool.h"
+#include "legacy/Timer.h"
+
+namespace Moses2
+{
+class System;
+
+class BatchPipeline
+{
+public:
+  BatchPipeline(System &system, ThreadPool &pool, std::istream &inStream);
+
+  //! read, decode and write the whole input. Returns when everything is written
+  void Run();
+
+  //! called by decoder threads when a sentence has been decoded
+  void Decoded();
+
+  void Report(std::ostream &out) const;
+
+protected:
+  System &m_system;
+  ThreadPool &m_pool;
+  std::istream &m_inStream;
+
+  size_t m_queueSize; // max sentences waiting for a decoder thread
+  size_t m_maxPending; // max sentences read but not yet written
+
+  Timer m_timer;
+  mutable boost::mutex m_mutex;
+  long m_numRead, m_numDecoded;
+  double m_readBlockedTime; // time the reader spent waiting for the writer
+
+  void Read();
+};
+
+/** Decoding stage. Holds only the input line until a thread picks it up;
+ * the Manager is created in the decoder thread.
+ */
+class BatchTask: public Task
+{
+public:
+  BatchTask(BatchPipeline &pipeline, System &system, const std::string &line,
+            long translationId);
+  virtual void Run();
+
+  //! number of words
+  virtual size_t GetCost() const;
+
+protected:
+  BatchPipeline &m_pipeline;
+  System &m_system;
+  std::string m_line;
+  long m_translationId;
+};
+
+}
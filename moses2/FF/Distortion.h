@@ -46,6 +46,10 @@ public:
                                    const SCFG::Hypothesis &hypo, int featureID, Scores &scores,
                                    FFState &state) const;
 
+  virtual bool IsThreadSafeWhenApplied() const {
+    return true;
+  }
+
 protected:
   SCORE CalculateDistortionScore(const Range &prev, const Range &curr,
                                  const int FirstGap) const;
@@ -20,6 +20,7 @@ FeatureFunction::FeatureFunction(size_t startInd, const std::string &line)
   :m_startInd(startInd)
   ,m_numScores(1)
   ,m_PhraseTableInd(NOT_FOUND)
+  ,m_profilerEvent(Profiler::MaxEvents)
   ,m_tuneable(true)
 {
   ParseLine(line);
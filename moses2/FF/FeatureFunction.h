@@ -12,6 +12,7 @@
 #include <vector>
 #include "../TypeDef.h"
 #include "../Phrase.h"
+#include "../Profiler.h"
 
 namespace Moses2
 {
@@ -99,10 +100,24 @@ public:
   virtual void CleanUpAfterSentenceProcessing() const {
   }
 
+  void SetProfilerEvent(size_t val) {
+    m_profilerEvent = val;
+  }
+  //! where the profiler counts the given call of this feature
+  size_t GetProfilerEvent(Profiler::FeatureFunctionCall call) const {
+    return m_profilerEvent + call;
+  }
+
+  //! false if this feature has no cache
+  virtual bool GetCacheStats(Profiler::CacheStats &stats) const {
+    return false;
+  }
+
 protected:
   size_t m_startInd;
   size_t m_numScores;
   size_t m_PhraseTableInd;
+  size_t m_profilerEvent;
   std::string m_name;
   std::vector<std::vector<std::string> > m_args;
   bool m_tuneable;
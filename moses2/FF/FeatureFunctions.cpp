@@ -69,6 +69,7 @@ void FeatureFunctions::Create()
   BOOST_FOREACH(const std::string &line, *ffParams) {
     //cerr << "line=" << line << endl;
     FeatureFunction *ff = Create(line);
+    ff->SetProfilerEvent(Profiler::RegisterFeatureFunction());
 
     m_featureFunctions.push_back(ff);
 
@@ -183,6 +184,7 @@ void FeatureFunctions::EvaluateInIsolation(MemPool &pool, const System &system,
   SCORE estimatedScore = 0;
 
   BOOST_FOREACH(const FeatureFunction *ff, m_featureFunctions) {
+    Profiler::Scope profile(ff->GetProfilerEvent(Profiler::EvaluateInIsolation));
     Scores& scores = targetPhrase.GetScores();
     ff->EvaluateInIsolation(pool, system, source, targetPhrase, scores, estimatedScore);
   }
@@ -199,6 +201,7 @@ void FeatureFunctions::EvaluateInIsolation(
   SCORE estimatedScore = 0;
 
   BOOST_FOREACH(const FeatureFunction *ff, m_featureFunctions) {
+    Profiler::Scope profile(ff->GetProfilerEvent(Profiler::EvaluateInIsolation));
     Scores& scores = targetPhrase.GetScores();
     ff->EvaluateInIsolation(pool, system, source, targetPhrase, scores, estimatedScore);
   }
@@ -210,6 +213,7 @@ void FeatureFunctions::EvaluateAfterTablePruning(MemPool &pool,
     const TargetPhrases &tps, const Phrase<Moses2::Word> &sourcePhrase) const
 {
   BOOST_FOREACH(const FeatureFunction *ff, m_featureFunctions) {
+    Profiler::Scope profile(ff->GetProfilerEvent(Profiler::EvaluateAfterTablePruning));
     ff->EvaluateAfterTablePruning(pool, tps, sourcePhrase);
   }
 }
@@ -218,13 +222,22 @@ void FeatureFunctions::EvaluateAfterTablePruning(MemPool &pool, const SCFG::Targ
     const Phrase<SCFG::Word> &sourcePhrase) const
 {
   BOOST_FOREACH(const FeatureFunction *ff, m_featureFunctions) {
+    Profiler::Scope profile(ff->GetProfilerEvent(Profiler::EvaluateAfterTablePruning));
     ff->EvaluateAfterTablePruning(pool, tps, sourcePhrase);
   }
 }
 
 void FeatureFunctions::EvaluateWhenAppliedBatch(const Batch &batch) const
 {
-  BOOST_FOREACH(const StatefulFeatureFunction *ff, m_statefulFeatureFunctions) {
+  EvaluateWhenAppliedBatch(batch, 0, m_statefulFeatureFunctions.size());
+}
+
+void FeatureFunctions::EvaluateWhenAppliedBatch(const Batch &batch, size_t begin, size_t end) const
+{
+  for (size_t i = begin; i < end; ++i) {
+    const StatefulFeatureFunction *ff = m_statefulFeatureFunctions[i];
+    // one call per hypothesis, as when they are scored one at a time
+    Profiler::Scope profile(ff->GetProfilerEvent(Profiler::EvaluateWhenApplied), batch.size());
     ff->EvaluateWhenAppliedBatch(m_system, batch);
   }
 }
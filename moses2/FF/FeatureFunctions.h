@@ -85,6 +85,8 @@ public:
                                  const Phrase<SCFG::Word> &sourcePhrase) const;
 
   void EvaluateWhenAppliedBatch(const Batch &batch) const;
+  //! only the stateful FFs [begin, end), in order
+  void EvaluateWhenAppliedBatch(const Batch &batch, size_t begin, size_t end) const;
 
   void CleanUpAfterSentenceProcessing() const;
 
@@ -114,7 +114,7 @@ void OpSequenceModel::EvaluateWhenApplied(const ManagerBase &mgr,
 {
   const TargetPhrase<Moses2::Word> &target = hypo.GetTargetPhrase();
   const Bitmap &bitmap = hypo.GetBitmap();
-  Bitmap myBitmap(bitmap);
+  Bitmap myBitmap(mgr.GetPool(), bitmap);
   const ManagerBase &manager = hypo.GetManager();
   const InputType &source = manager.GetInput();
   const Sentence &sourceSentence = static_cast<const Sentence&>(source);
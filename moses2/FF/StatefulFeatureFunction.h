@@ -56,6 +56,14 @@ public:
     const System &system,
     const Batch &batch) const;
 
+  //! true if different hypos of a sentence can be scored on several threads
+  //! at once, see search-threads. Only if the FF keeps no mutable state,
+  //! writes nothing but the scores and state of the hypo being scored and
+  //! allocates nothing from the manager's pools, which aren't thread-safe
+  virtual bool IsThreadSafeWhenApplied() const {
+    return false;
+  }
+
 protected:
   size_t m_statefulInd;
 
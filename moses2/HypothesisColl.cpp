@@ -21,6 +21,7 @@ namespace Moses2
 HypothesisColl::HypothesisColl(const ManagerBase &mgr)
   :m_coll(MemPoolAllocator<const HypothesisBase*>(mgr.GetPool()))
   ,m_sortedHypos(NULL)
+  ,m_heap(MemPoolAllocator<HeapEntry>(mgr.GetPool()))
 {
   m_bestScore = -std::numeric_limits<float>::infinity();
   m_worstScore = std::numeric_limits<float>::infinity();
@@ -53,8 +54,9 @@ void HypothesisColl::Add(
   ArcLists &arcLists)
 {
   size_t maxStackSize = mgr.system.options.search.stack_size;
+  bool incremental = mgr.system.options.search.incremental_pruning && maxStackSize;
 
-  if (GetSize() > maxStackSize * 2) {
+  if (!incremental && GetSize() > maxStackSize * 2) {
     //cerr << "maxStackSize=" << maxStackSize << " " << GetSize() << endl;
     PruneHypos(mgr, mgr.arcLists);
   }
@@ -91,6 +93,22 @@ void HypothesisColl::Add(
     }
   }
 
+  if (incremental) {
+    if (added.added) {
+      if (futureScore > m_bestScore) {
+        m_bestScore = futureScore;
+      }
+      PushHeap(hypo);
+      PruneIncremental(maxStackSize, hypoRecycle, arcLists, nbestSize);
+
+      float beamWidth = mgr.system.options.search.beam_width;
+      if (m_bestScore + beamWidth > m_worstScore) {
+        m_worstScore = m_bestScore + beamWidth;
+      }
+    }
+    return;
+  }
+
   // update beam variables
   if (added.added) {
     if (futureScore > m_bestScore) {
@@ -201,6 +219,66 @@ void HypothesisColl::PruneHypos(const ManagerBase &mgr, ArcLists &arcLists)
 
 }
 
+bool HypothesisColl::InColl(const HeapEntry &entry) const
+{
+  // recycled hypos may have been reused for a new hypo, possibly already in
+  // the stack under another entry
+  _HCType::const_iterator iter = m_coll.find(entry.hypo);
+  return iter != m_coll.end() && *iter == entry.hypo
+         && entry.hypo->GetFutureScore() == entry.score;
+}
+
+void HypothesisColl::PushHeap(const HypothesisBase *hypo)
+{
+  if (m_heap.size() > 2 * m_coll.size() + 64) {
+    RebuildHeap();
+    return;
+  }
+
+  HeapEntry entry = { hypo->GetFutureScore(), hypo };
+  m_heap.push_back(entry);
+  std::push_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+}
+
+void HypothesisColl::RebuildHeap()
+{
+  m_heap.clear();
+  BOOST_FOREACH(const HypothesisBase *hypo, m_coll) {
+    HeapEntry entry = { hypo->GetFutureScore(), hypo };
+    m_heap.push_back(entry);
+  }
+  std::make_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+}
+
+void HypothesisColl::PruneIncremental(size_t maxStackSize,
+                                      Recycler<HypothesisBase*> &hypoRecycle,
+                                      ArcLists &arcLists, bool nbest)
+{
+  // O(log n) per hypo dropped, rather than sorting the stack
+  while (!m_heap.empty()) {
+    bool inColl = InColl(m_heap.front());
+    if (inColl && GetSize() <= maxStackSize) {
+      break;
+    }
+
+    HypothesisBase *hypo = const_cast<HypothesisBase*>(m_heap.front().hypo);
+    std::pop_heap(m_heap.begin(), m_heap.end(), HeapOrder());
+    m_heap.pop_back();
+    if (inColl) {
+      if (nbest) {
+        arcLists.Delete(hypo);
+      }
+      Delete(hypo);
+      hypoRecycle.Recycle(hypo);
+    }
+  }
+
+  // a full stack only takes hypos better than its worst
+  if (GetSize() == maxStackSize) {
+    m_worstScore = m_heap.front().score;
+  }
+}
+
 void HypothesisColl::SortHypos(const ManagerBase &mgr, const HypothesisBase **sortedHypos) const
 {
   size_t maxStackSize = mgr.system.options.search.stack_size;
@@ -261,6 +339,7 @@ void HypothesisColl::Clear()
 {
   m_sortedHypos = NULL;
   m_coll.clear();
+  m_heap.clear();
 
   m_bestScore = -std::numeric_limits<float>::infinity();
   m_worstScore = std::numeric_limits<float>::infinity();
@@ -5,6 +5,7 @@
  *      Author: hieu
  */
 #pragma once
+#include <vector>
 #include <boost/unordered_set.hpp>
 #include "HypothesisBase.h"
 #include "MemPoolAllocator.h"
@@ -63,8 +64,29 @@ protected:
   SCORE m_bestScore;
   SCORE m_worstScore;
 
+  // for incremental-stack-pruning. The future score of each hypothesis
+  // added, worst on top. Hypos that have since been recombined away are only
+  // dropped when they get to the top
+  struct HeapEntry {
+    SCORE score;
+    const HypothesisBase *hypo;
+  };
+  struct HeapOrder {
+    bool operator()(const HeapEntry &a, const HeapEntry &b) const {
+      return a.score > b.score;
+    }
+  };
+  std::vector<HeapEntry, MemPoolAllocator<HeapEntry> > m_heap;
+
   StackAdd Add(const HypothesisBase *hypo);
 
+  bool InColl(const HeapEntry &entry) const;
+  void PushHeap(const HypothesisBase *hypo);
+  void RebuildHeap();
+  void PruneIncremental(size_t maxStackSize,
+                        Recycler<HypothesisBase*> &hypoRecycle,
+                        ArcLists &arcLists, bool nbest);
+
   void PruneHypos(const ManagerBase &mgr, ArcLists &arcLists);
   void SortHypos(const ManagerBase &mgr, const HypothesisBase **sortedHypos) const;
 
@@ -76,8 +76,8 @@ void GPULM::Load(System &system)
   cerr << "GPULM::Load" << endl;
   FactorCollection &fc = system.GetVocab();
 
-  m_bos = fc.AddFactor(BOS_, system, false);
-  m_eos = fc.AddFactor(EOS_, system, false);
+  m_bos = fc.AddFactor(BOS_, false);
+  m_eos = fc.AddFactor(EOS_, false);
 
   FactorCollection &collection = system.GetVocab();
 }
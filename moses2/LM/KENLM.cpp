@@ -85,13 +85,13 @@ private:
 class MappingBuilder: public lm::EnumerateVocab
 {
 public:
-  MappingBuilder(FactorCollection &factorCollection, System &system,
+  MappingBuilder(FactorCollection &factorCollection,
                  std::vector<lm::WordIndex> &mapping) :
-    m_factorCollection(factorCollection), m_system(system), m_mapping(mapping) {
+    m_factorCollection(factorCollection), m_mapping(mapping) {
   }
 
   void Add(lm::WordIndex index, const StringPiece &str) {
-    std::size_t factorId = m_factorCollection.AddFactor(str, m_system, false)->GetId();
+    std::size_t factorId = m_factorCollection.AddFactor(str, false)->GetId();
     if (m_mapping.size() <= factorId) {
       // 0 is <unk> :-)
       m_mapping.resize(factorId + 1);
@@ -102,7 +102,6 @@ public:
 private:
   FactorCollection &m_factorCollection;
   std::vector<lm::WordIndex> &m_mapping;
-  System &m_system;
 };
 
 /////////////////////////////////////////////////////////////////
@@ -127,18 +126,29 @@ void KENLM<Model>::Load(System &system)
 {
   FactorCollection &fc = system.GetVocab();
 
-  m_bos = fc.AddFactor(BOS_, system, false);
-  m_eos = fc.AddFactor(EOS_, system, false);
+  m_bos = fc.AddFactor(BOS_, false);
+  m_eos = fc.AddFactor(EOS_, false);
 
   lm::ngram::Config config;
   config.messages = NULL;
 
   FactorCollection &collection = system.GetVocab();
-  MappingBuilder builder(collection, system, m_lmIdLookup);
+  MappingBuilder builder(collection, m_lmIdLookup);
   config.enumerate_vocab = &builder;
   config.load_method = m_load_method;
 
-  m_ngram.reset(new Model(m_path.c_str(), config));
+  if (m_load_method == util::NUMA_REPLICATE && util::NumaNodes() > 1) {
+    // one copy per node, each allocated on its node. The vocab mapping is
+    // the same for all of them so only build it once
+    for (size_t node = 0; node < util::NumaNodes(); ++node) {
+      util::ScopedNumaPreferred preferred(node);
+      config.enumerate_vocab = node ? NULL : &builder;
+      m_replicas.push_back(boost::shared_ptr<Model>(new Model(m_path.c_str(), config)));
+    }
+    m_ngram = m_replicas[0];
+  } else {
+    m_ngram.reset(new Model(m_path.c_str(), config));
+  }
 }
 
 template<class Model>
@@ -256,33 +266,47 @@ void KENLM<Model>::EvaluateWhenApplied(const ManagerBase &mgr,
   const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
   const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
 
+  const Model &model = GetModel();
   std::size_t position = begin;
   typename Model::State aux_state;
   typename Model::State *state0 = &stateCast.state, *state1 = &aux_state;
 
-  float score = m_ngram->Score(in_state, TranslateID(hypo.GetWord(position)),
-                               *state0);
+  float score = model.Score(in_state, TranslateID(hypo.GetWord(position)),
+                            *state0);
   ++position;
   for (; position < adjust_end; ++position) {
-    score += m_ngram->Score(*state0, TranslateID(hypo.GetWord(position)),
-                            *state1);
+    score += model.Score(*state0, TranslateID(hypo.GetWord(position)),
+                         *state1);
     std::swap(state0, state1);
   }
 
+  EvaluateEnd(system, hypo, *state0, score, scores, stateCast.state);
+}
+
+template<class Model>
+void KENLM<Model>::EvaluateEnd(const System &system, const Hypothesis &hypo,
+                               const lm::ngram::State &lastState, float score,
+                               Scores &scores, lm::ngram::State &state) const
+{
+  const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
+  const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
+  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+  const Model &model = GetModel();
+
   if (hypo.GetBitmap().IsComplete()) {
     // Score end of sentence.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    score += m_ngram->FullScoreForgotState(&indices.front(), last,
-                                           m_ngram->GetVocabulary().EndSentence(), stateCast.state).prob;
+    score += model.FullScoreForgotState(&indices.front(), last,
+                                        m_ngram->GetVocabulary().EndSentence(), state).prob;
   } else if (adjust_end < end) {
     // Get state after adding a long phrase.
     std::vector<lm::WordIndex> indices(m_ngram->Order() - 1);
     const lm::WordIndex *last = LastIDs(hypo, &indices.front());
-    m_ngram->GetState(&indices.front(), last, stateCast.state);
-  } else if (state0 != &stateCast.state) {
+    model.GetState(&indices.front(), last, state);
+  } else if (&lastState != &state) {
     // Short enough phrase that we can just reuse the state.
-    stateCast.state = *state0;
+    state = lastState;
   }
 
   score = TransformLMScore(score);
@@ -309,7 +333,7 @@ void KENLM<Model>::CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScor
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -352,7 +376,7 @@ void KENLM<Model>::CalcScore(const Phrase<SCFG::Word> &phrase, float &fullScore,
   if (!phrase.GetSize()) return;
 
   lm::ngram::ChartState discarded_sadly;
-  lm::ngram::RuleScore<Model> scorer(*m_ngram, discarded_sadly);
+  lm::ngram::RuleScore<Model> scorer(GetModel(), discarded_sadly);
 
   size_t position;
   if (m_bos == phrase[0][m_factorType]) {
@@ -412,13 +436,74 @@ lm::WordIndex *KENLM<Model>::LastIDs(const Hypothesis &hypo,
   }
 }
 
+template<class Model>
+void KENLM<Model>::EvaluateWhenAppliedBatch(
+  const System &system,
+  const Batch &batch) const
+{
+  // The words of the hypos are scored a position at a time across the
+  // batch. A position only depends on the one before in the same hypo, so
+  // FullScoreBatch() looks up the n-grams of all the hypos together, one
+  // order at a time, and the cache misses overlap rather than happen one
+  // by one. Same scores and states as EvaluateWhenApplied()
+  const Model &model = GetModel();
+  const size_t size = batch.size();
+  // EvaluateWhenApplied() scores the first word even of unigram models
+  const size_t maxWords = std::max<size_t>(m_ngram->Order() - 1, 1);
+
+  std::vector<lm::ngram::State> states(size);
+  std::vector<float> scores(size, 0);
+  std::vector<size_t> hypos;
+  std::vector<lm::ngram::BatchQuery> queries;
+  std::vector<lm::ngram::State> outStates;
+  std::vector<lm::FullScoreReturn> rets;
+  for (size_t position = 0; position < maxWords; ++position) {
+    hypos.clear();
+    queries.clear();
+    for (size_t i = 0; i < size; ++i) {
+      const Hypothesis &hypo = *batch[i];
+      const Range &range = hypo.GetCurrTargetWordsRange();
+      if (!hypo.GetTargetPhrase().GetSize() || range.GetStartPos() + position > range.GetEndPos()) {
+        continue;
+      }
+      lm::ngram::BatchQuery query;
+      query.in_state = position ? &states[i]
+                       : &static_cast<const KenLMState*>(hypo.GetPrevHypo()->GetState(m_statefulInd))->state;
+      query.new_word = TranslateID(hypo.GetWord(range.GetStartPos() + position));
+      hypos.push_back(i);
+      queries.push_back(query);
+    }
+    if (queries.empty()) {
+      break;
+    }
+
+    outStates.resize(queries.size());
+    rets.resize(queries.size());
+    model.FullScoreBatch(&queries.front(), queries.size(), &outStates.front(), &rets.front());
+    for (size_t j = 0; j < hypos.size(); ++j) {
+      states[hypos[j]] = outStates[j];
+      scores[hypos[j]] += rets[j].prob;
+    }
+  }
+
+  for (size_t i = 0; i < size; ++i) {
+    Hypothesis &hypo = *batch[i];
+    KenLMState &state = static_cast<KenLMState&>(*hypo.GetState(m_statefulInd));
+    if (!hypo.GetTargetPhrase().GetSize()) {
+      state.state = static_cast<const KenLMState*>(hypo.GetPrevHypo()->GetState(m_statefulInd))->state;
+      continue;
+    }
+    EvaluateEnd(system, hypo, states[i], scores[i], hypo.GetScores(), state.state);
+  }
+}
+
 template<class Model>
 void KENLM<Model>::EvaluateWhenApplied(const SCFG::Manager &mgr,
                                        const SCFG::Hypothesis &hypo, int featureID, Scores &scores,
                                        FFState &state) const
 {
   LanguageModelChartStateKenLM &newState = static_cast<LanguageModelChartStateKenLM&>(state);
-  lm::ngram::RuleScore<Model> ruleScore(*m_ngram, newState.GetChartState());
+  lm::ngram::RuleScore<Model> ruleScore(GetModel(), newState.GetChartState());
   const SCFG::TargetPhraseImpl &target = hypo.GetTargetPhrase();
   const AlignmentInfo::NonTermIndexMap &nonTermIndexMap =
     target.GetAlignNonTerm().GetNonTermIndexMap();
@@ -525,6 +610,10 @@ FeatureFunction *ConstructKenLM(size_t startInd, const std::string &lineOrig)
         load_method = util::READ;
       } else if (value == "parallel_read") {
         load_method = util::PARALLEL_READ;
+      } else if (value == "numa_interleave") {
+        load_method = util::NUMA_INTERLEAVE;
+      } else if (value == "numa_replicate") {
+        load_method = util::NUMA_REPLICATE;
       } else {
         UTIL_THROW2("Unknown KenLM load method " << value);
       }
@@ -8,6 +8,7 @@
 #include <boost/shared_ptr.hpp>
 #include "../FF/StatefulFeatureFunction.h"
 #include "lm/model.hh"
+#include "util/numa.hh"
 #include "../legacy/Factor.h"
 #include "../legacy/Util2.h"
 #include "../Word.h"
@@ -57,6 +58,16 @@ public:
                                    const SCFG::Hypothesis &hypo, int featureID, Scores &scores,
                                    FFState &state) const;
 
+  //! scores the words of all the hypos of the batch together
+  virtual void EvaluateWhenAppliedBatch(
+    const System &system,
+    const Batch &batch) const;
+
+  //! only queries the model, which is read-only once loaded
+  virtual bool IsThreadSafeWhenApplied() const {
+    return true;
+  }
+
 protected:
   std::string m_path;
   FactorType m_factorType;
@@ -65,6 +76,16 @@ protected:
   const Factor *m_eos;
 
   boost::shared_ptr<Model> m_ngram;
+  // load=numa_replicate: a copy per NUMA node. m_ngram is the node 0 copy
+  std::vector<boost::shared_ptr<Model> > m_replicas;
+
+  //! model to query from the calling thread. Its node-local copy if replicated
+  const Model &GetModel() const {
+    if (m_replicas.empty()) {
+      return *m_ngram;
+    }
+    return *m_replicas[util::NumaNodeOfCurrentThread() % m_replicas.size()];
+  }
 
   void CalcScore(const Phrase<Moses2::Word> &phrase, float &fullScore, float &ngramScore,
                  std::size_t &oovCount) const;
@@ -76,6 +97,12 @@ protected:
     std::size_t factor = word[m_factorType]->GetId();
     return (factor >= m_lmIdLookup.size() ? 0 : m_lmIdLookup[factor]);
   }
+  //! end of sentence, the new state and the scores, once the first words
+  //! of the hypo are scored up to lastState
+  void EvaluateEnd(const System &system, const Hypothesis &hypo,
+                   const lm::ngram::State &lastState, float score,
+                   Scores &scores, lm::ngram::State &state) const;
+
   // Convert last words of hypothesis into vocab ids, returning an end pointer.
   lm::WordIndex *LastIDs(const Hypothesis &hypo, lm::WordIndex *indices) const;
 
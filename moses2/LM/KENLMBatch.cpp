@@ -61,13 +61,13 @@ struct KenLMState: public FFState {
 class MappingBuilder: public lm::EnumerateVocab
 {
 public:
-  MappingBuilder(FactorCollection &factorCollection, System &system,
+  MappingBuilder(FactorCollection &factorCollection,
                  std::vector<lm::WordIndex> &mapping) :
-    m_factorCollection(factorCollection), m_system(system), m_mapping(mapping) {
+    m_factorCollection(factorCollection), m_mapping(mapping) {
   }
 
   void Add(lm::WordIndex index, const StringPiece &str) {
-    std::size_t factorId = m_factorCollection.AddFactor(str, m_system, false)->GetId();
+    std::size_t factorId = m_factorCollection.AddFactor(str, false)->GetId();
     if (m_mapping.size() <= factorId) {
       // 0 is <unk> :-)
       m_mapping.resize(factorId + 1);
@@ -78,7 +78,6 @@ public:
 private:
   FactorCollection &m_factorCollection;
   std::vector<lm::WordIndex> &m_mapping;
-  System &m_system;
 };
 
 /////////////////////////////////////////////////////////////////
@@ -100,14 +99,14 @@ void KENLMBatch::Load(System &system)
   cerr << "KENLMBatch::Load" << endl;
   FactorCollection &fc = system.GetVocab();
 
-  m_bos = fc.AddFactor(BOS_, system, false);
-  m_eos = fc.AddFactor(EOS_, system, false);
+  m_bos = fc.AddFactor(BOS_, false);
+  m_eos = fc.AddFactor(EOS_, false);
 
   lm::ngram::Config config;
   config.messages = NULL;
 
   FactorCollection &collection = system.GetVocab();
-  MappingBuilder builder(collection, system, m_lmIdLookup);
+  MappingBuilder builder(collection, m_lmIdLookup);
   config.enumerate_vocab = &builder;
   config.load_method = m_load_method;
 
@@ -66,8 +66,8 @@ void LanguageModel::Load(System &system)
 {
   FactorCollection &fc = system.GetVocab();
 
-  m_bos = fc.AddFactor(BOS_, system, false);
-  m_eos = fc.AddFactor(EOS_, system, false);
+  m_bos = fc.AddFactor(BOS_, false);
+  m_eos = fc.AddFactor(EOS_, false);
 
   InputFileStream infile(m_path);
   size_t lineNum = 0;
@@ -99,7 +99,7 @@ void LanguageModel::Load(System &system)
 
     vector<const Factor*> factorKey(key.size());
     for (size_t i = 0; i < key.size(); ++i) {
-      factorKey[factorKey.size() - i - 1] = fc.AddFactor(key[i], system, false);
+      factorKey[factorKey.size() - i - 1] = fc.AddFactor(key[i], false);
     }
 
     m_root.insert(factorKey, LMScores(prob, backoff));
@@ -1,9 +1,12 @@
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <boost/pool/pool_alloc.hpp>
 #include "Main.h"
+#include "BatchPipeline.h"
 #include "System.h"
 #include "Phrase.h"
+#include "Profiler.h"
 #include "TranslationTask.h"
 #include "MemPoolAllocator.h"
 #include "server/Server.h"
@@ -40,6 +43,7 @@ int main(int argc, char** argv)
   //cerr << "system.numThreads=" << system.options.server.numThreads << endl;
 
   Moses2::ThreadPool pool(system.options.server.numThreads, system.cpuAffinityOffset, system.cpuAffinityOffsetIncr);
+  pool.SetLongestFirst(system.threadLongestFirst);
   //cerr << "CREATED POOL" << endl;
 
   if (params.GetParam("server")) {
@@ -80,24 +84,20 @@ void batch_run(Moses2::Parameter &params, Moses2::System &system, Moses2::Thread
 {
   istream &inStream = GetInputStream(params);
 
-  long translationId = 0;
-  string line;
-  while (getline(inStream, line)) {
-    //cerr << "line=" << line << endl;
-    boost::shared_ptr<Moses2::TranslationTask> task(new Moses2::TranslationTask(system, line, translationId));
-
-    //cerr << "START pool.Submit()" << endl;
-    pool.Submit(task);
-    //task->Run();
-    ++translationId;
-  }
-
-  pool.Stop(true);
+  Moses2::BatchPipeline pipeline(system, pool, inStream);
+  pipeline.Run();
+  pipeline.Report(cerr);
+  pool.Report(cerr);
 
   if (&inStream != &cin) {
     delete &inStream;
   }
 
+  if (!system.profileFile.empty()) {
+    ofstream profileStream(system.profileFile.c_str());
+    Moses2::Profiler::WriteJson(profileStream, system.featureFunctions);
+  }
+
   //util::PrintUsage(std::cerr);
 
 }
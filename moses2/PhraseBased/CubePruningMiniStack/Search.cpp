@@ -40,6 +40,8 @@ Search::Search(Manager &mgr) :
 
   , m_queueItemRecycler(MemPoolAllocator<QueueItem*>(mgr.GetPool()))
 
+  , m_batch(mgr.GetPool())
+
 {
 }
 
@@ -119,6 +121,12 @@ void Search::Decode(size_t stackInd)
   cerr << endl;
    */
 
+  // with lazy scoring, the queue is ordered by scores which don't include
+  // stateful FFs. Popped hypos can therefore be scored in batches without
+  // changing which hypos are popped
+  size_t batchSize = mgr.system.options.cube.lazy_scoring
+                     ? mgr.system.options.search.lm_batch_size : 0;
+
   size_t pops = 0;
   while (!m_queue.empty() && pops < mgr.system.options.cube.pop_limit) {
     // get best hypo from queue, add to stack
@@ -131,18 +139,27 @@ void Search::Decode(size_t stackInd)
     // add hypo to stack
     Hypothesis *hypo = item->hypo;
 
-    if (mgr.system.options.cube.lazy_scoring) {
-      hypo->EvaluateWhenApplied();
-    }
+    if (batchSize) {
+      m_batch.push_back(hypo);
+      if (m_batch.size() >= batchSize) {
+        EvaluateBatch();
+      }
+    } else {
+      if (mgr.system.options.cube.lazy_scoring) {
+        hypo->EvaluateWhenApplied();
+      }
 
-    //cerr << "hypo=" << *hypo << " " << hypo->GetBitmap() << endl;
-    m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+      //cerr << "hypo=" << *hypo << " " << hypo->GetBitmap() << endl;
+      m_stack.Add(hypo, hypoRecycler, mgr.arcLists);
+    }
 
     edge->CreateNext(mgr, item, m_queue, m_seenPositions, m_queueItemRecycler);
 
     ++pops;
   }
 
+  EvaluateBatch();
+
   // create hypo from every edge. Increase diversity
   if (mgr.system.options.cube.diversity) {
     while (!m_queue.empty()) {
@@ -159,6 +176,19 @@ void Search::Decode(size_t stackInd)
   }
 }
 
+void Search::EvaluateBatch()
+{
+  if (m_batch.empty()) {
+    return;
+  }
+
+  mgr.system.featureFunctions.EvaluateWhenAppliedBatch(m_batch);
+  for (size_t i = 0; i < m_batch.size(); ++i) {
+    m_stack.Add(m_batch[i], mgr.GetHypoRecycle(), mgr.arcLists);
+  }
+  m_batch.clear();
+}
+
 void Search::PostDecode(size_t stackInd)
 {
   MemPool &pool = mgr.GetPool();
@@ -50,10 +50,15 @@ protected:
 
   QueueItemRecycler m_queueItemRecycler;
 
+  // popped hypos waiting to be scored by stateful FFs. Only used with lazy
+  // scoring, see lm-batch-size
+  Batch m_batch;
+
   // CUBE PRUNING
   // decoding
   void Decode(size_t stackInd);
   void PostDecode(size_t stackInd);
+  void EvaluateBatch();
 };
 
 }
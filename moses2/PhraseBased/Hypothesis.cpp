@@ -182,6 +182,9 @@ void Hypothesis::EvaluateWhenApplied()
   const std::vector<const StatefulFeatureFunction*> &sfffs =
     GetManager().system.featureFunctions.GetStatefulFeatureFunctions();
   BOOST_FOREACH(const StatefulFeatureFunction *sfff, sfffs) {
+    // here rather than in EvaluateWhenApplied(sfff), which batches are
+    // scored with as well and count themselves
+    Profiler::Scope profile(sfff->GetProfilerEvent(Profiler::EvaluateWhenApplied));
     EvaluateWhenApplied(*sfff);
   }
 //cerr << *this << endl;
@@ -82,6 +82,7 @@ void Manager::Init()
   for (size_t i = 0; i < pts.size(); ++i) {
     const PhraseTable &pt = *pts[i];
     //cerr << "Looking up from " << pt.GetName() << endl;
+    Profiler::Scope profile(pt.GetProfilerEvent(Profiler::Lookup));
     pt.Lookup(*this, m_inputPaths);
   }
   //m_inputPaths.DeleteUnusedPaths();
@@ -124,8 +125,14 @@ void Manager::Decode()
 {
   //cerr << "Start Decode " << this << endl;
 
-  Init();
-  m_search->Decode();
+  {
+    Profiler::Scope profile(Profiler::CollectTranslationOptions);
+    Init();
+  }
+  {
+    Profiler::Scope profile(Profiler::Search);
+    m_search->Decode();
+  }
 
   //cerr << "Finished Decode " << this << endl;
 }
@@ -8,6 +8,8 @@
 #include "Search.h"
 #include <algorithm>
 #include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include "Stack.h"
 #include "../Manager.h"
 #include "../TrellisPath.h"
@@ -17,6 +19,9 @@
 #include "../../Phrase.h"
 #include "../../System.h"
 #include "../../PhraseBased/TargetPhrases.h"
+#include "../../FF/StatefulFeatureFunction.h"
+#include "../../legacy/ThreadPool.h"
+#include "../../legacy/Util2.h"
 
 using namespace std;
 
@@ -25,17 +30,88 @@ namespace Moses2
 namespace NSNormal
 {
 
+// batch size with search-threads > 1 when lm-batch-size isn't set.
+// Big enough to be worth handing out, small enough not to hold onto memory
+static const size_t PARALLEL_BATCH_SIZE = 4096;
+
+// below this, scoring isn't worth waking up other threads for
+static const size_t MIN_PARALLEL_CHUNK = 64;
+
+namespace
+{
+
+// counts down the parts of a batch scored by other threads
+class Latch
+{
+public:
+  Latch()
+    :m_count(0) {
+  }
+
+  void Add() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    ++m_count;
+  }
+
+  void Done() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (--m_count == 0) {
+      m_cond.notify_all();
+    }
+  }
+
+  void Wait() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_count) {
+      m_cond.wait(lock);
+    }
+  }
+
+protected:
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  size_t m_count;
+};
+
+// scores part of a batch with the stateful FFs [begin, end)
+class ScoreTask: public Task
+{
+public:
+  ScoreTask(const Manager &mgr, const Batch &batch, size_t begin, size_t end,
+            Latch &latch)
+    :m_mgr(mgr), m_batch(batch), m_begin(begin), m_end(end), m_latch(latch) {
+  }
+
+  virtual void Run() {
+    m_mgr.system.featureFunctions.EvaluateWhenAppliedBatch(m_batch, m_begin, m_end);
+    m_latch.Done();
+  }
+
+protected:
+  const Manager &m_mgr;
+  const Batch &m_batch;
+  size_t m_begin, m_end;
+  Latch &m_latch;
+};
+
+}
+
 Search::Search(Manager &mgr)
   :Moses2::Search(mgr)
   , m_stacks(mgr)
+  , m_batch(mgr.GetPool())
 {
-  // TODO Auto-generated constructor stub
-
+  size_t numThreads = mgr.system.options.search.search_threads;
+  if (numThreads > 1 && mgr.system.GetSearchThreadPool()) {
+    for (size_t i = 0; i < numThreads; ++i) {
+      m_chunks.push_back(new Batch(mgr.GetPool()));
+    }
+  }
 }
 
 Search::~Search()
 {
-  // TODO Auto-generated destructor stub
+  RemoveAllInColl(m_chunks);
 }
 
 void Search::Decode()
@@ -83,6 +159,8 @@ void Search::Decode(size_t stackInd)
       Extend(*static_cast<const Hypothesis*>(hypo), *static_cast<const InputPath*>(path));
     }
   }
+
+  EvaluateBatch();
 }
 
 void Search::Extend(const Hypothesis &hypo, const InputPath &path)
@@ -128,6 +206,16 @@ void Search::Extend(const Hypothesis &hypo, const TargetPhraseImpl &tp,
 {
   Hypothesis *newHypo = Hypothesis::Create(mgr.GetSystemPool(), mgr);
   newHypo->Init(mgr, hypo, path, tp, newBitmap, estimatedScore);
+
+  size_t batchSize = GetBatchSize();
+  if (batchSize) {
+    m_batch.push_back(newHypo);
+    if (m_batch.size() >= batchSize) {
+      EvaluateBatch();
+    }
+    return;
+  }
+
   newHypo->EvaluateWhenApplied();
 
   m_stacks.Add(newHypo, mgr.GetHypoRecycle(), mgr.arcLists);
@@ -137,6 +225,81 @@ void Search::Extend(const Hypothesis &hypo, const TargetPhraseImpl &tp,
 
 }
 
+void Search::EvaluateBatch()
+{
+  if (m_batch.empty()) {
+    return;
+  }
+
+  // score the whole batch, then add in creation order so the stacks end up
+  // exactly as they would have without batching
+  if (m_chunks.size() && m_batch.size() >= 2 * MIN_PARALLEL_CHUNK) {
+    EvaluateBatchParallel();
+  } else {
+    mgr.system.featureFunctions.EvaluateWhenAppliedBatch(m_batch);
+  }
+
+  for (size_t i = 0; i < m_batch.size(); ++i) {
+    m_stacks.Add(m_batch[i], mgr.GetHypoRecycle(), mgr.arcLists);
+  }
+  m_batch.clear();
+}
+
+size_t Search::GetBatchSize() const
+{
+  size_t batchSize = mgr.system.options.search.lm_batch_size;
+  if (batchSize == 0 && m_chunks.size()) {
+    batchSize = PARALLEL_BATCH_SIZE;
+  }
+  return batchSize;
+}
+
+void Search::EvaluateBatchParallel()
+{
+  // Each new hypo only reads its own fields and the finished states of the
+  // hypos in the previous stacks, so contiguous parts of the batch can be
+  // scored independently. Recombination stays in EvaluateBatch()
+  size_t numChunks = std::min(m_chunks.size(), m_batch.size() / MIN_PARALLEL_CHUNK);
+  size_t chunkSize = (m_batch.size() + numChunks - 1) / numChunks;
+
+  for (size_t i = 0; i < numChunks; ++i) {
+    Batch &chunk = *m_chunks[i];
+    chunk.clear();
+    size_t begin = i * chunkSize;
+    size_t end = std::min(begin + chunkSize, m_batch.size());
+    chunk.insert(chunk.end(), m_batch.begin() + begin, m_batch.begin() + end);
+  }
+
+  // FFs are applied in order as usual, so each hypo adds up its scores in
+  // the same order as on one thread. Only runs of FFs which are thread-safe
+  // are shared out, the others score the whole batch on this thread
+  const FeatureFunctions &ffs = mgr.system.featureFunctions;
+  const std::vector<const StatefulFeatureFunction*> &sfffs = ffs.GetStatefulFeatureFunctions();
+  size_t begin = 0;
+  while (begin < sfffs.size()) {
+    bool threadSafe = sfffs[begin]->IsThreadSafeWhenApplied();
+    size_t end = begin + 1;
+    while (end < sfffs.size() && sfffs[end]->IsThreadSafeWhenApplied() == threadSafe) {
+      ++end;
+    }
+
+    if (threadSafe) {
+      ThreadPool &pool = *mgr.system.GetSearchThreadPool();
+      Latch latch;
+      for (size_t i = 1; i < numChunks; ++i) {
+        latch.Add();
+        boost::shared_ptr<Task> task(new ScoreTask(mgr, *m_chunks[i], begin, end, latch));
+        pool.Submit(task);
+      }
+      ffs.EvaluateWhenAppliedBatch(*m_chunks[0], begin, end);
+      latch.Wait();
+    } else {
+      ffs.EvaluateWhenAppliedBatch(m_batch, begin, end);
+    }
+    begin = end;
+  }
+}
+
 const Hypothesis *Search::GetBestHypo() const
 {
   const Stack &lastStack = m_stacks.Back();
@@ -38,12 +38,23 @@ public:
 protected:
   Stacks m_stacks;
 
+  // new hypos waiting to be scored by stateful FFs, see lm-batch-size
+  Batch m_batch;
+
+  // search-threads > 1. Part i of each batch is scored by the pool with
+  // m_chunks[i]. Part 0 by this thread
+  std::vector<Batch*> m_chunks;
+
+  size_t GetBatchSize() const;
+
   void Decode(size_t stackInd);
   void Extend(const Hypothesis &hypo, const InputPath &path);
   void Extend(const Hypothesis &hypo, const TargetPhrases &tps,
               const InputPath &path, const Bitmap &newBitmap, SCORE estimatedScore);
   void Extend(const Hypothesis &hypo, const TargetPhraseImpl &tp,
               const InputPath &path, const Bitmap &newBitmap, SCORE estimatedScore);
+  void EvaluateBatch();
+  void EvaluateBatchParallel();
 
 };
 
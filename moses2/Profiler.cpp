@@ -0,0 +1,78 @@
+/*
+ * Profiler.cpp
+ *
+ */
+#include <vector>
+#include <boost/static_assert.hpp>
+#include "Profiler.h"
+#include "FF/FeatureFunction.h"
+#include "FF/FeatureFunctions.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+namespace
+{
+
+const char *FeatureFunctionCallNames[] = {
+  "EvaluateInIsolation",
+  "EvaluateAfterTablePruning",
+  "EvaluateWhenApplied",
+  "Lookup"
+};
+
+const char *DecoderStepNames[] = {
+  "CollectTranslationOptions",
+  "Search"
+};
+
+// the decoder steps are used as events as they are
+BOOST_STATIC_ASSERT(Profiler::NumDecoderSteps <= Profiler::kFixedEvents);
+
+}
+
+void Profiler::WriteJson(std::ostream &out, const FeatureFunctions &ffs)
+{
+  std::vector<Total> totals;
+  size_t numThreads = Totals(totals);
+
+  out << "{\"threads\": " << numThreads << ",\n \"decoder\": {";
+  bool first = true;
+  for (size_t i = 0; i < NumDecoderSteps; ++i) {
+    WriteJsonTotal(out, DecoderStepNames[i], totals[i], first);
+  }
+  out << "},\n \"features\": [";
+
+  const std::vector<const FeatureFunction*> &coll = ffs.GetFeatureFunctions();
+  for (size_t f = 0; f < coll.size(); ++f) {
+    const FeatureFunction &ff = *coll[f];
+    out << (f ? ",\n  " : "\n  ") << "{\"name\": ";
+    WriteJsonString(out, ff.GetName());
+    out << ", \"calls\": {";
+    first = true;
+    for (size_t call = 0; call < NumFeatureFunctionCalls; ++call) {
+      size_t event = ff.GetProfilerEvent((FeatureFunctionCall) call);
+      if (event < MaxEvents) {
+        WriteJsonTotal(out, FeatureFunctionCallNames[call], totals[event], first);
+      }
+    }
+    out << "}";
+
+    CacheStats stats;
+    if (ff.GetCacheStats(stats)) {
+      uint64_t lookups = stats.hits + stats.misses;
+      out << ", \"cache\": {\"lookups\": " << lookups
+          << ", \"hits\": " << stats.hits
+          << ", \"hit_rate\": " << (lookups ? (double) stats.hits / lookups : 0.0)
+          << ", \"evicted\": " << stats.evictions
+          << ", \"entries\": " << stats.entries << "}";
+    }
+    out << "}";
+  }
+  out << "]}" << endl;
+}
+
+}
+
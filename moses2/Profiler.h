@@ -0,0 +1,61 @@
+/*
+ * Profiler.h
+ *
+ *  util::Profiler with the events of the decoder: the main steps of
+ *  decoding a sentence and the calls of each feature function. Off unless
+ *  profile-file is given. It is then written there as JSON when the
+ *  decoder exits, and returned by the "profile" method of the server.
+ */
+#pragma once
+
+#include <iostream>
+#include <stdint.h>
+#include "util/profiler.hh"
+
+namespace Moses2
+{
+class FeatureFunctions;
+
+class Profiler : public util::Profiler
+{
+public:
+  //! the calls timed for each feature function
+  enum FeatureFunctionCall {
+    EvaluateInIsolation,
+    EvaluateAfterTablePruning,
+    EvaluateWhenApplied,
+    Lookup, // phrase tables only
+    NumFeatureFunctionCalls
+  };
+
+  //! the steps of decoding a sentence, fixed events
+  enum DecoderStep {
+    CollectTranslationOptions,
+    Search,
+    NumDecoderSteps
+  };
+
+  //! of a cache owned by a feature function
+  struct CacheStats {
+    uint64_t hits, misses, evictions;
+    size_t entries;
+
+    CacheStats()
+      :hits(0), misses(0), evictions(0), entries(0)
+    {}
+  };
+
+  //! no event, not counted
+  static const size_t MaxEvents = kMaxEvents;
+
+  //! the first of NumFeatureFunctionCalls events, in the order of FeatureFunctionCall
+  static size_t RegisterFeatureFunction() {
+    return Reserve(NumFeatureFunctionCalls);
+  }
+
+  //! all counts so far, with the cache statistics of the feature functions
+  static void WriteJson(std::ostream &out, const FeatureFunctions &ffs);
+};
+
+}
+
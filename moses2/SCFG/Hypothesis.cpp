@@ -92,6 +92,7 @@ void Hypothesis::EvaluateWhenApplied()
   const std::vector<const StatefulFeatureFunction*> &sfffs =
     GetManager().system.featureFunctions.GetStatefulFeatureFunctions();
   BOOST_FOREACH(const StatefulFeatureFunction *sfff, sfffs) {
+    Profiler::Scope profile(sfff->GetProfilerEvent(Profiler::EvaluateWhenApplied));
     EvaluateWhenApplied(*sfff);
   }
 //cerr << *this << endl;
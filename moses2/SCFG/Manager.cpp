@@ -78,9 +78,15 @@ void Manager::Decode()
       Stack &stack = m_stacks.GetStack(startPos, phraseSize);
 
       //cerr << "BEFORE LOOKUP path=" << path.Debug(system) << endl;
-      Lookup(path);
+      {
+        Profiler::Scope profile(Profiler::CollectTranslationOptions);
+        Lookup(path);
+      }
       //cerr << "AFTER LOOKUP path="  << path.Debug(system) << endl;
-      Decode(path, stack);
+      {
+        Profiler::Scope profile(Profiler::Search);
+        Decode(path, stack);
+      }
       //cerr << "AFTER DECODE path=" << path.Debug(system) << endl;
 
       LookupUnary(path);
@@ -119,6 +125,7 @@ void Manager::Lookup(SCFG::InputPath &path)
   for (size_t i = 0; i < numPt; ++i) {
     const PhraseTable &pt = *system.mappings[i];
     size_t maxChartSpan = system.maxChartSpans[i];
+    Profiler::Scope profile(pt.GetProfilerEvent(Profiler::Lookup));
     pt.Lookup(GetPool(), *this, maxChartSpan, m_stacks, path);
   }
 
@@ -137,6 +144,7 @@ void Manager::LookupUnary(SCFG::InputPath &path)
 
   for (size_t i = 0; i < numPt; ++i) {
     const PhraseTable &pt = *system.mappings[i];
+    Profiler::Scope profile(pt.GetProfilerEvent(Profiler::Lookup));
     pt.LookupUnary(GetPool(), *this, m_stacks, path);
   }
 
@@ -76,7 +76,7 @@ Sentence *Sentence::CreateFromStringXML(MemPool &pool, FactorCollection &vocab,
       UTIL_THROW_IF2(xmlOption->phraseSize != 1,
                      "Placeholder must only cover 1 word");
 
-      const Factor *factor = vocab.AddFactor(xmlOption->GetEntity(), system, false);
+      const Factor *factor = vocab.AddFactor(xmlOption->GetEntity(), false);
       (*ret)[xmlOption->startPos + 1][placeholderFactor] = factor;
     } else {
       // default - forced translation. Add to class variable
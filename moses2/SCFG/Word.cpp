@@ -57,7 +57,7 @@ void Word::CreateFromString(FactorCollection &vocab,
     const string &tok = toks[i];
     //cerr << "tok=" << tok << endl;
 
-    const Factor *factor = vocab.AddFactor(tok, system, isNonTerminal);
+    const Factor *factor = vocab.AddFactor(tok, isNonTerminal);
     m_factors[i] = factor;
   }
 }
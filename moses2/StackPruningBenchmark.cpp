@@ -0,0 +1,106 @@
+// Benchmark of hypothesis stack pruning on a real model.
+// Decodes the input with stack sizes from 100 to 10000, once with the default
+// lazy pruning (sort the stack when it gets twice too big) and once with
+// incremental-stack-pruning (a heap of scores, the stack never goes over its
+// size). Takes the arguments of moses2, eg.
+//
+//   StackPruningBenchmark -f moses.ini -input-file in [-search-algorithm 1]
+//
+// The summed best scores show whether both modes find the same translations.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "System.h"
+#include "ManagerBase.h"
+#include "TranslationTask.h"
+#include "legacy/InputFileStream.h"
+#include "legacy/Parameter.h"
+#include "util/usage.hh"
+
+using namespace std;
+using namespace Moses2;
+
+namespace
+{
+
+struct Result {
+  double seconds;
+  double totalScore;
+};
+
+// decodes in the calling thread and writes nothing
+class BenchmarkTask : public TranslationTask
+{
+public:
+  BenchmarkTask(System &system, const string &line, long translationId, Result &result)
+    : TranslationTask(system, line, translationId)
+    , m_result(result) {
+  }
+
+  virtual void Run() {
+    double begin = util::WallTime();
+    m_mgr->Decode();
+    m_result.seconds += util::WallTime() - begin;
+
+    // starts with the score, see ReportHypoScore
+    istringstream best(m_mgr->OutputBest());
+    double score = 0;
+    best >> score;
+    m_result.totalScore += score;
+    delete m_mgr;
+  }
+
+protected:
+  Result &m_result;
+};
+
+Result Decode(System &system, const vector<string> &sentences, size_t stackSize, bool incremental)
+{
+  system.options.search.stack_size = stackSize;
+  system.options.search.incremental_pruning = incremental;
+
+  Result ret = { 0, 0 };
+  for (size_t i = 0; i < sentences.size(); ++i) {
+    BenchmarkTask task(system, sentences[i], i, ret);
+    task.Run();
+  }
+  return ret;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  Parameter params;
+  if (!params.LoadParam(argc, argv)) {
+    return 1;
+  }
+  const PARAM_VEC *inputFile = params.GetParam("input-file");
+  if (inputFile == NULL || inputFile->empty()) {
+    cerr << "Usage: " << argv[0] << " -f moses.ini -input-file input [moses2 options]" << endl;
+    return 1;
+  }
+
+  System system(params);
+  system.options.output.ReportHypoScore = true;
+
+  vector<string> sentences;
+  InputFileStream in(inputFile->at(0));
+  string line;
+  while (getline(in, line)) {
+    sentences.push_back(line);
+  }
+
+  cout << "stack\tlazy s\tincremental s\tlazy score\tincremental score" << endl;
+  for (size_t stackSize = 100; stackSize <= 10000; stackSize *= 10) {
+    Result lazy = Decode(system, sentences, stackSize, false);
+    Result incremental = Decode(system, sentences, stackSize, true);
+    cout << stackSize << "\t" << lazy.seconds << "\t" << incremental.seconds
+         << "\t" << lazy.totalScore << "\t" << incremental.totalScore << endl;
+  }
+
+  return 0;
+}
@@ -10,9 +10,11 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include "System.h"
+#include "Profiler.h"
 #include "FF/FeatureFunction.h"
 #include "TranslationModel/UnknownWordPenalty.h"
 #include "legacy/Util2.h"
+#include "legacy/ThreadPool.h"
 #include "util/exception.hh"
 
 using namespace std;
@@ -30,6 +32,13 @@ System::System(const Parameter &paramsArg) :
 
   params.SetParameter(cpuAffinityOffset, "cpu-affinity-offset", -1);
   params.SetParameter(cpuAffinityOffsetIncr, "cpu-affinity-increment", 1);
+  params.SetParameter(batchQueueSize, "batch-queue-size", (size_t) 0);
+  params.SetParameter(batchMaxPending, "batch-max-pending", (size_t) 1000);
+  params.SetParameter(threadLongestFirst, "thread-longest-first", false);
+  params.SetParameter<string>(profileFile, "profile-file", "");
+  if (!profileFile.empty()) {
+    Profiler::Enable();
+  }
 
   const PARAM_VEC *section;
 
@@ -61,6 +70,10 @@ System::System(const Parameter &paramsArg) :
 
   UTIL_THROW_IF2(options.input.xml_policy == XmlConstraint, "XmlConstraint not supported");
 
+  if (options.search.search_threads > 1) {
+    m_searchThreadPool.reset(new ThreadPool(options.search.search_threads - 1));
+  }
+
   // max spans for scfg decoding
   if (!isPb) {
     section = params.GetParam("max-chart-span");
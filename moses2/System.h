@@ -11,6 +11,7 @@
 #include <boost/thread/tss.hpp>
 #include <boost/pool/object_pool.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "FF/FeatureFunctions.h"
 #include "Weights.h"
 #include "MemPool.h"
@@ -33,6 +34,7 @@ class FeatureFunction;
 class StatefulFeatureFunction;
 class PhraseTable;
 class HypothesisBase;
+class ThreadPool;
 
 class System
 {
@@ -51,6 +53,10 @@ public:
   // moses.ini params
   int cpuAffinityOffset;
   int cpuAffinityOffsetIncr;
+  size_t batchQueueSize;
+  size_t batchMaxPending;
+  bool threadLongestFirst;
+  std::string profileFile; // empty = no profiling
 
   System(const Parameter &paramsArg);
   virtual ~System();
@@ -63,6 +69,11 @@ public:
 
   Batch &GetBatch(MemPool &pool) const;
 
+  //! helper threads for search-threads > 1. NULL otherwise
+  ThreadPool *GetSearchThreadPool() const {
+    return m_searchThreadPool.get();
+  }
+
 protected:
   mutable FactorCollection m_vocab;
   mutable boost::thread_specific_ptr<MemPool> m_managerPool;
@@ -72,6 +83,9 @@ protected:
 
   mutable boost::thread_specific_ptr<Batch> m_batch;
 
+  // shared by all sentences. The thread decoding a sentence is the other helper
+  boost::scoped_ptr<ThreadPool> m_searchThreadPool;
+
   void LoadWeights();
   void LoadMappings();
   void LoadDecodeGraphBackoff();
@@ -4,6 +4,7 @@
  *  Created on: 3 Nov 2015
  *      Author: hieu
  */
+#include <algorithm>
 #include <boost/foreach.hpp>
 #include "ProbingPT.h"
 #include "probingpt/querying.h"
@@ -70,18 +71,38 @@ std::pair<bool, uint64_t> ProbingPT::ActiveChartEntryProbing::GetKey(const SCFG:
 ProbingPT::ProbingPT(size_t startInd, const std::string &line)
   :PhraseTable(startInd, line)
   ,load_method(util::POPULATE_OR_READ)
+  ,m_sharedCacheSize(0)
+  ,m_sharedCache(NULL)
 {
   ReadParameters();
 }
 
 ProbingPT::~ProbingPT()
 {
-  delete m_engine;
+  if (m_sharedCache) {
+    cerr << GetName() << " shared cache: ";
+    m_sharedCache->Report(cerr);
+    cerr << endl;
+  }
+  delete m_sharedCache;
+  if (m_replicas.empty()) {
+    delete m_engine;
+  } else {
+    RemoveAllInColl(m_replicas);
+  }
 }
 
 void ProbingPT::Load(System &system)
 {
-  m_engine = new probingpt::QueryEngine(m_path.c_str(), load_method);
+  if (load_method == util::NUMA_REPLICATE && util::NumaNodes() > 1) {
+    for (size_t node = 0; node < util::NumaNodes(); ++node) {
+      util::ScopedNumaPreferred preferred(node);
+      m_replicas.push_back(new probingpt::QueryEngine(m_path.c_str(), load_method));
+    }
+    m_engine = m_replicas[0];
+  } else {
+    m_engine = new probingpt::QueryEngine(m_path.c_str(), load_method);
+  }
 
   m_unkId = 456456546456;
 
@@ -99,7 +120,7 @@ void ProbingPT::Load(System &system)
     ReformatWord(system, wordStr, isNT);
     //cerr << "wordStr=" << wordStr << endl;
 
-    const Factor *factor = vocab.AddFactor(wordStr, system, isNT);
+    const Factor *factor = vocab.AddFactor(wordStr, isNT);
 
     uint64_t probingId = iterSource->first;
     size_t factorId = factor->GetId();
@@ -122,7 +143,7 @@ void ProbingPT::Load(System &system)
     ReformatWord(system, toks[0], isNT);
     //cerr << "wordStr=" << toks[0] << endl;
 
-    const Factor *factor = vocab.AddFactor(toks[0], system, isNT);
+    const Factor *factor = vocab.AddFactor(toks[0], isNT);
     uint32_t probingId = Scan<uint32_t>(toks[1]);
 
     if (probingId >= m_targetVocab.size()) {
@@ -138,6 +159,10 @@ void ProbingPT::Load(System &system)
 
   // cache
   CreateCache(system);
+
+  if (m_sharedCacheSize) {
+    m_sharedCache = new TargetPhrasesCache(m_sharedCacheSize);
+  }
 }
 
 void ProbingPT::SetParameter(const std::string& key, const std::string& value)
@@ -153,9 +178,15 @@ void ProbingPT::SetParameter(const std::string& key, const std::string& value)
       load_method = util::READ;
     } else if (value == "parallel_read") {
       load_method = util::PARALLEL_READ;
+    } else if (value == "numa_interleave") {
+      load_method = util::NUMA_INTERLEAVE;
+    } else if (value == "numa_replicate") {
+      load_method = util::NUMA_REPLICATE;
     } else {
       UTIL_THROW2("load method not supported" << value);
     }
+  } else if (key == "shared-cache-size") {
+    m_sharedCacheSize = Scan<size_t>(value);
   } else {
     PhraseTable::SetParameter(key, value);
   }
@@ -226,12 +257,48 @@ TargetPhrases* ProbingPT::Lookup(const Manager &mgr, MemPool &pool,
     return tps;
   }
 
+  if (m_sharedCache) {
+    TargetPhrasesCache::EntryPtr entry = m_sharedCache->Find(keyStruct.second);
+    if (!entry) {
+      // decode into memory owned by the cache entry, not the sentence
+      entry.reset(new TargetPhrasesCache::Entry());
+      entry->tps = CreateTargetPhrases(entry->pool, mgr.system, sourcePhrase,
+                                       keyStruct.second);
+      entry = m_sharedCache->Insert(keyStruct.second, entry);
+    }
+
+    // keep it alive until the end of the sentence, in case it's evicted
+    GetThreadSpecificObj(m_sharedCacheInUse).push_back(entry);
+    return entry->tps;
+  }
+
   // query pt
   TargetPhrases *tps = CreateTargetPhrases(pool, mgr.system, sourcePhrase,
                        keyStruct.second);
   return tps;
 }
 
+bool ProbingPT::GetCacheStats(Profiler::CacheStats &stats) const
+{
+  if (m_sharedCache == NULL) {
+    return false;
+  }
+  TargetPhrasesCache::Stats cacheStats = m_sharedCache->GetStats();
+  stats.hits = cacheStats.hits;
+  stats.misses = cacheStats.misses;
+  stats.evictions = cacheStats.evictions;
+  stats.entries = cacheStats.size;
+  return true;
+}
+
+void ProbingPT::CleanUpAfterSentenceProcessing() const
+{
+  std::vector<TargetPhrasesCache::EntryPtr> *inUse = m_sharedCacheInUse.get();
+  if (inUse) {
+    inUse->clear();
+  }
+}
+
 std::pair<bool, uint64_t> ProbingPT::GetKey(const Phrase<Moses2::Word> &sourcePhrase) const
 {
   std::pair<bool, uint64_t> ret;
@@ -259,28 +326,33 @@ TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
   TargetPhrases *tps = NULL;
 
   //Actual lookup
+  probingpt::QueryEngine &engine = GetEngine();
   std::pair<bool, uint64_t> query_result; // 1st=found, 2nd=target file offset
-  query_result = m_engine->query(key);
+  query_result = engine.query(key);
   //cerr << "key2=" << query_result.second << endl;
 
   if (query_result.first) {
-    const char *offset = m_engine->memTPS + query_result.second;
+    const char *offset = engine.memTPS + query_result.second;
     uint64_t *numTP = (uint64_t*) offset;
+    offset += sizeof(uint64_t);
 
-    tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
+    if (m_tableLimit && *numTP > m_tableLimit) {
+      tps = CreateTargetPhrasesPruned(pool, system, sourcePhrase, offset, *numTP);
+    } else {
+      tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, *numTP);
 
-    offset += sizeof(uint64_t);
-    for (size_t i = 0; i < *numTP; ++i) {
-      TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, offset);
-      assert(tp);
-      const FeatureFunctions &ffs = system.featureFunctions;
-      ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
+      for (size_t i = 0; i < *numTP; ++i) {
+        TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, offset);
+        assert(tp);
+        const FeatureFunctions &ffs = system.featureFunctions;
+        ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
 
-      tps->AddTargetPhrase(*tp);
+        tps->AddTargetPhrase(*tp);
 
-    }
+      }
 
-    tps->SortAndPrune(m_tableLimit);
+      tps->SortAndPrune(m_tableLimit);
+    }
     system.featureFunctions.EvaluateAfterTablePruning(pool, *tps, sourcePhrase);
     //cerr << *tps << endl;
   }
@@ -288,6 +360,41 @@ TargetPhrases *ProbingPT::CreateTargetPhrases(MemPool &pool,
   return tps;
 }
 
+TargetPhrases *ProbingPT::CreateTargetPhrasesPruned(MemPool &pool,
+    const System &system, const Phrase<Moses2::Word> &sourcePhrase,
+    const char *offset, size_t numTP) const
+{
+  const FeatureFunctions &ffs = system.featureFunctions;
+  MemPool &scratch = GetThreadSpecificObj(m_scratchPool);
+  std::vector<ScoredRule> &rules = GetThreadSpecificObj(m_scratchRules);
+
+  rules.resize(numTP);
+  for (size_t i = 0; i < numTP; ++i) {
+    ScoredRule &rule = rules[i];
+    rule.offset = offset;
+
+    TargetPhraseImpl *tp = CreateTargetPhrase(scratch, system, offset);
+    ffs.EvaluateInIsolation(scratch, system, sourcePhrase, *tp);
+    rule.score = tp->GetScoreForPruning();
+  }
+  scratch.Reset();
+
+  // the same comparisons on the same scores as SortAndPrune(), so the same
+  // rules in the same order
+  std::partial_sort(rules.begin(), rules.begin() + m_tableLimit, rules.end(),
+                    ScoredRuleOrderer());
+
+  TargetPhrases *tps = new (pool.Allocate<TargetPhrases>()) TargetPhrases(pool, m_tableLimit);
+  for (size_t i = 0; i < m_tableLimit; ++i) {
+    const char *ruleOffset = rules[i].offset;
+    TargetPhraseImpl *tp = CreateTargetPhrase(pool, system, ruleOffset);
+    ffs.EvaluateInIsolation(pool, system, sourcePhrase, *tp);
+    tps->AddTargetPhrase(*tp);
+  }
+
+  return tps;
+}
+
 TargetPhraseImpl *ProbingPT::CreateTargetPhrase(
   MemPool &pool,
   const System &system,
@@ -686,8 +793,9 @@ std::pair<bool, SCFG::TargetPhrases*> ProbingPT::CreateTargetPhrasesSCFG(MemPool
 {
   std::pair<bool, SCFG::TargetPhrases*> ret(false, NULL);
 
+  probingpt::QueryEngine &engine = GetEngine();
   std::pair<bool, uint64_t> query_result; // 1st=found, 2nd=target file offset
-  query_result = m_engine->query(key);
+  query_result = engine.query(key);
   //cerr << "query_result=" << query_result.first << endl;
 
   /*
@@ -709,7 +817,7 @@ std::pair<bool, SCFG::TargetPhrases*> ProbingPT::CreateTargetPhrasesSCFG(MemPool
       // there are some rules
       const FeatureFunctions &ffs = system.featureFunctions;
 
-      const char *offset = m_engine->memTPS + query_result.second;
+      const char *offset = engine.memTPS + query_result.second;
       uint64_t *numTP = (uint64_t*) offset;
       //cerr << "numTP=" << *numTP << endl;
 
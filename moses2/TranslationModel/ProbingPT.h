@@ -12,10 +12,12 @@
 #include <boost/bimap.hpp>
 #include <deque>
 #include "PhraseTable.h"
+#include "TargetPhrasesCache.h"
 #include "../Vector.h"
 #include "../Phrase.h"
 #include "../SCFG/ActiveChart.h"
 #include "util/mmap.hh"
+#include "util/numa.hh"
 
 namespace probingpt
 {
@@ -78,6 +80,10 @@ public:
   virtual void SetParameter(const std::string& key, const std::string& value);
   void Lookup(const Manager &mgr, InputPathsBase &inputPaths) const;
 
+  virtual void CleanUpAfterSentenceProcessing() const;
+
+  virtual bool GetCacheStats(Profiler::CacheStats &stats) const;
+
   uint64_t GetUnk() const {
     return m_unkId;
   }
@@ -103,6 +109,16 @@ protected:
 
   uint64_t m_unkId;
   probingpt::QueryEngine *m_engine;
+  // load=numa_replicate: a copy per NUMA node. m_engine is the node 0 copy
+  std::vector<probingpt::QueryEngine*> m_replicas;
+
+  //! engine to query from the calling thread. Its node-local copy if replicated
+  probingpt::QueryEngine &GetEngine() const {
+    if (m_replicas.empty()) {
+      return *m_engine;
+    }
+    return *m_replicas[util::NumaNodeOfCurrentThread() % m_replicas.size()];
+  }
 
   void CreateAlignmentMap(System &system, const std::string path);
 
@@ -113,6 +129,28 @@ protected:
   TargetPhraseImpl *CreateTargetPhrase(MemPool &pool, const System &system,
                                        const char *&offset) const;
 
+  // More rules than the table limit. Each rule is scored in scratch memory,
+  // keeping only its score and where it is in the target file. Only the rules
+  // that survive pruning are created in pool
+  TargetPhrases *CreateTargetPhrasesPruned(MemPool &pool, const System &system,
+      const Phrase<Moses2::Word> &sourcePhrase, const char *offset, size_t numTP) const;
+
+  struct ScoredRule {
+    SCORE score;
+    const char *offset;
+  };
+
+  struct ScoredRuleOrderer {
+    // same order as TargetPhrases::SortAndPrune()
+    bool operator()(const ScoredRule &a, const ScoredRule &b) const {
+      return a.score > b.score;
+    }
+  };
+
+  // per thread, reused by every lookup
+  mutable boost::thread_specific_ptr<MemPool> m_scratchPool;
+  mutable boost::thread_specific_ptr<std::vector<ScoredRule> > m_scratchRules;
+
   inline const std::pair<bool, const Factor*> *GetTargetFactor(uint32_t probingId) const {
     if (probingId >= m_targetVocab.size()) {
       return NULL;
@@ -136,6 +174,12 @@ protected:
 
   void CreateCache(System &system);
 
+  // bounded cache of lookups, shared by all sentences
+  size_t m_sharedCacheSize; // 0 = off
+  TargetPhrasesCache *m_sharedCache;
+  // entries used by the current sentence in this thread
+  mutable boost::thread_specific_ptr<std::vector<TargetPhrasesCache::EntryPtr> > m_sharedCacheInUse;
+
   void ReformatWord(System &system, std::string &wordStr, bool &isNT);
 
   // SCFG
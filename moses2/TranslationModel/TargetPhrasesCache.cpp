@@ -0,0 +1,107 @@
+/*
+ * TargetPhrasesCache.cpp
+ *
+ */
+#include "TargetPhrasesCache.h"
+
+using namespace std;
+
+namespace Moses2
+{
+
+TargetPhrasesCache::TargetPhrasesCache(size_t maxSize)
+{
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    Shard &shard = m_shards[i];
+    shard.maxSize = maxSize / NUM_SHARDS + (i < maxSize % NUM_SHARDS ? 1 : 0);
+    shard.slots.reserve(shard.maxSize);
+  }
+}
+
+TargetPhrasesCache::EntryPtr TargetPhrasesCache::Find(uint64_t key)
+{
+  Shard &shard = GetShard(key);
+  boost::mutex::scoped_lock lock(shard.mutex);
+
+  boost::unordered_map<uint64_t, size_t>::const_iterator iter = shard.index.find(key);
+  if (iter == shard.index.end()) {
+    ++shard.stats.misses;
+    return EntryPtr();
+  }
+
+  ++shard.stats.hits;
+  Slot &slot = shard.slots[iter->second];
+  slot.referenced = true;
+  return slot.entry;
+}
+
+TargetPhrasesCache::EntryPtr TargetPhrasesCache::Insert(uint64_t key, const EntryPtr &entry)
+{
+  Shard &shard = GetShard(key);
+  boost::mutex::scoped_lock lock(shard.mutex);
+
+  if (shard.maxSize == 0) {
+    return entry;
+  }
+
+  std::pair<boost::unordered_map<uint64_t, size_t>::iterator, bool> ret
+    = shard.index.insert(std::make_pair(key, shard.slots.size()));
+  if (!ret.second) {
+    // lost the race. Use what the other thread created
+    return shard.slots[ret.first->second].entry;
+  }
+
+  size_t ind;
+  if (shard.slots.size() < shard.maxSize) {
+    ind = shard.slots.size();
+    shard.slots.push_back(Slot());
+  } else {
+    // full. Sweep the clock hand until there's a slot not used since the last pass
+    while (shard.slots[shard.hand].referenced) {
+      shard.slots[shard.hand].referenced = false;
+      shard.hand = (shard.hand + 1) % shard.maxSize;
+    }
+    ind = shard.hand;
+    shard.hand = (shard.hand + 1) % shard.maxSize;
+
+    shard.index.erase(shard.slots[ind].key);
+    ++shard.stats.evictions;
+  }
+
+  ret.first->second = ind;
+  Slot &slot = shard.slots[ind];
+  slot.key = key;
+  slot.entry = entry;
+  slot.referenced = false;
+
+  return entry;
+}
+
+TargetPhrasesCache::Stats TargetPhrasesCache::GetStats() const
+{
+  Stats ret;
+  for (size_t i = 0; i < NUM_SHARDS; ++i) {
+    const Shard &shard = m_shards[i];
+    boost::mutex::scoped_lock lock(shard.mutex);
+    ret.hits += shard.stats.hits;
+    ret.misses += shard.stats.misses;
+    ret.evictions += shard.stats.evictions;
+    ret.size += shard.slots.size();
+  }
+  return ret;
+}
+
+void TargetPhrasesCache::Report(std::ostream &out) const
+{
+  Stats stats = GetStats();
+  uint64_t lookups = stats.hits + stats.misses;
+  out << "size=" << stats.size
+      << " hits=" << stats.hits
+      << " misses=" << stats.misses
+      << " evictions=" << stats.evictions;
+  if (lookups) {
+    out << " hit-rate=" << (double) stats.hits / lookups;
+  }
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * TargetPhrasesCache.h
+ *
+ *  Bounded cache of decoded & scored target phrases, shared by all
+ *  translation tasks. Keyed by the pt's source phrase hash.
+ */
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+#include "../MemPool.h"
+
+namespace Moses2
+{
+class TargetPhrases;
+
+/** CLOCK (second-chance) replacement, sharded by key so lookups from
+ * different threads rarely contend on the same lock.
+ * Entries are reference counted. A task keeps the entries it is using alive
+ * until the end of the sentence, even if they're evicted in the meantime.
+ */
+class TargetPhrasesCache
+{
+public:
+  struct Entry {
+    MemPool pool; // owns everything the target phrases point to
+    TargetPhrases *tps; // NULL if the source phrase isn't in the pt
+
+    Entry()
+      :pool(1024)
+      ,tps(NULL)
+    {}
+  };
+  typedef boost::shared_ptr<Entry> EntryPtr;
+
+  struct Stats {
+    uint64_t hits, misses, evictions;
+    size_t size;
+
+    Stats()
+      :hits(0), misses(0), evictions(0), size(0)
+    {}
+  };
+
+  TargetPhrasesCache(size_t maxSize);
+
+  //! empty pointer if not in cache
+  EntryPtr Find(uint64_t key);
+
+  //! add entry. If another thread added the key first, return that entry instead
+  EntryPtr Insert(uint64_t key, const EntryPtr &entry);
+
+  Stats GetStats() const;
+  void Report(std::ostream &out) const;
+
+protected:
+  struct Slot {
+    uint64_t key;
+    EntryPtr entry;
+    bool referenced;
+  };
+
+  struct Shard {
+    boost::unordered_map<uint64_t, size_t> index; // key -> slot
+    std::vector<Slot> slots;
+    size_t hand;
+    size_t maxSize;
+    Stats stats;
+    mutable boost::mutex mutex;
+
+    Shard()
+      :hand(0)
+      ,maxSize(0)
+    {}
+  };
+
+  static const size_t NUM_SHARDS = 16;
+  Shard m_shards[NUM_SHARDS];
+
+  Shard &GetShard(uint64_t key) {
+    // keys are already hashes, but mix in the high bits anyway
+    return m_shards[(key ^ (key >> 32)) % NUM_SHARDS];
+  }
+
+};
+
+}
@@ -142,7 +142,7 @@ TargetPhrases *UnknownWordPenalty::Lookup(const Manager &mgr, MemPool &pool,
       }
 
       FactorCollection &fc = system.GetVocab();
-      const Factor *targetFactor = fc.AddFactor(strm.str(), system, false);
+      const Factor *targetFactor = fc.AddFactor(strm.str(), false);
       word[0] = targetFactor;
     }
   }
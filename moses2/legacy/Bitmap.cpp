@@ -21,63 +21,72 @@
 
 #include <boost/functional/hash.hpp>
 #include "Bitmap.h"
+#include "../MemPool.h"
 
 namespace Moses2
 {
 
 Bitmap::Bitmap(MemPool &pool, size_t size) :
-  m_bitmap(pool, size)
+  m_size(size)
 {
+  size_t numBlocks = NumBlocks(size);
+  m_blocks = numBlocks <= BITMAP_INLINE_BLOCKS ? m_inline : pool.Allocate<Block>(numBlocks);
 }
 
-void Bitmap::Init(const std::vector<bool>& initializer)
+Bitmap::Bitmap(MemPool &pool, const Bitmap &copy) :
+  m_size(copy.m_size)
+  ,m_firstGap(copy.m_firstGap)
+  ,m_numWordsCovered(copy.m_numWordsCovered)
 {
+  size_t numBlocks = NumBlocks(m_size);
+  m_blocks = numBlocks <= BITMAP_INLINE_BLOCKS ? m_inline : pool.Allocate<Block>(numBlocks);
+  std::copy(copy.m_blocks, copy.m_blocks + numBlocks, m_blocks);
+}
 
-  for (size_t i = 0; i < initializer.size(); ++i) {
-    m_bitmap[i] = initializer[i];
-  }
-
-  // The initializer may not be of the same length.  Change to the desired
-  // length.  If we need to add any elements, initialize them to false.
-  for (size_t i = initializer.size(); i < m_bitmap.size(); ++i) {
-    m_bitmap[i] = false;
+void Bitmap::Init(const std::vector<bool>& initializer)
+{
+  std::fill(m_blocks, m_blocks + NumBlocks(m_size), 0);
+
+  // The initializer may not be of the same length.  Only the first size
+  // values are used, any others are false.
+  m_numWordsCovered = 0;
+  for (size_t pos = 0; pos < initializer.size() && pos < m_size; ++pos) {
+    if (initializer[pos]) {
+      m_blocks[pos / BITS_PER_BLOCK] |= Block(1) << (pos % BITS_PER_BLOCK);
+      ++m_numWordsCovered;
+    }
   }
 
-  m_numWordsCovered = std::count(m_bitmap.begin(), m_bitmap.end(), true);
-
   // Find the first gap, and cache it.
-  Array<char>::const_iterator first_gap = std::find(m_bitmap.begin(),
-                                          m_bitmap.end(), false);
-  m_firstGap = ((first_gap == m_bitmap.end()) ?
-                NOT_FOUND: first_gap - m_bitmap.begin());
+  m_firstGap = FindNext(0, false);
 }
 
 void Bitmap::Init(const Bitmap &copy, const Range &range)
 {
   m_firstGap = copy.m_firstGap;
   m_numWordsCovered = copy.m_numWordsCovered;
-  for (size_t i = 0; i < m_bitmap.size(); ++i) {
-    m_bitmap[i] = copy.m_bitmap[i];
-  }
+  std::copy(copy.m_blocks, copy.m_blocks + NumBlocks(m_size), m_blocks);
   SetValueNonOverlap(range);
 }
 
 // for unordered_set in stack
 size_t Bitmap::hash() const
 {
-  size_t ret = m_bitmap.hash();
+  size_t ret = m_size;
+  boost::hash_range(ret, m_blocks, m_blocks + NumBlocks(m_size));
   return ret;
 }
 
 bool Bitmap::operator==(const Bitmap& other) const
 {
-  return m_bitmap == other.m_bitmap;
+  return m_size == other.m_size
+         && std::equal(m_blocks, m_blocks + NumBlocks(m_size), other.m_blocks);
 }
 
 // friend
 std::ostream& operator<<(std::ostream& out, const Bitmap& bitmap)
 {
-  for (size_t i = 0; i < bitmap.m_bitmap.size(); i++) {
+  for (size_t i = 0; i < bitmap.m_size; i++) {
     out << int(bitmap.GetValue(i));
   }
   return out;
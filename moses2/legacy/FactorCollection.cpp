@@ -23,12 +23,13 @@
 #ifdef WITH_THREADS
 #include <boost/thread/locks.hpp>
 #endif
+#include <cstring>
 #include <ostream>
 #include <string>
 #include "FactorCollection.h"
+#include "Util2.h"
 #include "util/pool.hh"
 #include "util/exception.hh"
-#include "../System.h"
 
 using namespace std;
 
@@ -36,57 +37,23 @@ namespace Moses2
 {
 
 const Factor *FactorCollection::AddFactor(const StringPiece &factorString,
-    const System &system, bool isNonTerminal)
+    bool isNonTerminal)
 {
-  FactorFriend to_ins;
-  to_ins.in.m_string = factorString;
-  to_ins.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
-  // If we're threaded, hope a read-only lock is sufficient.
-#ifdef WITH_THREADS
-  {
-    // read=lock scope
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
-    Set::const_iterator i = set.find(to_ins);
-    if (i != set.end()) return &i->in;
-  }
-  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
-#endif // WITH_THREADS
-  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
-  if (ret.second) {
-    ret.first->in.m_string.set(
-      memcpy(m_string_backing.Allocate(factorString.size()),
-             factorString.data(), factorString.size()), factorString.size());
-    if (isNonTerminal) {
-      m_factorIdNonTerminal++;
-      UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals,
-                     "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
-    } else {
-      m_factorId++;
-    }
+  if (isNonTerminal) {
+    const Factor *ret = m_setNonTerminal.FindOrInsert(factorString, m_factorIdNonTerminal);
+    UTIL_THROW_IF2(m_factorIdNonTerminal.load() >= moses_MaxNumNonterminals,
+                   "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
+    return ret;
+  } else {
+    return m_set.FindOrInsert(factorString, m_factorId);
   }
-
-  const Factor *factor = &ret.first->in;
-
-  return factor;
 }
 
 const Factor *FactorCollection::GetFactor(const StringPiece &factorString,
     bool isNonTerminal)
 {
-  FactorFriend to_find;
-  to_find.in.m_string = factorString;
-  to_find.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
-  {
-    // read=lock scope
-#ifdef WITH_THREADS
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
-#endif // WITH_THREADS
-    Set::const_iterator i = set.find(to_find);
-    if (i != set.end()) return &i->in;
-  }
-  return NULL;
+  const Table &set = (isNonTerminal) ? m_setNonTerminal : m_set;
+  return set.Find(factorString);
 }
 
 FactorCollection::~FactorCollection()
@@ -96,15 +63,12 @@ FactorCollection::~FactorCollection()
 // friend
 ostream& operator<<(ostream& out, const FactorCollection& factorCollection)
 {
-#ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(factorCollection.m_accessLock);
-#endif
-  for (FactorCollection::Set::const_iterator i = factorCollection.m_set.begin();
-       i != factorCollection.m_set.end(); ++i) {
-    out << i->in;
+  std::vector<const Factor*> factors;
+  factorCollection.m_set.GetAll(factors);
+  for (size_t i = 0; i < factors.size(); ++i) {
+    out << *factors[i];
   }
   return out;
 }
 
 }
-
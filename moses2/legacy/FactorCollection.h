@@ -26,19 +26,16 @@
 #define moses_MaxNumNonterminals 10000
 #endif
 
-#ifdef WITH_THREADS
-#include <boost/thread/shared_mutex.hpp>
-#endif
-
-#include "util/murmur_hash.hh"
+#include <boost/atomic.hpp>
 #include <boost/unordered_set.hpp>
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "util/string_piece.hh"
-#include "util/pool.hh"
 #include "Factor.h"
+#include "moses/FactorTable.h"
 
 namespace Moses2
 {
@@ -54,6 +51,11 @@ class System;
  */
 struct FactorFriend {
   Factor in;
+
+  void Init(const StringPiece &str, size_t id) {
+    in.m_string = str;
+    in.m_id = id;
+  }
 };
 
 /** collection of factors
@@ -63,38 +65,26 @@ struct FactorFriend {
  * from being created on the stack, etc), their memory addresses can
  * be used as keys to uniquely identify them.
  * Only 1 FactorCollection object should be created.
+ *
+ * Factors are interned in a sharded open-addressing table. Looking up a
+ * factor which already exists takes no lock. Only inserting a new factor
+ * locks, and then only the shard the string hashes to.
  */
 class FactorCollection
 {
   friend std::ostream& operator<<(std::ostream&, const FactorCollection&);
   friend class System;
 
-  struct HashFactor: public std::unary_function<const FactorFriend &,
-      std::size_t> {
-    std::size_t operator()(const FactorFriend &factor) const {
-      return util::MurmurHashNative(factor.in.m_string.data(),
-                                    factor.in.m_string.size());
-    }
-  };
-  struct EqualsFactor: public std::binary_function<const FactorFriend &,
-      const FactorFriend &, bool> {
-    bool operator()(const FactorFriend &left, const FactorFriend &right) const {
-      return left.in.GetString() == right.in.GetString();
-    }
-  };
-  typedef boost::unordered_set<FactorFriend, HashFactor, EqualsFactor> Set;
-  Set m_set;
-  Set m_setNonTerminal;
-
-  util::Pool m_string_backing;
-
-#ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::shared_mutex m_accessLock;
-#endif
+public:
+  //! sharded table the factors are interned in
+  typedef Moses::FactorTable<Factor, FactorFriend> Table;
+
+protected:
+  Table m_set;
+  Table m_setNonTerminal;
 
-  size_t m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
-  size_t m_factorId; /**< unique, contiguous ids, starting from moses_MaxNumNonterminals, for each terminal factor */
+  boost::atomic<size_t> m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
+  boost::atomic<size_t> m_factorId; /**< unique, contiguous ids, starting from moses_MaxNumNonterminals, for each terminal factor */
 
   //! constructor. only the 1 static variable can be created
   FactorCollection() :
@@ -107,11 +97,10 @@ public:
   /** returns a factor with the same direction, factorType and factorString.
    *	If a factor already exist in the collection, return the existing factor, if not create a new 1
    */
-  const Factor *AddFactor(const StringPiece &factorString, const System &system,
-                          bool isNonTerminal);
+  const Factor *AddFactor(const StringPiece &factorString, bool isNonTerminal);
 
   size_t GetNumNonTerminals() {
-    return m_factorIdNonTerminal;
+    return m_factorIdNonTerminal.load();
   }
 
   const Factor *GetFactor(const StringPiece &factorString, bool isNonTerminal =
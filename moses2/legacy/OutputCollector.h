@@ -21,6 +21,7 @@
 
 #ifdef WITH_THREADS
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #endif
 
 #ifdef BOOST_HAS_PTHREADS
@@ -28,16 +29,19 @@
 #endif
 
 #include <iostream>
-#include <map>
+#include <deque>
 #include <ostream>
 #include <fstream>
 #include <string>
+#include <cassert>
 #include "util/exception.hh"
 
 namespace Moses2
 {
 /**
- * Makes sure output goes in the correct order when multi-threading
+ * Makes sure output goes in the correct order when multi-threading.
+ * Out-of-order output is held in a window indexed from the next id to be
+ * written, so its size is bounded by the number of sentences in flight.
  **/
 class OutputCollector
 {
@@ -104,41 +108,74 @@ public:
 #ifdef WITH_THREADS
     boost::mutex::scoped_lock lock(m_mutex);
 #endif
-    if (sourceId == m_nextOutput) {
-      //This is the one we were expecting
-      *m_outStream << output << std::flush;
-      *m_debugStream << debug << std::flush;
+    assert(sourceId >= m_nextOutput);
+    size_t ind = sourceId - m_nextOutput;
+    if (ind >= m_pending.size()) {
+      m_pending.resize(ind + 1);
+    }
+    Pending &pending = m_pending[ind];
+    pending.output = output;
+    pending.debug = debug;
+    pending.done = true;
+
+    //write everything that is now in order
+    bool wrote = false;
+    while (!m_pending.empty() && m_pending.front().done) {
+      *m_outStream << m_pending.front().output << std::flush;
+      *m_debugStream << m_pending.front().debug << std::flush;
+      m_pending.pop_front();
       ++m_nextOutput;
-      //see if there's any more
-      std::map<int, std::string>::iterator iter;
-      while ((iter = m_outputs.find(m_nextOutput)) != m_outputs.end()) {
-        *m_outStream << iter->second << std::flush;
-        ++m_nextOutput;
-        std::map<int, std::string>::iterator debugIter = m_debugs.find(
-              iter->first);
-        m_outputs.erase(iter);
-        if (debugIter != m_debugs.end()) {
-          *m_debugStream << debugIter->second << std::flush;
-          m_debugs.erase(debugIter);
-        }
-      }
-    } else {
-      //save for later
-      m_outputs[sourceId] = output;
-      m_debugs[sourceId] = debug;
+      wrote = true;
+    }
+
+#ifdef WITH_THREADS
+    if (wrote) {
+      m_written.notify_all();
+    }
+#endif
+  }
+
+  //! number of outputs written so far, ie. the id of the next one to be written
+  int GetNumWritten() const {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+#endif
+    return m_nextOutput;
+  }
+
+  /**
+   * Block until at least numWritten outputs have been written.
+   * Used by the batch reader for back-pressure.
+   **/
+  void WaitUntilWritten(int numWritten) const {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_nextOutput < numWritten) {
+      m_written.wait(lock);
     }
+#endif
   }
 
 private:
-  std::map<int, std::string> m_outputs;
-  std::map<int, std::string> m_debugs;
+  struct Pending {
+    std::string output;
+    std::string debug;
+    bool done;
+
+    Pending() :
+      done(false) {
+    }
+  };
+
+  std::deque<Pending> m_pending;
   int m_nextOutput;
   std::ostream* m_outStream;
   std::ostream* m_debugStream;
   bool m_isHoldingOutputStream;
   bool m_isHoldingDebugStream;
 #ifdef WITH_THREADS
-  boost::mutex m_mutex;
+  mutable boost::mutex m_mutex;
+  mutable boost::condition_variable m_written;
 #endif
 
 public:
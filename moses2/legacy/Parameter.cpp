@@ -87,6 +87,12 @@ Parameter::Parameter()
   //    "threshold for constructing hypotheses based on estimate cost");
   AddParam(search_opts, "stack", "s",
            "maximum stack size for histogram pruning. 0 = unlimited stack size");
+  AddParam(search_opts, "lm-batch-size",
+           "score new hypotheses with stateful feature functions in batches of this size, letting the LM prefetch the whole batch. 0 = one at a time (default)");
+  AddParam(search_opts, "search-threads",
+           "number of threads scoring the new hypotheses of each sentence, for long sentences when there are fewer sentences than cores. Only feature functions that are thread-safe when applied, such as KENLM and Distortion, are shared out. Phrase-based normal search only. Default = 1");
+  AddParam(search_opts, "incremental-stack-pruning",
+           "keep each stack at its maximum size on every insert, using a heap of scores, instead of sorting it when it gets twice as big");
   //AddParam(search_opts, "stack-diversity", "sd",
   //    "minimum number of hypothesis of each coverage in stack (default 0)");
 
@@ -358,6 +364,14 @@ Parameter::Parameter()
   AddParam(misc_opts, "cpu-affinity-offset", "CPU Affinity. Default = -1 (no affinity)");
   AddParam(misc_opts, "cpu-affinity-increment",
            "Set to 1 (default) to put each thread on different cores. 0 to run all threads on one core");
+  AddParam(misc_opts, "batch-queue-size",
+           "Max number of input sentences waiting for a decoder thread in batch mode. Default = 0 (4 x threads)");
+  AddParam(misc_opts, "batch-max-pending",
+           "Max number of input sentences read but not yet written in batch mode. Default = 1000");
+  AddParam(misc_opts, "thread-longest-first",
+           "Decode the longest of the queued sentences first, rather than in input order. Default = false");
+  AddParam(misc_opts, "profile-file",
+           "Count the time spent and calls made by each feature function, and write them to this file as JSON when done. The server returns them from the profile method");
 
   // Compact phrase table and reordering table.
   po::options_description cpt_opts(
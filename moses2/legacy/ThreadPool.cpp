@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <algorithm>
 #include <thread>
 
 #include "ThreadPool.h"
@@ -40,8 +41,15 @@ namespace Moses2
 
 ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
                        int cpuAffinityIncr) :
-  m_stopped(false), m_stopping(false), m_queueLimit(0)
+  m_numQueued(0), m_numSleeping(0), m_numWaiting(0), m_stopped(false),
+  m_nextWorker(0), m_stopping(false), m_queueLimit(0), m_longestFirst(false)
 {
+  // a queue even without threads, so that Submit() has somewhere to put tasks
+  for (size_t i = 0; i < std::max<size_t>(numThreads, 1); ++i) {
+    m_workers.push_back(new Worker());
+  }
+  m_timer.start();
+
 #if defined(_WIN32) || defined(_WIN64)
   size_t numCPU = std::thread::hardware_concurrency();
 #else
@@ -53,7 +61,7 @@ ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
 
   for (size_t i = 0; i < numThreads; ++i) {
     boost::thread *thread = m_threads.create_thread(
-                              boost::bind(&ThreadPool::Execute, this));
+                              boost::bind(&ThreadPool::Execute, this, i));
 
 #ifdef __linux
     if (cpuAffinityOffset >= 0) {
@@ -89,43 +97,147 @@ ThreadPool::ThreadPool(size_t numThreads, int cpuAffinityOffset,
   }
 }
 
-void ThreadPool::Execute()
+ThreadPool::~ThreadPool()
 {
-  do {
-    boost::shared_ptr<Task> task;
-    {
-      // Find a job to perform
+  Stop();
+  for (size_t i = 0; i < m_workers.size(); ++i) {
+    delete m_workers[i];
+  }
+}
+
+void ThreadPool::Execute(size_t workerInd)
+{
+  Worker &worker = *m_workers[workerInd];
+  while (!m_stopped) {
+    TaskPtr task;
+    bool stolen;
+    if (!Claim(workerInd, task, stolen)) {
+      // Sleep until Submit() or Stop(). A task is counted as it is pushed,
+      // so a thread woken up always finds it
       boost::mutex::scoped_lock lock(m_mutex);
-      if (m_tasks.empty() && !m_stopped) {
+      ++m_numSleeping;
+      while (m_numQueued == 0 && !m_stopped) {
         m_threadNeeded.wait(lock);
       }
-      if (!m_stopped && !m_tasks.empty()) {
-        task = m_tasks.front();
-        m_tasks.pop();
-      }
+      --m_numSleeping;
+      continue;
     }
+    // a slot is free in the queue. Wake up any blocked Submit() or Stop()
+    NotifyAvailable();
+
     //Execute job
-    if (task) {
-      // must read from task before run. otherwise task may be deleted by main thread
-      // race condition
-      task->DeleteAfterExecution();
-      task->Run();
+    {
+      boost::mutex::scoped_lock lock(worker.mutex);
+      worker.busy.start();
+    }
+    // must read from task before run. otherwise task may be deleted by main thread
+    // race condition
+    task->DeleteAfterExecution();
+    task->Run();
+    task.reset();
+    {
+      boost::mutex::scoped_lock lock(worker.mutex);
+      worker.busy.stop();
+      ++worker.numRun;
+      if (stolen) {
+        ++worker.numStolen;
+      }
     }
+  }
+}
+
+bool ThreadPool::Claim(size_t workerInd, TaskPtr &task, bool &stolen)
+{
+  size_t numWorkers = m_workers.size();
+  if (m_longestFirst) {
+    // each queue has its costliest task at the front. Take the costliest of
+    // those, so the longest sentences start first whichever queue they're in
+    size_t best = numWorkers;
+    size_t bestCost = 0;
+    for (size_t i = 0; i < numWorkers; ++i) {
+      size_t ind = (workerInd + i) % numWorkers;
+      Worker &other = *m_workers[ind];
+      boost::mutex::scoped_lock lock(other.mutex);
+      if (!other.tasks.empty() && (best == numWorkers || other.tasks.begin()->first > bestCost)) {
+        best = ind;
+        bestCost = other.tasks.begin()->first;
+      }
+    }
+    if (best != numWorkers && Pop(*m_workers[best], false, task)) {
+      stolen = (best != workerInd);
+      return true;
+    }
+    // taken by another thread meanwhile. Settle for any task
+  }
+
+  for (size_t i = 0; i < numWorkers; ++i) {
+    if (Pop(*m_workers[(workerInd + i) % numWorkers], i > 0, task)) {
+      stolen = (i > 0);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::Push(Worker &worker, const TaskPtr &task)
+{
+  boost::mutex::scoped_lock lock(worker.mutex);
+  // equal keys go after the existing ones, so equal costs stay in submission order
+  worker.tasks.insert(std::make_pair(m_longestFirst ? task->GetCost() : 0, task));
+  // under the queue lock, so it can't be popped and uncounted first
+  ++m_numQueued;
+}
+
+bool ThreadPool::Pop(Worker &worker, bool steal, TaskPtr &task)
+{
+  boost::mutex::scoped_lock lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+
+  // The owner takes the oldest (or longest) task. Thieves take the newest
+  // from the other end, unless running longest first
+  std::multimap<size_t, TaskPtr, std::greater<size_t> >::iterator iter = worker.tasks.begin();
+  if (steal && !m_longestFirst) {
+    iter = --worker.tasks.end();
+  }
+  task = iter->second;
+  worker.tasks.erase(iter);
+  --m_numQueued;
+  return true;
+}
+
+void ThreadPool::NotifyAvailable()
+{
+  // Waiters count themselves under m_mutex before checking m_numQueued, so
+  // either they see the claim or it sees them
+  if (m_numWaiting) {
+    boost::mutex::scoped_lock lock(m_mutex);
     m_threadAvailable.notify_all();
-  } while (!m_stopped);
+  }
 }
 
 void ThreadPool::Submit(boost::shared_ptr<Task> task)
 {
-  boost::mutex::scoped_lock lock(m_mutex);
-  if (m_stopping) {
-    throw runtime_error("ThreadPool stopping - unable to accept new jobs");
+  size_t workerInd;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_stopping) {
+      throw runtime_error("ThreadPool stopping - unable to accept new jobs");
+    }
+    ++m_numWaiting;
+    while (m_queueLimit > 0 && m_numQueued >= m_queueLimit) {
+      m_threadAvailable.wait(lock);
+    }
+    --m_numWaiting;
+    workerInd = m_nextWorker;
+    m_nextWorker = (m_nextWorker + 1) % m_workers.size();
   }
-  while (m_queueLimit > 0 && m_tasks.size() >= m_queueLimit) {
-    m_threadAvailable.wait(lock);
+  Push(*m_workers[workerInd], task);
+  if (m_numSleeping) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_threadNeeded.notify_one();
   }
-  m_tasks.push(task);
-  m_threadNeeded.notify_all();
 }
 
 void ThreadPool::Stop(bool processRemainingJobs)
@@ -139,9 +251,11 @@ void ThreadPool::Stop(bool processRemainingJobs)
   if (processRemainingJobs) {
     boost::mutex::scoped_lock lock(m_mutex);
     //wait for queue to drain.
-    while (!m_tasks.empty() && !m_stopped) {
+    ++m_numWaiting;
+    while (m_numQueued && !m_stopped) {
       m_threadAvailable.wait(lock);
     }
+    --m_numWaiting;
   }
   //tell all threads to stop
   {
@@ -151,6 +265,24 @@ void ThreadPool::Stop(bool processRemainingJobs)
   m_threadNeeded.notify_all();
 
   m_threads.join_all();
+  m_timer.stop();
+}
+
+void ThreadPool::Report(std::ostream &out) const
+{
+  double elapsed = m_timer.get_elapsed_time();
+  for (size_t i = 0; i < m_workers.size(); ++i) {
+    const Worker &worker = *m_workers[i];
+    boost::mutex::scoped_lock lock(worker.mutex);
+    double busy = worker.busy.get_elapsed_time();
+    out << "Thread " << i << ": tasks=" << worker.numRun
+        << " stolen=" << worker.numStolen
+        << " busy=" << busy << "s";
+    if (elapsed > 0) {
+      out << " utilization=" << (100 * busy / elapsed) << "%";
+    }
+    out << endl;
+  }
 }
 
 }
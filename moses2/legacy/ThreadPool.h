@@ -21,10 +21,12 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
-#include <queue>
+#include <map>
 #include <vector>
 
+#include <boost/atomic.hpp>
 #include <boost/shared_ptr.hpp>
 
 #ifdef WITH_THREADS
@@ -36,6 +38,8 @@
 #include <pthread.h>
 #endif
 
+#include "Timer.h"
+
 //#include "Util.h"
 
 namespace Moses2
@@ -54,6 +58,11 @@ public:
   virtual bool DeleteAfterExecution() {
     return true;
   }
+  //! estimated run time in arbitrary units, eg. number of words.
+  //! Only used to order tasks when the pool runs longest first
+  virtual size_t GetCost() const {
+    return 0;
+  }
   virtual ~Task() {
   }
 };
@@ -67,9 +76,7 @@ public:
   explicit ThreadPool(size_t numThreads, int cpuAffinityOffset = -1,
                       int cpuAffinityIncr = 1);
 
-  ~ThreadPool() {
-    Stop();
-  }
+  ~ThreadPool();
 
   /**
    * Add a job to the threadpool.
@@ -89,20 +96,73 @@ public:
     m_queueLimit = limit;
   }
 
+  /**
+   * Run the queued task with the highest Task::GetCost() first, rather than
+   * in the order they were submitted. Long sentences then don't get
+   * started last and hold up the end of a batch
+   **/
+  void SetLongestFirst(bool longestFirst) {
+    m_longestFirst = longestFirst;
+  }
+
+  /**
+   * Tasks run, tasks stolen from other threads and busy time, per thread
+   **/
+  void Report(std::ostream &out) const;
+
 private:
+  typedef boost::shared_ptr<Task> TaskPtr;
+
+  /**
+   * Each thread has its own queue of tasks, under its own lock. Submit()
+   * deals tasks out round robin, and a thread whose queue is empty steals
+   * from the others. Running longest first, a thread claims the costliest
+   * task of all queues instead.
+   **/
+  struct Worker {
+    mutable boost::mutex mutex;
+    // by cost, highest first and in submission order for equal costs.
+    // All costs are 0 unless running longest first
+    std::multimap<size_t, TaskPtr, std::greater<size_t> > tasks;
+
+    // stats, under mutex
+    size_t numRun;
+    size_t numStolen;
+    Timer busy;
+
+    Worker() : numRun(0), numStolen(0) {}
+  };
+
   /**
    * The main loop executed by each thread.
    **/
-  void Execute();
+  void Execute(size_t workerInd);
+
+  void Push(Worker &worker, const TaskPtr &task);
+  bool Pop(Worker &worker, bool steal, TaskPtr &task);
+  bool Claim(size_t workerInd, TaskPtr &task, bool &stolen);
+  void NotifyAvailable();
 
-  std::queue<boost::shared_ptr<Task> > m_tasks;
+  std::vector<Worker*> m_workers;
   boost::thread_group m_threads;
+  Timer m_timer;
+
+  // Queued tasks not yet claimed by a thread, counted under the lock of
+  // their queue. Claiming a task only takes that lock; m_mutex is only
+  // taken to sleep and wake up
+  boost::atomic<size_t> m_numQueued;
+  boost::atomic<size_t> m_numSleeping; // threads waiting for m_threadNeeded
+  boost::atomic<size_t> m_numWaiting; // callers waiting for m_threadAvailable
+  boost::atomic<bool> m_stopped;
+
+  // guards everything below
   boost::mutex m_mutex;
   boost::condition_variable m_threadNeeded;
   boost::condition_variable m_threadAvailable;
-  bool m_stopped;
+  size_t m_nextWorker;
   bool m_stopping;
   size_t m_queueLimit;
+  bool m_longestFirst;
 };
 
 class TestTask: public Task
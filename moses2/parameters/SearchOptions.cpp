@@ -19,6 +19,9 @@ SearchOptions()
   , consensus(false)
   , early_discarding_threshold(DEFAULT_EARLY_DISCARDING_THRESHOLD)
   , trans_opt_threshold(DEFAULT_TRANSLATION_OPTION_THRESHOLD)
+  , lm_batch_size(0)
+  , search_threads(1)
+  , incremental_pruning(false)
 { }
 
 SearchOptions::
@@ -50,6 +53,9 @@ init(Parameter const& param)
 
   param.SetParameter(consensus, "consensus-decoding", false);
   param.SetParameter(disable_discarding, "disable-discarding", false);
+  param.SetParameter(lm_batch_size, "lm-batch-size", size_t(0));
+  param.SetParameter(search_threads, "search-threads", size_t(1));
+  param.SetParameter(incremental_pruning, "incremental-stack-pruning", false);
 
   // transformation to log of a few scores
   beam_width = TransformScore(beam_width);
@@ -99,6 +105,9 @@ update(std::map<std::string,xmlrpc_c::value>const& params)
   si = params.find("max-phrase-length");
   if (si != params.end()) max_phrase_length = xmlrpc_c::value_int(si->second);
 
+  si = params.find("lm-batch-size");
+  if (si != params.end()) lm_batch_size = xmlrpc_c::value_int(si->second);
+
   return true;
 }
 #endif
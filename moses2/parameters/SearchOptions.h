@@ -36,6 +36,10 @@ struct
   float early_discarding_threshold;
   float trans_opt_threshold;
 
+  size_t lm_batch_size; // 0 = evaluate stateful FFs one hypothesis at a time
+  size_t search_threads; // threads scoring the hypotheses of one sentence. 1 = off
+  bool incremental_pruning; // prune stacks on every insert, with a heap
+
   bool init(Parameter const& param);
   SearchOptions(Parameter const& param);
   SearchOptions();
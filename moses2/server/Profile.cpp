@@ -0,0 +1,32 @@
+/*
+ * Profile.cpp
+ *
+ */
+#include <sstream>
+#include "Profile.h"
+#include "../System.h"
+#include "../Profiler.h"
+
+namespace Moses2
+{
+
+Profile::Profile(const System &system)
+  :m_system(system)
+{
+  this->_signature = "s:";
+  this->_help = "Time spent and calls made by each feature function, as JSON";
+}
+
+void Profile::execute(xmlrpc_c::paramList const& paramList,
+                      xmlrpc_c::value *   const  retvalP)
+{
+  if (!Profiler::IsEnabled()) {
+    throw xmlrpc_c::fault("Profiling is off, start the server with -profile-file",
+                          xmlrpc_c::fault::CODE_UNSPECIFIED);
+  }
+  std::ostringstream out;
+  Profiler::WriteJson(out, m_system.featureFunctions);
+  *retvalP = xmlrpc_c::value_string(out.str());
+}
+
+} /* namespace Moses2 */
@@ -0,0 +1,28 @@
+/*
+ * Profile.h
+ *
+ */
+
+#pragma once
+#include <xmlrpc-c/base.hpp>
+#include <xmlrpc-c/registry.hpp>
+#include <xmlrpc-c/server_abyss.hpp>
+
+namespace Moses2
+{
+class System;
+
+//! the Profiler counts so far, as JSON. Needs profile-file
+class Profile : public xmlrpc_c::method
+{
+public:
+  Profile(const System &system);
+
+  void execute(xmlrpc_c::paramList const& paramList,
+               xmlrpc_c::value *   const  retvalP);
+
+protected:
+  const System &m_system;
+};
+
+} /* namespace Moses2 */
@@ -8,6 +8,7 @@
 #include "../System.h"
 #include "Server.h"
 #include "Translator.h"
+#include "Profile.h"
 #include "../parameters/ServerOptions.h"
 
 using namespace std;
@@ -18,8 +19,10 @@ namespace Moses2
 Server::Server(ServerOptions &server_options, System &system)
   :m_server_options(server_options)
   ,m_translator(new Translator(*this, system))
+  ,m_profile(new Profile(system))
 {
   m_registry.addMethod("translate", m_translator);
+  m_registry.addMethod("profile", m_profile);
 }
 
 Server::~Server()
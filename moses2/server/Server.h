@@ -32,6 +32,7 @@ protected:
   std::string m_pidfile;
   xmlrpc_c::registry m_registry;
   xmlrpc_c::methodPtr const m_translator;
+  xmlrpc_c::methodPtr const m_profile;
 
 };
 
@@ -0,0 +1,250 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <sstream>
+
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#endif
+
+#include "ExtractSorter.h"
+#include "InputFileStream.h"
+#include "OutputFileStream.h"
+
+using namespace std;
+
+namespace MosesTraining
+{
+
+bool ExtractSorter::LineOrderer::operator()(const Line &a, const Line &b) const
+{
+  int cmp = memcmp(m_buffer + a.offset, m_buffer + b.offset, min(a.length, b.length));
+  return cmp ? cmp < 0 : a.length < b.length;
+}
+
+ExtractSorter::ExtractSorter(const string &outputPath, const string &tempPrefix,
+                             size_t memoryBytes, bool unique)
+  :m_outputPath(outputPath)
+  ,m_tempPrefix(tempPrefix)
+#ifdef WITH_THREADS
+  ,m_memoryBytes(max<size_t>(memoryBytes / 2, 1))
+#else
+  ,m_memoryBytes(max<size_t>(memoryBytes, 1))
+#endif
+  ,m_unique(unique)
+  ,m_closed(false)
+  ,m_nextLine(0)
+  ,m_first(true)
+{
+}
+
+ExtractSorter::ExtractSorter(const string &tempPrefix, size_t memoryBytes, bool unique)
+  :m_tempPrefix(tempPrefix)
+#ifdef WITH_THREADS
+  ,m_memoryBytes(max<size_t>(memoryBytes / 2, 1))
+#else
+  ,m_memoryBytes(max<size_t>(memoryBytes, 1))
+#endif
+  ,m_unique(unique)
+  ,m_closed(false)
+  ,m_nextLine(0)
+  ,m_first(true)
+{
+}
+
+ExtractSorter::~ExtractSorter()
+{
+  if (!m_closed && !m_outputPath.empty()) {
+    Close();
+  }
+  FinishReading();
+}
+
+void ExtractSorter::Add(const string &lines)
+{
+  size_t begin = 0;
+  while (begin < lines.size()) {
+    size_t end = lines.find('\n', begin);
+    if (end == string::npos) {
+      end = lines.size();
+    }
+    Line line = { m_buffer.size(), end - begin };
+    m_buffer.append(lines, begin, end - begin);
+    m_lines.push_back(line);
+    begin = end + 1;
+  }
+
+  if (m_buffer.size() + m_lines.size() * sizeof(Line) >= m_memoryBytes) {
+    StartRun();
+  }
+}
+
+void ExtractSorter::StartRun()
+{
+  ostringstream path;
+  path << m_tempPrefix << "." << m_runs.size() << ".gz";
+  m_runs.push_back(path.str());
+
+#ifdef WITH_THREADS
+  FinishRun();
+  m_writingBuffer.swap(m_buffer);
+  m_writingLines.swap(m_lines);
+  m_writer.reset(new boost::thread(boost::bind(&ExtractSorter::WriteRun,
+                                   m_runs.back(),
+                                   boost::cref(m_writingBuffer),
+                                   boost::ref(m_writingLines),
+                                   m_unique)));
+#else
+  WriteRun(m_runs.back(), m_buffer, m_lines, m_unique);
+#endif
+  m_buffer.clear();
+  m_lines.clear();
+}
+
+void ExtractSorter::FinishRun()
+{
+#ifdef WITH_THREADS
+  if (m_writer) {
+    m_writer->join();
+    m_writer.reset();
+    m_writingBuffer.clear();
+    m_writingLines.clear();
+  }
+#endif
+}
+
+void ExtractSorter::WriteRun(const string &path, const string &buffer,
+                             vector<Line> &lines, bool unique)
+{
+  sort(lines.begin(), lines.end(), LineOrderer(buffer.data()));
+
+  Moses::OutputFileStream out(path);
+  const Line *prev = NULL;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const Line &line = lines[i];
+    if (unique && prev && prev->length == line.length
+        && memcmp(buffer.data() + prev->offset, buffer.data() + line.offset, line.length) == 0) {
+      continue;
+    }
+    out.write(buffer.data() + line.offset, line.length);
+    out << '\n';
+    prev = &line;
+  }
+  out.Close();
+}
+
+void ExtractSorter::Close()
+{
+  if (m_runs.empty()) {
+    // everything fitted in memory
+    m_closed = true;
+    WriteRun(m_outputPath, m_buffer, m_lines, m_unique);
+  } else {
+    StartReading();
+    Moses::OutputFileStream out(m_outputPath);
+    string line;
+    while (ReadLine(line)) {
+      out << line << '\n';
+    }
+    out.Close();
+  }
+  string().swap(m_buffer);
+  vector<Line>().swap(m_lines);
+}
+
+void ExtractSorter::StartReading()
+{
+  m_closed = true;
+  if (m_runs.empty()) {
+    sort(m_lines.begin(), m_lines.end(), LineOrderer(m_buffer.data()));
+    return;
+  }
+
+  if (!m_lines.empty()) {
+    StartRun();
+  }
+  FinishRun();
+  for (size_t i = 0; i < m_runs.size(); ++i) {
+    m_readers.push_back(new Moses::InputFileStream(m_runs[i]));
+    RunHead head;
+    head.run = i;
+    if (getline(*m_readers.back(), head.line)) {
+      m_heads.push(head);
+    }
+  }
+}
+
+bool ExtractSorter::ReadLine(string &line)
+{
+  if (m_runs.empty()) {
+    while (m_nextLine < m_lines.size()) {
+      const Line &next = m_lines[m_nextLine++];
+      if (m_unique && m_nextLine > 1) {
+        const Line &prev = m_lines[m_nextLine - 2];
+        if (prev.length == next.length
+            && memcmp(m_buffer.data() + prev.offset, m_buffer.data() + next.offset, next.length) == 0) {
+          continue;
+        }
+      }
+      line.assign(m_buffer, next.offset, next.length);
+      return true;
+    }
+    string().swap(m_buffer);
+    vector<Line>().swap(m_lines);
+    return false;
+  }
+
+  while (!m_heads.empty()) {
+    RunHead head = m_heads.top();
+    m_heads.pop();
+    line.swap(head.line);
+    if (getline(*m_readers[head.run], head.line)) {
+      m_heads.push(head);
+    }
+    if (m_unique) {
+      if (!m_first && line == m_prev) {
+        continue;
+      }
+      m_prev = line;
+    }
+    m_first = false;
+    return true;
+  }
+  FinishReading();
+  return false;
+}
+
+void ExtractSorter::FinishReading()
+{
+  for (size_t i = 0; i < m_readers.size(); ++i) {
+    m_readers[i]->Close();
+    delete m_readers[i];
+    remove(m_runs[i].c_str());
+  }
+  m_readers.clear();
+}
+
+}
+
@@ -0,0 +1,140 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+#pragma once
+
+#include <queue>
+#include <string>
+#include <vector>
+
+#ifdef WITH_THREADS
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#endif
+
+namespace Moses
+{
+class InputFileStream;
+}
+
+namespace MosesTraining
+{
+
+/** Sorts the lines of an extract file in byte order, as LC_ALL=C sort
+ *  does, within a memory budget, so that extract can write the sorted
+ *  files score reads without going through split, sort and gzip.
+ *
+ *  Lines are kept in memory until the budget is used up. They are then
+ *  sorted and written to a compressed temporary file (a run) while more
+ *  lines come in. Close() merges the runs and what is left in memory
+ *  into the output file, which is compressed if its name ends in ".gz".
+ *  Alternatively, the sorted lines can be read back with ReadLine(),
+ *  without writing them out.
+ */
+class ExtractSorter
+{
+public:
+  /** tempPrefix is the start of the names of the runs, memoryBytes the
+   *  size of the lines held in memory. With unique, repeated lines are
+   *  written once, as sort | uniq does */
+  ExtractSorter(const std::string &outputPath, const std::string &tempPrefix,
+                size_t memoryBytes, bool unique = false);
+  //! for sorters that are only read from
+  ExtractSorter(const std::string &tempPrefix, size_t memoryBytes, bool unique = false);
+  ~ExtractSorter();
+
+  //! one or more lines, each ending in a newline
+  void Add(const std::string &lines);
+
+  /** writes the output file. Once all lines are added, it may be called
+   *  from another thread, to close several sorters at once */
+  void Close();
+
+  //! instead of Close(), once all lines are added
+  void StartReading();
+
+  //! the next line in order, without its newline. false after the last one
+  bool ReadLine(std::string &line);
+
+  size_t GetNumRuns() const {
+    return m_runs.size();
+  }
+
+protected:
+  // a line in m_buffer, without its newline
+  struct Line {
+    size_t offset, length;
+  };
+
+  class LineOrderer
+  {
+  public:
+    explicit LineOrderer(const char *buffer)
+      :m_buffer(buffer)
+    {}
+    bool operator()(const Line &a, const Line &b) const;
+  private:
+    const char *m_buffer;
+  };
+
+  // the next line of a run
+  struct RunHead {
+    std::string line;
+    size_t run;
+  };
+
+  // smallest line on top of the queue
+  struct RunHeadOrderer {
+    bool operator()(const RunHead &a, const RunHead &b) const {
+      return b.line < a.line;
+    }
+  };
+
+  std::string m_outputPath, m_tempPrefix;
+  size_t m_memoryBytes;
+  bool m_unique;
+  bool m_closed;
+
+  std::string m_buffer;
+  std::vector<Line> m_lines;
+  std::vector<std::string> m_runs;
+
+  // reading
+  size_t m_nextLine; // of m_lines, when there are no runs
+  std::vector<Moses::InputFileStream*> m_readers;
+  std::priority_queue<RunHead, std::vector<RunHead>, RunHeadOrderer> m_heads;
+  std::string m_prev;
+  bool m_first;
+
+#ifdef WITH_THREADS
+  // the run being written while m_buffer fills up again
+  std::string m_writingBuffer;
+  std::vector<Line> m_writingLines;
+  boost::scoped_ptr<boost::thread> m_writer;
+#endif
+
+  void StartRun();
+  void FinishRun();
+  void FinishReading();
+  static void WriteRun(const std::string &path, const std::string &buffer,
+                       std::vector<Line> &lines, bool unique);
+};
+
+}
+
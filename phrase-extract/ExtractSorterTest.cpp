@@ -0,0 +1,184 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+#include "ExtractSorter.h"
+#include "moses/InputFileStream.h"
+
+#define  BOOST_TEST_MODULE MosesTrainingExtractSorter
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace MosesTraining;
+using namespace std;
+
+namespace
+{
+
+// a directory of its own for the output and the runs of each test
+class TempDir
+{
+public:
+  TempDir()
+    :m_path(boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("extract-sorter-test-%%%%%%")) {
+    boost::filesystem::create_directories(m_path);
+  }
+  ~TempDir() {
+    boost::filesystem::remove_all(m_path);
+  }
+  string Path(const string &name) const {
+    return (m_path / name).string();
+  }
+private:
+  boost::filesystem::path m_path;
+};
+
+vector<string> Lines()
+{
+  vector<string> ret;
+  for (size_t i = 0; i < 200; ++i) {
+    size_t id = (i * 7919) % 53;
+    ret.push_back("das haus" + string(id % 2 ? " ist" : "") + " ||| the house ||| 0-0 1-1 ||| "
+                  + char('a' + id % 26));
+  }
+  return ret;
+}
+
+void Add(ExtractSorter &sorter, const vector<string> &lines)
+{
+  for (size_t i = 0; i < lines.size(); ++i) {
+    sorter.Add(lines[i] + "\n");
+  }
+}
+
+vector<string> ReadFile(const string &path)
+{
+  Moses::InputFileStream in(path);
+  vector<string> ret;
+  string line;
+  while (getline(in, line)) {
+    ret.push_back(line);
+  }
+  return ret;
+}
+
+vector<string> ReadSorter(ExtractSorter &sorter)
+{
+  sorter.StartReading();
+  vector<string> ret;
+  string line;
+  while (sorter.ReadLine(line)) {
+    ret.push_back(line);
+  }
+  return ret;
+}
+
+vector<string> Sorted(vector<string> lines, bool unique)
+{
+  sort(lines.begin(), lines.end());
+  if (unique) {
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+  }
+  return lines;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(in_memory)
+{
+  TempDir dir;
+  vector<string> lines = Lines();
+  ExtractSorter sorter(dir.Path("extract.sorted"), dir.Path("run"), 1 << 20);
+  Add(sorter, lines);
+  sorter.Close();
+  BOOST_CHECK_EQUAL(sorter.GetNumRuns(), 0);
+
+  vector<string> expected = Sorted(lines, false);
+  vector<string> actual = ReadFile(dir.Path("extract.sorted"));
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(spilled)
+{
+  TempDir dir;
+  vector<string> lines = Lines();
+  // a few lines per run
+  ExtractSorter sorter(dir.Path("extract.sorted.gz"), dir.Path("run"), 256);
+  Add(sorter, lines);
+  sorter.Close();
+  BOOST_CHECK(sorter.GetNumRuns() > 1);
+
+  vector<string> expected = Sorted(lines, false);
+  vector<string> actual = ReadFile(dir.Path("extract.sorted.gz"));
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(unique_lines)
+{
+  TempDir dir;
+  vector<string> lines = Lines();
+  vector<string> expected = Sorted(lines, true);
+  BOOST_REQUIRE(expected.size() < lines.size());
+
+  ExtractSorter inMemory(dir.Path("memory"), 1 << 20, true);
+  Add(inMemory, lines);
+  vector<string> actual = ReadSorter(inMemory);
+  BOOST_CHECK_EQUAL(inMemory.GetNumRuns(), 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+  // repeats in different runs are only dropped when merging
+  ExtractSorter spilled(dir.Path("spilled"), 256, true);
+  Add(spilled, lines);
+  actual = ReadSorter(spilled);
+  BOOST_CHECK(spilled.GetNumRuns() > 1);
+  BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(byte_order)
+{
+  // as LC_ALL=C sort: bytes compare unsigned, so UTF-8 sorts after ASCII,
+  // and a prefix before the longer line
+  vector<string> lines;
+  lines.push_back("\xc3\xa9t\xc3\xa9 ||| summer");
+  lines.push_back("zebra ||| zebra");
+  lines.push_back("\x80 ||| high");
+  lines.push_back("Zebra ||| Zebra");
+  lines.push_back("ete ||| summer");
+  lines.push_back("zebra");
+  vector<string> expected;
+  expected.push_back("Zebra ||| Zebra");
+  expected.push_back("ete ||| summer");
+  expected.push_back("zebra");
+  expected.push_back("zebra ||| zebra");
+  expected.push_back("\x80 ||| high");
+  expected.push_back("\xc3\xa9t\xc3\xa9 ||| summer");
+
+  TempDir dir;
+  // spilled to runs, then in memory
+  for (size_t memory = 16; memory <= (1 << 20); memory <<= 16) {
+    ExtractSorter sorter(dir.Path("run"), memory);
+    Add(sorter, lines);
+    vector<string> actual = ReadSorter(sorter);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+  }
+}
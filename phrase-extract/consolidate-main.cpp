@@ -18,11 +18,15 @@
  ***********************************************************************/
 
 #include <cstdlib>
+#include <sstream>
 #include <vector>
 #include <string>
+#include <unistd.h>
+#include <boost/scoped_ptr.hpp>
 
 #include "util/exception.hh"
 #include "moses/Util.h"
+#include "ExtractSorter.h"
 #include "InputFileStream.h"
 #include "OutputFileStream.h"
 #include "PropertiesConsolidator.h"
@@ -40,6 +44,9 @@ bool phraseCountFlag = false;
 bool sourceLabelsFlag = false;
 bool targetSyntacticPreferencesFlag = false;
 bool sparseCountBinFeatureFlag = false;
+bool sortIndirectFlag = false;
+size_t sortMemoryMB = 1024;
+std::string tempDir;
 
 std::vector< int > countBin;
 float minScore0 = 0;
@@ -54,6 +61,7 @@ void processFiles( const std::string&, const std::string&, const std::string&, c
 void loadCountOfCounts( const std::string& );
 void breakdownCoreAndSparse( const std::string &combined, std::string &core, std::string &sparse );
 bool getLine( Moses::InputFileStream &file, std::vector< std::string > &item );
+bool getLine( MosesTraining::ExtractSorter &sorter, std::vector< std::string > &item );
 
 
 inline float maybeLogProb( float a )
@@ -84,7 +92,8 @@ int main(int argc, char* argv[])
               "[--KneserNey counts-of-counts-file] [--LowCountFeature] "
               "[--SourceLabels source-labels-file] "
               "[--PartsOfSpeech parts-of-speech-file] "
-              "[--MinScore id:threshold[,id:threshold]*]"
+              "[--MinScore id:threshold[,id:threshold]*] "
+              "[--SortIndirect] [--SortMemory mb] [--TempDir dir]"
               << std::endl;
     exit(1);
   }
@@ -157,6 +166,15 @@ int main(int argc, char* argv[])
       UTIL_THROW_IF2(i+1==argc, "specify target syntactic preferences label set file!");
       fileNameTargetSyntacticPreferencesLabelSet = argv[++i];
       std::cerr << "processing target syntactic preferences property" << std::endl;
+    } else if (strcmp(argv[i],"--SortIndirect") == 0) {
+      sortIndirectFlag = true;
+      std::cerr << "sorting the indirect rule table" << std::endl;
+    } else if (strcmp(argv[i],"--SortMemory") == 0) {
+      UTIL_THROW_IF2(i+1==argc, "specify the memory for sorting in MB!");
+      sortMemoryMB = std::atoi( argv[++i] );
+    } else if (strcmp(argv[i],"--TempDir") == 0) {
+      UTIL_THROW_IF2(i+1==argc, "specify the directory for temporary files!");
+      tempDir = argv[++i];
     } else if (strcmp(argv[i],"--MinScore") == 0) {
       std::string setting = argv[++i];
       bool done = false;
@@ -250,6 +268,25 @@ void processFiles( const std::string& fileNameDirect,
   Moses::InputFileStream fileIndirect(fileNameIndirect);
   UTIL_THROW_IF2(fileIndirect.fail(), "could not open phrase table file " << fileNameIndirect);
 
+  // the indirect table comes in target phrase order. Unless it was sorted
+  // already, sort it in the order of the direct table, as sort does with
+  // LC_ALL=C, spilling sorted runs to disk if needed
+  boost::scoped_ptr<MosesTraining::ExtractSorter> sorterIndirect;
+  if (sortIndirectFlag) {
+    if (tempDir.empty()) {
+      size_t slash = fileNameIndirect.rfind('/');
+      tempDir = (slash == std::string::npos) ? "." : fileNameIndirect.substr(0, slash);
+    }
+    std::ostringstream tempPrefix;
+    tempPrefix << tempDir << "/consolidate.tmp." << getpid();
+    sorterIndirect.reset(new MosesTraining::ExtractSorter(tempPrefix.str(), sortMemoryMB << 20));
+    std::string line;
+    while (getline(fileIndirect, line)) {
+      sorterIndirect->Add(line);
+    }
+    sorterIndirect->StartReading();
+  }
+
   // open output file: consolidated phrase table
   Moses::OutputFileStream fileConsolidated;
   bool success = fileConsolidated.Open(fileNameConsolidated);
@@ -276,7 +313,7 @@ void processFiles( const std::string& fileNameDirect,
     if (i%100000 == 0) std::cerr << "." << std::flush;
 
     std::vector< std::string > itemDirect, itemIndirect;
-    if (! getLine(fileIndirect, itemIndirect) ||
+    if (! (sorterIndirect ? getLine(*sorterIndirect, itemIndirect) : getLine(fileIndirect, itemIndirect)) ||
         ! getLine(fileDirect, itemDirect))
       break;
 
@@ -488,3 +525,14 @@ bool getLine( Moses::InputFileStream &file, std::vector< std::string > &item )
   return true;
 }
 
+
+bool getLine( MosesTraining::ExtractSorter &sorter, std::vector< std::string > &item )
+{
+  std::string line;
+  if (!sorter.ReadLine(line))
+    return false;
+
+  Moses::TokenizeMultiCharSeparator(item, line, " ||| ");
+
+  return true;
+}
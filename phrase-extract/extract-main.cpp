@@ -11,8 +11,18 @@
 #include <set>
 #include <vector>
 #include <limits>
+#include <unistd.h>
+
+#include <boost/scoped_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+#endif
 
 #include "tables-core.h"
+#include "ExtractSorter.h"
 #include "InputFileStream.h"
 #include "OutputFileStream.h"
 #include "PhraseExtractionOptions.h"
@@ -67,25 +77,56 @@ bool isAligned (SentenceAlignmentWithSyntax &, int, int);
 
 int sentenceOffset = 0;
 
+// what is extracted from a sentence, for each of the extract files
+struct ExtractedLines {
+  string extract;
+  string extractInv;
+  string extractOrientation;
+  string extractContext;
+  string extractContextInv;
+};
+
+// one of the extract files, written as it comes or sorted
+class ExtractOutput
+{
+public:
+  void Open(const string &fileName, bool sorted, const string &tempPrefix,
+            size_t memoryBytes, bool unique) {
+    if (sorted) {
+      m_sorter.reset(new ExtractSorter(fileName, tempPrefix, memoryBytes, unique));
+    } else {
+      m_file.Open(fileName);
+    }
+  }
+  void Write(const string &lines) {
+    if (m_sorter.get()) {
+      m_sorter->Add(lines);
+    } else {
+      m_file << lines;
+    }
+  }
+  void Close() {
+    if (m_sorter.get()) {
+      m_sorter->Close();
+    } else {
+      m_file.Close();
+    }
+  }
+private:
+  Moses::OutputFileStream m_file;
+  boost::scoped_ptr<ExtractSorter> m_sorter;
+};
 
 class ExtractTask
 {
 public:
   ExtractTask(
     size_t id, SentenceAlignmentWithSyntax &sentence,
-    PhraseExtractionOptions &initoptions,
-    Moses::OutputFileStream &extractFile,
-    Moses::OutputFileStream &extractFileInv,
-    Moses::OutputFileStream &extractFileOrientation,
-    Moses::OutputFileStream &extractFileContext,
-    Moses::OutputFileStream &extractFileContextInv):
+    const PhraseExtractionOptions &initoptions,
+    ExtractedLines &output):
     m_sentence(sentence),
     m_options(initoptions),
-    m_extractFile(extractFile),
-    m_extractFileInv(extractFileInv),
-    m_extractFileOrientation(extractFileOrientation),
-    m_extractFileContext(extractFileContext),
-    m_extractFileContextInv(extractFileContextInv) {}
+    m_output(output) {}
   void Run();
 private:
   vector< string > m_extractedPhrases;
@@ -115,12 +156,12 @@ private:
 
   SentenceAlignmentWithSyntax &m_sentence;
   const PhraseExtractionOptions &m_options;
-  Moses::OutputFileStream &m_extractFile;
-  Moses::OutputFileStream &m_extractFileInv;
-  Moses::OutputFileStream &m_extractFileOrientation;
-  Moses::OutputFileStream &m_extractFileContext;
-  Moses::OutputFileStream &m_extractFileContextInv;
+  ExtractedLines &m_output;
 };
+
+void extractSentences(const vector<SentenceAlignmentWithSyntax*> &sentences,
+                      const PhraseExtractionOptions &options,
+                      vector<ExtractedLines> &output, size_t threadCount);
 }
 
 int main(int argc, char* argv[])
@@ -131,20 +172,25 @@ int main(int argc, char* argv[])
   if (argc < 6) {
     cerr << "syntax: extract en de align extract max-length [orientation [ --model [wbe|phrase|hier]-[msd|mslr|mono] ] ";
     cerr << "| --OnlyOutputSpanInfo | --NoTTable | --GZOutput | --IncludeSentenceId | --SentenceOffset n | --InstanceWeights filename ";
-    cerr << "| --TargetConstituentConstrained | --TargetConstituentBoundaries ]" << std::endl;
+    cerr << "| --TargetConstituentConstrained | --TargetConstituentBoundaries ";
+    cerr << "| --Threads n | --SortedOutput | --SortMemory mb | --TempDir dir ]" << std::endl;
     exit(1);
   }
 
-  Moses::OutputFileStream extractFile;
-  Moses::OutputFileStream extractFileInv;
-  Moses::OutputFileStream extractFileOrientation;
-  Moses::OutputFileStream extractFileContext;
-  Moses::OutputFileStream extractFileContextInv;
+  ExtractOutput extractFile;
+  ExtractOutput extractFileInv;
+  ExtractOutput extractFileOrientation;
+  ExtractOutput extractFileContext;
+  ExtractOutput extractFileContextInv;
   const char* const &fileNameE = argv[1];
   const char* const &fileNameF = argv[2];
   const char* const &fileNameA = argv[3];
   const string fileNameExtract = string(argv[4]);
   PhraseExtractionOptions options(atoi(argv[5]));
+  size_t threadCount = 1;
+  bool sortedOutput = false;
+  size_t sortMemoryMB = 1024;
+  string tempDir;
 
   for(int i=6; i<argc; i++) {
     if (strcmp(argv[i],"--OnlyOutputSpanInfo") == 0) {
@@ -171,6 +217,31 @@ int main(int argc, char* argv[])
       sentenceOffset = atoi(argv[++i]);
     } else if (strcmp(argv[i], "--GZOutput") == 0) {
       options.initGzOutput(true);
+    } else if (strcmp(argv[i], "--Threads") == 0) {
+      if (i+1 >= argc || argv[i+1][0] < '1' || argv[i+1][0] > '9') {
+        cerr << "extract: syntax error, used switch --Threads without a number" << endl;
+        exit(1);
+      }
+#ifdef WITH_THREADS
+      threadCount = atoi(argv[++i]);
+#else
+      cerr << "thread support not compiled in." << endl;
+      exit(1);
+#endif
+    } else if (strcmp(argv[i], "--SortedOutput") == 0) {
+      sortedOutput = true;
+    } else if (strcmp(argv[i], "--SortMemory") == 0) {
+      if (i+1 >= argc || argv[i+1][0] < '1' || argv[i+1][0] > '9') {
+        cerr << "extract: syntax error, used switch --SortMemory without a number" << endl;
+        exit(1);
+      }
+      sortMemoryMB = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--TempDir") == 0) {
+      if (i+1 >= argc) {
+        cerr << "extract: syntax error, used switch --TempDir without a directory" << endl;
+        exit(1);
+      }
+      tempDir = argv[++i];
     } else if (strcmp(argv[i], "--InstanceWeights") == 0) {
       if (i+1 >= argc) {
         cerr << "extract: syntax error, used switch --InstanceWeights without file name" << endl;
@@ -265,21 +336,37 @@ int main(int argc, char* argv[])
     iwFileP = instanceWeightsFile.get();
   }
 
-  // open output files
+  // open output files. Sorted, they are named as extract-parallel.perl
+  // names the files it sorts
+  string sorted = sortedOutput ? ".sorted" : "";
+  string gz = options.isGzOutput() ? ".gz" : "";
+  if (tempDir.empty()) {
+    size_t slash = fileNameExtract.rfind('/');
+    tempDir = (slash == string::npos) ? "." : fileNameExtract.substr(0, slash);
+  }
+  ostringstream tempPrefix;
+  tempPrefix << tempDir << "/extract.tmp." << getpid();
+  // the memory is shared by the files written at once
+  size_t numSorted = (options.isTranslationFlag() ? 2 : 0)
+                     + (options.isOrientationFlag() ? 1 : 0)
+                     + (options.isFlexScoreFlag() ? 2 : 0);
+  size_t sortMemory = (sortMemoryMB << 20) / max<size_t>(numSorted, 1);
+
   if (options.isTranslationFlag()) {
-    string fileNameExtractInv = fileNameExtract + ".inv" + (options.isGzOutput()?".gz":"");
-    extractFile.Open( (fileNameExtract + (options.isGzOutput()?".gz":"")).c_str());
-    extractFileInv.Open(fileNameExtractInv.c_str());
+    extractFile.Open(fileNameExtract + sorted + gz, sortedOutput,
+                     tempPrefix.str() + ".extract", sortMemory, false);
+    extractFileInv.Open(fileNameExtract + ".inv" + sorted + gz, sortedOutput,
+                        tempPrefix.str() + ".inv", sortMemory, false);
   }
   if (options.isOrientationFlag()) {
-    string fileNameExtractOrientation = fileNameExtract + ".o" + (options.isGzOutput()?".gz":"");
-    extractFileOrientation.Open(fileNameExtractOrientation.c_str());
+    extractFileOrientation.Open(fileNameExtract + ".o" + sorted + gz, sortedOutput,
+                                tempPrefix.str() + ".o", sortMemory, false);
   }
   if (options.isFlexScoreFlag()) {
-    string fileNameExtractContext = fileNameExtract + ".context"  + (options.isGzOutput()?".gz":"");
-    string fileNameExtractContextInv = fileNameExtract + ".context.inv"  + (options.isGzOutput()?".gz":"");
-    extractFileContext.Open(fileNameExtractContext.c_str());
-    extractFileContextInv.Open(fileNameExtractContextInv.c_str());
+    extractFileContext.Open(fileNameExtract + ".context" + sorted + gz, sortedOutput,
+                            tempPrefix.str() + ".context", sortMemory, true);
+    extractFileContextInv.Open(fileNameExtract + ".context.inv" + sorted + gz, sortedOutput,
+                               tempPrefix.str() + ".context.inv", sortMemory, true);
   }
 
   // stats on labels for glue grammar and unknown word label probabilities
@@ -291,43 +378,75 @@ int main(int argc, char* argv[])
 
   string englishString, foreignString, alignmentString, weightString;
 
-  while (getline(*eFileP, englishString)) {
-    // Print progress dots to stderr.
-    i++;
-    if (i%10000 == 0) cerr << "." << flush;
+  // sentences are extracted from in batches, on all threads, and what is
+  // extracted is written in the order of the corpus
+  if (options.isOnlyOutputSpanInfo()) {
+    threadCount = 1;
+  }
+  const size_t batchSize = options.isOnlyOutputSpanInfo() ? 1 : 1000 * threadCount;
+  vector<SentenceAlignmentWithSyntax*> batch;
+  vector<ExtractedLines> batchOutput;
+
+  bool more = true;
+  while (more) {
+    more = static_cast<bool>(getline(*eFileP, englishString));
+    if (more) {
+      // Print progress dots to stderr.
+      i++;
+      if (i%10000 == 0) cerr << "." << flush;
+
+      getline(*fFileP, foreignString);
+      getline(*aFileP, alignmentString);
+      if (iwFileP) {
+        getline(*iwFileP, weightString);
+      }
 
-    getline(*fFileP, foreignString);
-    getline(*aFileP, alignmentString);
-    if (iwFileP) {
-      getline(*iwFileP, weightString);
+      SentenceAlignmentWithSyntax *sentence = new SentenceAlignmentWithSyntax
+      (targetLabelCollection, sourceLabelCollection,
+       targetTopLabelCollection, sourceTopLabelCollection,
+       targetSyntax, false);
+      // cout << "read in: " << englishString << " & " << foreignString << " & " << alignmentString << endl;
+      //az: output src, tgt, and alingment line
+      if (options.isOnlyOutputSpanInfo()) {
+        cout << "LOG: SRC: " << foreignString << endl;
+        cout << "LOG: TGT: " << englishString << endl;
+        cout << "LOG: ALT: " << alignmentString << endl;
+        cout << "LOG: PHRASES_BEGIN:" << endl;
+      }
+      if (sentence->create( englishString.c_str(),
+                            foreignString.c_str(),
+                            alignmentString.c_str(),
+                            weightString.c_str(),
+                            i, false)) {
+        if (options.placeholders.size()) {
+          sentence->invertAlignment();
+        }
+        batch.push_back(sentence);
+      } else {
+        delete sentence;
+      }
     }
 
-    SentenceAlignmentWithSyntax sentence
-    (targetLabelCollection, sourceLabelCollection,
-     targetTopLabelCollection, sourceTopLabelCollection,
-     targetSyntax, false);
-    // cout << "read in: " << englishString << " & " << foreignString << " & " << alignmentString << endl;
-    //az: output src, tgt, and alingment line
-    if (options.isOnlyOutputSpanInfo()) {
-      cout << "LOG: SRC: " << foreignString << endl;
-      cout << "LOG: TGT: " << englishString << endl;
-      cout << "LOG: ALT: " << alignmentString << endl;
-      cout << "LOG: PHRASES_BEGIN:" << endl;
-    }
-    if (sentence.create( englishString.c_str(),
-                         foreignString.c_str(),
-                         alignmentString.c_str(),
-                         weightString.c_str(),
-                         i, false)) {
-      if (options.placeholders.size()) {
-        sentence.invertAlignment();
+    if (batch.size() >= batchSize || (!more && batch.size())) {
+      extractSentences(batch, options, batchOutput, threadCount);
+      for (size_t j = 0; j < batch.size(); ++j) {
+        const ExtractedLines &output = batchOutput[j];
+        if (options.isTranslationFlag()) {
+          extractFile.Write(output.extract);
+          extractFileInv.Write(output.extractInv);
+        }
+        if (options.isOrientationFlag()) {
+          extractFileOrientation.Write(output.extractOrientation);
+        }
+        if (options.isFlexScoreFlag()) {
+          extractFileContext.Write(output.extractContext);
+          extractFileContextInv.Write(output.extractContextInv);
+        }
+        delete batch[j];
       }
-      ExtractTask *task = new ExtractTask(i-1, sentence, options, extractFile , extractFileInv, extractFileOrientation, extractFileContext, extractFileContextInv);
-      task->Run();
-      delete task;
-
+      batch.clear();
     }
-    if (options.isOnlyOutputSpanInfo()) cout << "LOG: PHRASES_END:" << endl; //az: mark end of phrases
+    if (more && options.isOnlyOutputSpanInfo()) cout << "LOG: PHRASES_END:" << endl; //az: mark end of phrases
   }
 
   eFile.Close();
@@ -336,18 +455,32 @@ int main(int argc, char* argv[])
 
   //az: only close if we actually opened it
   if (!options.isOnlyOutputSpanInfo()) {
+    vector<ExtractOutput*> outputs;
     if (options.isTranslationFlag()) {
-      extractFile.Close();
-      extractFileInv.Close();
-
+      outputs.push_back(&extractFile);
+      outputs.push_back(&extractFileInv);
     }
     if (options.isOrientationFlag()) {
-      extractFileOrientation.Close();
+      outputs.push_back(&extractFileOrientation);
     }
-
     if (options.isFlexScoreFlag()) {
-      extractFileContext.Close();
-      extractFileContextInv.Close();
+      outputs.push_back(&extractFileContext);
+      outputs.push_back(&extractFileContextInv);
+    }
+
+#ifdef WITH_THREADS
+    // the sorted files are merged at the same time
+    if (sortedOutput && threadCount > 1) {
+      boost::thread_group closing;
+      for (size_t j = 0; j < outputs.size(); ++j) {
+        closing.create_thread(boost::bind(&ExtractOutput::Close, outputs[j]));
+      }
+      closing.join_all();
+      outputs.clear();
+    }
+#endif
+    for (size_t j = 0; j < outputs.size(); ++j) {
+      outputs[j]->Close();
     }
   }
 
@@ -357,6 +490,46 @@ int main(int argc, char* argv[])
 
 namespace MosesTraining
 {
+
+namespace
+{
+#ifdef WITH_THREADS
+typedef boost::atomic<size_t> SentenceCounter;
+#else
+typedef size_t SentenceCounter;
+#endif
+
+void extractNextSentences(const vector<SentenceAlignmentWithSyntax*> &sentences,
+                          const PhraseExtractionOptions &options,
+                          vector<ExtractedLines> &output, SentenceCounter &next)
+{
+  for (size_t i = next++; i < sentences.size(); i = next++) {
+    ExtractTask task(i, *sentences[i], options, output[i]);
+    task.Run();
+  }
+}
+}
+
+void extractSentences(const vector<SentenceAlignmentWithSyntax*> &sentences,
+                      const PhraseExtractionOptions &options,
+                      vector<ExtractedLines> &output, size_t threadCount)
+{
+  output.clear();
+  output.resize(sentences.size());
+  SentenceCounter next(0);
+#ifdef WITH_THREADS
+  boost::thread_group threads;
+  for (size_t t = 1; t < min(threadCount, sentences.size()); ++t) {
+    threads.create_thread(boost::bind(&extractNextSentences, boost::cref(sentences),
+                                      boost::cref(options), boost::ref(output), boost::ref(next)));
+  }
+  extractNextSentences(sentences, options, output, next);
+  threads.join_all();
+#else
+  extractNextSentences(sentences, options, output, next);
+#endif
+}
+
 void ExtractTask::Run()
 {
   extract();
@@ -1065,12 +1238,12 @@ void ExtractTask::writePhrasesToFile()
     outextractFileContextInv<<phrase->data();
   }
 
-  m_extractFile << outextractFile.str();
-  m_extractFileInv  << outextractFileInv.str();
-  m_extractFileOrientation << outextractFileOrientation.str();
+  m_output.extract += outextractFile.str();
+  m_output.extractInv += outextractFileInv.str();
+  m_output.extractOrientation += outextractFileOrientation.str();
   if (m_options.isFlexScoreFlag()) {
-    m_extractFileContext  << outextractFileContext.str();
-    m_extractFileContextInv << outextractFileContextInv.str();
+    m_output.extractContext += outextractFileContext.str();
+    m_output.extractContextInv += outextractFileContextInv.str();
   }
 }
 
@@ -1104,8 +1277,8 @@ void ExtractTask::extractBase()
       outextractFileInv << "|||" << endl;
     }
   }
-  m_extractFile << outextractFile.str();
-  m_extractFileInv << outextractFileInv.str();
+  m_output.extract += outextractFile.str();
+  m_output.extractInv += outextractFileInv.str();
 
 }
 
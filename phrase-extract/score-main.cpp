@@ -27,6 +27,13 @@
 #include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/unordered_map.hpp>
+#ifdef WITH_THREADS
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#endif
 
 #include "ScoreFeature.h"
 #include "tables-core.h"
@@ -96,6 +103,11 @@ std::vector<float> orientationClassPriorsR2L(4,0); // mono swap dleft dright
 Vocabulary vcbT;
 Vocabulary vcbS;
 
+#ifdef WITH_THREADS
+// the label sets and counts above are filled while scoring
+boost::mutex labelSetMutex;
+#endif
+
 } // namespace
 
 
@@ -124,6 +136,51 @@ void printSourcePhrase( const PHRASE *phraseSource, const PHRASE *phraseTarget,
 void printTargetPhrase( const PHRASE *phraseSource, const PHRASE *phraseTarget, const ALIGNMENT *targetToSourceAlignment, std::ostream &out );
 void invertAlignment( const PHRASE *phraseSource, const PHRASE *phraseTarget, const ALIGNMENT *inTargetToSourceAlignment, ALIGNMENT *outSourceToTargetAlignment );
 size_t NumNonTerminal(const PHRASE *phraseSource);
+void collectCountOfCounts( const std::vector< ExtractionPhrasePair* > &phrasePairsWithSameSource );
+
+/** Scores the phrase pairs of each source phrase as they are read, on one
+ *  or more threads, and writes them in the order they were read.
+ *
+ *  With several threads, the source phrases are collected in batches. A
+ *  batch is scored on all threads, then written by a thread of its own
+ *  while the next batch is read. Reading and scoring don't overlap, as
+ *  both use the vocabularies.
+ */
+class ScoringQueue
+{
+public:
+  ScoringQueue(std::ostream &phraseTableFile, const ScoreFeatureManager &featureManager,
+               const MaybeLog &maybeLogProb, size_t threadCount);
+  ~ScoringQueue();
+
+  //! takes the phrase pairs, leaving the vector empty
+  void Add( std::vector< ExtractionPhrasePair* > &phrasePairsWithSameSource );
+
+  //! scores and writes all phrase pairs added so far, and waits for the writing
+  void Flush();
+
+private:
+  std::ostream &m_phraseTableFile;
+  const ScoreFeatureManager &m_featureManager;
+  const MaybeLog &m_maybeLogProb;
+  size_t m_threadCount;
+  size_t m_batchSize; // in phrase pairs
+
+  std::vector< std::vector< ExtractionPhrasePair* > > m_batch;
+  size_t m_batchPhrasePairs;
+
+#ifdef WITH_THREADS
+  // the scored phrase pairs of each source phrase of the batch being written
+  std::vector< std::string > m_writing;
+  boost::scoped_ptr<boost::thread> m_writer;
+  boost::atomic<size_t> m_next;
+
+  void ScoreBatch();
+  void ScoreNext( std::vector< std::string > *output );
+  void Write();
+  void FinishWriting();
+#endif
+};
 
 
 int main(int argc, char* argv[])
@@ -154,7 +211,8 @@ int main(int argc, char* argv[])
               "[--TargetSyntacticPreferences] "
               "[--UnpairedExtractFormat] "
               "[--ConditionOnTargetLHS] "
-              "[--CrossedNonTerm]"
+              "[--CrossedNonTerm] "
+              "[--Threads n]"
               << std::endl;
     std::cerr << featureManager.usage() << std::endl;
     exit(1);
@@ -172,6 +230,7 @@ int main(int argc, char* argv[])
   std::string fileNameLeftHandSideTargetSyntacticPreferencesLabelCounts;
   std::string fileNameLeftHandSideRuleTargetTargetSyntacticPreferencesLabelCounts;
   std::string fileNamePhraseOrientationPriors;
+  size_t threadCount = 1;
   // All unknown args are passed to feature manager.
   std::vector<std::string> featureArgs;
 
@@ -290,6 +349,18 @@ int main(int argc, char* argv[])
     } else if (strcmp(argv[i],"--TargetConstituentBoundaries") == 0) {
       targetConstituentBoundariesFlag = true;
       std::cerr << "including target constituent boundaries information" << std::endl;
+    } else if (strcmp(argv[i],"--Threads") == 0) {
+      if (i+1==argc) {
+        std::cerr << "ERROR: specify the number of threads!" << std::endl;
+        exit(1);
+      }
+#ifdef WITH_THREADS
+      threadCount = std::max(1, std::atoi( argv[++i] ));
+      std::cerr << "scoring on " << threadCount << " threads" << std::endl;
+#else
+      std::cerr << "ERROR: thread support not compiled in" << std::endl;
+      exit(1);
+#endif
     } else {
       featureArgs.push_back(argv[i]);
       ++i;
@@ -349,6 +420,7 @@ int main(int argc, char* argv[])
     }
     phraseTableFile = outputFile;
   }
+  ScoringQueue scoringQueue(*phraseTableFile, featureManager, maybeLogProb, threadCount);
 
   // loop through all extracted phrase translations
   std::string line, lastLine;
@@ -447,12 +519,7 @@ int main(int argc, char* argv[])
 
       if ( !phrasePairsWithSameSource.empty() &&
            !sourceMatch ) {
-        processPhrasePairs( phrasePairsWithSameSource, *phraseTableFile, featureManager, maybeLogProb );
-        for ( std::vector< ExtractionPhrasePair* >::const_iterator iter=phrasePairsWithSameSource.begin();
-              iter!=phrasePairsWithSameSource.end(); ++iter) {
-          delete *iter;
-        }
-        phrasePairsWithSameSource.clear();
+        scoringQueue.Add( phrasePairsWithSameSource );
         if ( hierarchicalFlag ) {
           phrasePairsWithSameSourceAndTarget.clear();
         }
@@ -482,13 +549,8 @@ int main(int argc, char* argv[])
   // We've been printing progress dots to stderr.  End the line.
   std::cerr << std::endl;
 
-  processPhrasePairs( phrasePairsWithSameSource, *phraseTableFile, featureManager, maybeLogProb );
-  for ( std::vector< ExtractionPhrasePair* >::const_iterator iter=phrasePairsWithSameSource.begin();
-        iter!=phrasePairsWithSameSource.end(); ++iter) {
-    delete *iter;
-  }
-  phrasePairsWithSameSource.clear();
-
+  scoringQueue.Add( phrasePairsWithSameSource );
+  scoringQueue.Flush();
 
   phraseTableFile->flush();
   if (phraseTableFile != &std::cout) {
@@ -710,6 +772,128 @@ void processPhrasePairs( std::vector< ExtractionPhrasePair* > &phrasePairsWithSa
   }
 }
 
+// count of count statistics, before anything is dropped
+void collectCountOfCounts( const std::vector< ExtractionPhrasePair* > &phrasePairsWithSameSource )
+{
+  for ( std::vector< ExtractionPhrasePair* >::const_iterator iter=phrasePairsWithSameSource.begin();
+        iter!=phrasePairsWithSameSource.end(); ++iter) {
+    totalDistinct++;
+    int countInt = (*iter)->GetCount() + 0.99999;
+    if ((countInt <= COC_MAX) &&
+        (countInt > 0))
+      countOfCounts[ countInt ]++;
+  }
+}
+
+ScoringQueue::ScoringQueue(std::ostream &phraseTableFile, const ScoreFeatureManager &featureManager,
+                           const MaybeLog &maybeLogProb, size_t threadCount)
+  : m_phraseTableFile(phraseTableFile)
+  , m_featureManager(featureManager)
+  , m_maybeLogProb(maybeLogProb)
+  , m_threadCount(threadCount)
+  , m_batchSize(10000 * threadCount)
+  , m_batchPhrasePairs(0)
+{
+}
+
+ScoringQueue::~ScoringQueue()
+{
+  Flush();
+}
+
+void ScoringQueue::Add( std::vector< ExtractionPhrasePair* > &phrasePairsWithSameSource )
+{
+  if (phrasePairsWithSameSource.empty()) {
+    return;
+  }
+  if (goodTuringFlag || kneserNeyFlag) {
+    collectCountOfCounts( phrasePairsWithSameSource );
+  }
+
+  if (m_threadCount == 1) {
+    processPhrasePairs( phrasePairsWithSameSource, m_phraseTableFile, m_featureManager, m_maybeLogProb );
+    for ( std::vector< ExtractionPhrasePair* >::const_iterator iter=phrasePairsWithSameSource.begin();
+          iter!=phrasePairsWithSameSource.end(); ++iter) {
+      delete *iter;
+    }
+    phrasePairsWithSameSource.clear();
+    return;
+  }
+
+  m_batchPhrasePairs += phrasePairsWithSameSource.size();
+  m_batch.push_back( std::vector< ExtractionPhrasePair* >() );
+  m_batch.back().swap( phrasePairsWithSameSource );
+#ifdef WITH_THREADS
+  if (m_batchPhrasePairs >= m_batchSize) {
+    ScoreBatch();
+  }
+#endif
+}
+
+void ScoringQueue::Flush()
+{
+#ifdef WITH_THREADS
+  ScoreBatch();
+  FinishWriting();
+#endif
+}
+
+#ifdef WITH_THREADS
+void ScoringQueue::ScoreBatch()
+{
+  if (m_batch.empty()) {
+    return;
+  }
+
+  std::vector< std::string > output(m_batch.size());
+  m_next = 0;
+  boost::thread_group threads;
+  for (size_t t = 1; t < std::min(m_threadCount, m_batch.size()); ++t) {
+    threads.create_thread(boost::bind(&ScoringQueue::ScoreNext, this, &output));
+  }
+  ScoreNext(&output);
+  threads.join_all();
+
+  m_batch.clear();
+  m_batchPhrasePairs = 0;
+
+  // the previous batch must be out first
+  FinishWriting();
+  m_writing.swap(output);
+  m_writer.reset(new boost::thread(boost::bind(&ScoringQueue::Write, this)));
+}
+
+void ScoringQueue::ScoreNext( std::vector< std::string > *output )
+{
+  for (size_t i = m_next++; i < m_batch.size(); i = m_next++) {
+    std::vector< ExtractionPhrasePair* > &phrasePairs = m_batch[i];
+    std::ostringstream out;
+    processPhrasePairs( phrasePairs, out, m_featureManager, m_maybeLogProb );
+    (*output)[i] = out.str();
+    for ( std::vector< ExtractionPhrasePair* >::const_iterator iter=phrasePairs.begin();
+          iter!=phrasePairs.end(); ++iter) {
+      delete *iter;
+    }
+  }
+}
+
+void ScoringQueue::Write()
+{
+  for (size_t i = 0; i < m_writing.size(); ++i) {
+    m_phraseTableFile << m_writing[i];
+  }
+}
+
+void ScoringQueue::FinishWriting()
+{
+  if (m_writer) {
+    m_writer->join();
+    m_writer.reset();
+    m_writing.clear();
+  }
+}
+#endif
+
 void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
                       float totalCount, int distinctCount,
                       std::ostream &phraseTableFile,
@@ -723,15 +907,6 @@ void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
 
   std::map< std::string, float > domainCount;
 
-  // collect count of count statistics
-  if (goodTuringFlag || kneserNeyFlag) {
-    totalDistinct++;
-    int countInt = count + 0.99999;
-    if ((countInt <= COC_MAX) &&
-        (countInt > 0))
-      countOfCounts[ countInt ]++;
-  }
-
   // output phrases
   const PHRASE *phraseSource = phrasePair.GetSource();
   const PHRASE *phraseTarget = phrasePair.GetTarget();
@@ -874,7 +1049,12 @@ void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
 
   // parts-of-speech
   if (partsOfSpeechFlag && !inverseFlag) {
-    phrasePair.UpdateVocabularyFromValueTokens("POS", partsOfSpeechSet);
+    {
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(labelSetMutex);
+#endif
+      phrasePair.UpdateVocabularyFromValueTokens("POS", partsOfSpeechSet);
+    }
     const std::string *bestPartOfSpeech = phrasePair.FindBestPropertyValue("POS");
     if (bestPartOfSpeech) {
       phraseTableFile << " {{POS " << *bestPartOfSpeech << "}}";
@@ -891,6 +1071,9 @@ void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
     // source syntax labels
     if (sourceSyntaxLabelsFlag) {
       std::string sourceLabelCounts;
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(labelSetMutex);
+#endif
       sourceLabelCounts = phrasePair.CollectAllLabelsSeparateLHSAndRHS("SourceLabels",
                           sourceLabelSet,
                           sourceLHSCounts,
@@ -908,6 +1091,9 @@ void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
     // target syntactic preferences labels
     if (targetSyntacticPreferencesFlag) {
       std::string targetSyntacticPreferencesLabelCounts;
+#ifdef WITH_THREADS
+      boost::mutex::scoped_lock lock(labelSetMutex);
+#endif
       targetSyntacticPreferencesLabelCounts = phrasePair.CollectAllLabelsSeparateLHSAndRHS("TargetPreferences",
                                               targetSyntacticPreferencesLabelSet,
                                               targetSyntacticPreferencesLHSCounts,
@@ -0,0 +1,2 @@
+#!/bin/sh
+./bjam -j1 --no-xmlrpc-c -q lm//model_test lm/builder//corpus_count_test lm/builder//adjust_counts_test lm/builder//lmplz lm//kenlm_benchmark lm//query lm//build_binary
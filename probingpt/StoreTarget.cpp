@@ -4,6 +4,7 @@
  *  Created on: 19 Jan 2016
  *      Author: hieu
  */
+#include <cstring>
 #include <boost/foreach.hpp>
 #include "StoreTarget.h"
 #include "line_splitter.h"
@@ -58,28 +59,51 @@ uint64_t StoreTarget::Save()
   return ret;
 }
 
+uint64_t StoreTarget::Save(uint64_t numTP, const std::string &rules)
+{
+  uint64_t ret = m_fileTargetColl.tellp();
+
+  m_fileTargetColl.write((char*) &numTP, sizeof(uint64_t));
+  m_fileTargetColl.write(rules.data(), rules.size());
+
+  return ret;
+}
+
 void StoreTarget::Save(const target_text &rule)
 {
-  // metadata for each tp
+  uint32_t alignTerm = GetAlignId(rule.word_align_term);
+  uint32_t alignNonTerm = GetAlignId(rule.word_align_non_term);
+
+  m_encoded.clear();
+  Encode(rule, alignTerm, alignNonTerm, m_encoded);
+  m_fileTargetColl.write(m_encoded.data(), m_encoded.size());
+}
+
+void StoreTarget::Encode(const target_text &rule, uint32_t alignTerm,
+                         uint32_t alignNonTerm, std::string &out)
+{
+  // metadata for each tp. Zeroed so that the filler and padding bytes are
+  // deterministic
   TargetPhraseInfo tpInfo;
-  tpInfo.alignTerm = GetAlignId(rule.word_align_term);
-  tpInfo.alignNonTerm = GetAlignId(rule.word_align_non_term);
+  memset(&tpInfo, 0, sizeof(TargetPhraseInfo));
+  tpInfo.alignTerm = alignTerm;
+  tpInfo.alignNonTerm = alignNonTerm;
   tpInfo.numWords = rule.target_phrase.size();
   tpInfo.propLength = rule.property.size();
 
   //cerr << "TPInfo=" << sizeof(TPInfo);
-  m_fileTargetColl.write((char*) &tpInfo, sizeof(TargetPhraseInfo));
+  out.append((const char*) &tpInfo, sizeof(TargetPhraseInfo));
 
   // scores
   for (size_t i = 0; i < rule.prob.size(); ++i) {
     float prob = rule.prob[i];
-    m_fileTargetColl.write((char*) &prob, sizeof(prob));
+    out.append((const char*) &prob, sizeof(prob));
   }
 
   // tp
   for (size_t i = 0; i < rule.target_phrase.size(); ++i) {
     uint32_t vocabId = rule.target_phrase[i];
-    m_fileTargetColl.write((char*) &vocabId, sizeof(vocabId));
+    out.append((const char*) &vocabId, sizeof(vocabId));
   }
 
   // prop TODO
@@ -106,6 +130,13 @@ void StoreTarget::SaveAlignment()
 void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
 {
   target_text *rule = new target_text;
+  Parse(line, log_prob, scfg, m_vocab, *rule);
+  m_coll.push_back(rule);
+}
+
+void StoreTarget::Parse(const line_text &line, bool log_prob, bool scfg,
+                        StoreVocab<uint32_t> &vocab, target_text &rule)
+{
   //cerr << "line.target_phrase=" << line.target_phrase << endl;
 
   // target_phrase
@@ -134,9 +165,9 @@ void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
       StringPiece factor = *itFactor;
 
       string factorStr = factor.as_string();
-      uint32_t vocabId = m_vocab.GetVocabId(factorStr);
+      uint32_t vocabId = vocab.GetVocabId(factorStr);
 
-      rule->target_phrase.push_back(vocabId);
+      rule.target_phrase.push_back(vocabId);
 
       itFactor++;
     }
@@ -156,7 +187,7 @@ void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
       if (prob == 0.0f) prob = 0.0000000001;
     }
 
-    rule->prob.push_back(prob);
+    rule.prob.push_back(prob);
     it++;
   }
 
@@ -190,12 +221,12 @@ void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
     //cerr << targetPos << "=" << nonTerm << endl;
 
     if (nonTerm) {
-      rule->word_align_non_term.push_back(sourcePos);
-      rule->word_align_non_term.push_back(targetPos);
-      //cerr << (int) rule->word_all1.back() << " ";
+      rule.word_align_non_term.push_back(sourcePos);
+      rule.word_align_non_term.push_back(targetPos);
+      //cerr << (int) rule.word_all1.back() << " ";
     } else {
-      rule->word_align_term.push_back(sourcePos);
-      rule->word_align_term.push_back(targetPos);
+      rule.word_align_term.push_back(sourcePos);
+      rule.word_align_term.push_back(targetPos);
     }
 
     it++;
@@ -203,7 +234,7 @@ void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
 
   // extra scores
   string prop = line.property.as_string();
-  AppendLexRO(prop, rule->prob, log_prob);
+  AppendLexRO(prop, rule.prob, log_prob);
 
   //cerr << "line.property=" << line.property << endl;
   //cerr << "prop=" << prop << endl;
@@ -211,10 +242,9 @@ void StoreTarget::Append(const line_text &line, bool log_prob, bool scfg)
   // properties
   /*
    for (size_t i = 0; i < prop.size(); ++i) {
-   rule->property.push_back(prop[i]);
+   rule.property.push_back(prop[i]);
    }
    */
-  m_coll.push_back(rule);
 }
 
 uint32_t StoreTarget::GetAlignId(const std::vector<size_t> &align)
@@ -231,7 +261,7 @@ uint32_t StoreTarget::GetAlignId(const std::vector<size_t> &align)
 }
 
 void StoreTarget::AppendLexRO(std::string &prop, std::vector<float> &retvector,
-                              bool log_prob) const
+                              bool log_prob)
 {
   size_t startPos = prop.find("{{LexRO ");
 
@@ -29,6 +29,21 @@ public:
   void SaveAlignment();
 
   void Append(const line_text &line, bool log_prob, bool scfg);
+
+  // Parallel building. Rules are parsed and encoded by worker threads with
+  // their own vocab and alignment ids, which the single writer remaps with
+  // GetVocabId()/GetAlignId() in input order before calling Save(numTP, rules).
+  static void Parse(const line_text &line, bool log_prob, bool scfg,
+                    StoreVocab<uint32_t> &vocab, target_text &rule);
+  static void Encode(const target_text &rule, uint32_t alignTerm,
+                     uint32_t alignNonTerm, std::string &out);
+
+  uint64_t Save(uint64_t numTP, const std::string &rules);
+  uint32_t GetVocabId(const std::string &word) {
+    return m_vocab.GetVocabId(word);
+  }
+  uint32_t GetAlignId(const std::vector<size_t> &align);
+
 protected:
   std::string m_basePath;
   std::fstream m_fileTargetColl;
@@ -38,12 +53,12 @@ protected:
   Alignments m_aligns;
 
   std::vector<target_text*> m_coll;
+  std::string m_encoded;
 
-  uint32_t GetAlignId(const std::vector<size_t> &align);
   void Save(const target_text &rule);
 
-  void AppendLexRO(std::string &prop, std::vector<float> &retvector,
-                   bool log_prob) const;
+  static void AppendLexRO(std::string &prop, std::vector<float> &retvector,
+                          bool log_prob);
 
 };
 
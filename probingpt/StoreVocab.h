@@ -6,6 +6,7 @@
  */
 #pragma once
 #include <string>
+#include <vector>
 #include <boost/unordered_map.hpp>
 #include "OutputFileStream.h"
 #include "moses2/legacy/Util2.h"
@@ -44,6 +45,15 @@ public:
     m_vocab[word] = id;
   }
 
+  // words[id - 1] for the ids handed out by GetVocabId()
+  void GetWords(std::vector<std::string> &words) const {
+    words.resize(m_vocab.size());
+    typename Coll::const_iterator iter;
+    for (iter = m_vocab.begin(); iter != m_vocab.end(); ++iter) {
+      words[iter->second - 1] = iter->first;
+    }
+  }
+
   void Save() {
     OutputFileStream strme(m_path);
 
@@ -1,10 +1,186 @@
+#include <algorithm>
 #include <iostream>
+#include <boost/atomic.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
 #include "probing_hash_utils.h"
 #include "util/file.hh"
 
 namespace probingpt
 {
 
+namespace
+{
+
+// Linear probing uses the same set of buckets whatever order the entries are
+// inserted in, and no entry probes past a bucket that ends up empty. So the
+// table is cut at buckets that will stay empty and the regions in between are
+// filled independently, each in input order, giving the sequential layout.
+
+// How many entries overflow out of a run of buckets, as a function of how
+// many overflow into it: c -> max(a, c + b)
+struct Carry {
+  int64_t a, b;
+
+  Carry() : a(0), b(0) {}
+
+  void Add(uint32_t count) {
+    a = std::max<int64_t>(0, a + count - 1);
+    b += (int64_t) count - 1;
+  }
+
+  int64_t operator()(int64_t in) const {
+    return std::max(a, in + b);
+  }
+};
+
+struct FillState {
+  FillState(Table &vTable, Entry *vBegin, size_t vBuckets,
+            std::vector<Entry> &vEntries, size_t vThreads)
+    :table(vTable), begin(vBegin), buckets(vBuckets), entries(vEntries)
+    ,threads(vThreads), counts(new boost::atomic<uint32_t>[vBuckets])
+    ,carries(vThreads), carryIn(vThreads), empty(vThreads), zeroKey(vThreads)
+    ,regionCounts(vThreads) {
+    for (size_t i = 0; i < buckets; ++i) {
+      counts[i].store(0, boost::memory_order_relaxed);
+    }
+  }
+
+  Table &table;
+  Entry *begin;
+  size_t buckets;
+  std::vector<Entry> &entries;
+  size_t threads;
+
+  boost::scoped_array<boost::atomic<uint32_t> > counts;
+  std::vector<Carry> carries;
+  std::vector<int64_t> carryIn;
+  std::vector<int64_t> empty;
+  std::vector<char> zeroKey;
+
+  // buckets that stay empty, in increasing order. Region r starts at
+  // bounds[r] and the last one wraps around to bounds[0]
+  std::vector<uint64_t> bounds;
+  // per part, how many of its entries fall in each region. Made into the
+  // part's offsets in each region before the entries are moved there
+  std::vector<std::vector<uint64_t> > regionCounts;
+  std::vector<std::vector<Entry> > regions;
+
+  uint64_t RangeBegin(uint64_t size, size_t part) const {
+    // start of the part'th of threads slices of [0, size)
+    return size * part / threads;
+  }
+
+  uint64_t Bucket(const Entry &entry) const {
+    return table.Ideal(entry.key) - begin;
+  }
+
+  size_t Region(uint64_t bucket) const {
+    size_t ret = std::upper_bound(bounds.begin(), bounds.end(), bucket) - bounds.begin();
+    return ret ? ret - 1 : bounds.size() - 1;
+  }
+};
+
+void CountBuckets(FillState &state, size_t part)
+{
+  uint64_t end = state.RangeBegin(state.entries.size(), part + 1);
+  for (uint64_t i = state.RangeBegin(state.entries.size(), part); i < end; ++i) {
+    const Entry &entry = state.entries[i];
+    // a zero key looks like an empty bucket and is overwritten later
+    if (entry.key == 0) state.zeroKey[part] = true;
+    state.counts[state.Bucket(entry)].fetch_add(1, boost::memory_order_relaxed);
+  }
+}
+
+void ComputeCarry(FillState &state, size_t part)
+{
+  uint64_t end = state.RangeBegin(state.buckets, part + 1);
+  Carry &carry = state.carries[part];
+  for (uint64_t i = state.RangeBegin(state.buckets, part); i < end; ++i) {
+    carry.Add(state.counts[i].load(boost::memory_order_relaxed));
+  }
+}
+
+void FindEmpty(FillState &state, size_t part)
+{
+  uint64_t end = state.RangeBegin(state.buckets, part + 1);
+  int64_t carry = state.carryIn[part];
+  state.empty[part] = -1;
+  for (uint64_t i = state.RangeBegin(state.buckets, part); i < end; ++i) {
+    carry += state.counts[i].load(boost::memory_order_relaxed);
+    if (carry == 0) {
+      state.empty[part] = i;
+      return;
+    }
+    --carry;
+  }
+}
+
+void CountRegions(FillState &state, size_t part)
+{
+  std::vector<uint64_t> &counts = state.regionCounts[part];
+  counts.resize(state.bounds.size());
+  uint64_t end = state.RangeBegin(state.entries.size(), part + 1);
+  for (uint64_t i = state.RangeBegin(state.entries.size(), part); i < end; ++i) {
+    ++counts[state.Region(state.Bucket(state.entries[i]))];
+  }
+}
+
+// Parts are consecutive slices of the entries, and each writes after the
+// parts before it, so every region keeps the input order
+void Partition(FillState &state, size_t part)
+{
+  std::vector<uint64_t> &offsets = state.regionCounts[part];
+  uint64_t end = state.RangeBegin(state.entries.size(), part + 1);
+  for (uint64_t i = state.RangeBegin(state.entries.size(), part); i < end; ++i) {
+    const Entry &entry = state.entries[i];
+    size_t region = state.Region(state.Bucket(entry));
+    state.regions[region][offsets[region]++] = entry;
+  }
+}
+
+void FillRegion(FillState &state, size_t region)
+{
+  std::vector<Entry> &entries = state.regions[region];
+  for (size_t i = 0; i < entries.size(); ++i) {
+    uint64_t bucket = state.Bucket(entries[i]);
+    while (state.begin[bucket].key != 0) {
+      if (++bucket == state.buckets) bucket = 0;
+    }
+    state.begin[bucket] = entries[i];
+  }
+  std::vector<Entry>().swap(entries);
+}
+
+void RunPart(void (*func)(FillState &, size_t), FillState &state, size_t part,
+             boost::exception_ptr &error)
+{
+  try {
+    func(state, part);
+  } catch (...) {
+    error = boost::current_exception();
+  }
+}
+
+// an exception of any part is thrown again here, as thrown
+void RunParts(void (*func)(FillState &, size_t), FillState &state, size_t parts)
+{
+  std::vector<boost::exception_ptr> errors(parts);
+  boost::thread_group group;
+  for (size_t part = 0; part < parts; ++part) {
+    group.create_thread(boost::bind(&RunPart, func, boost::ref(state), part,
+                                    boost::ref(errors[part])));
+  }
+  group.join_all();
+  for (size_t part = 0; part < parts; ++part) {
+    if (errors[part]) boost::rethrow_exception(errors[part]);
+  }
+}
+
+}
+
 //Read table from disk, return memory map location
 char * readTable(const char * filename, util::LoadMethod load_method, util::scoped_fd &file, util::scoped_memory &memory)
 {
@@ -25,6 +201,70 @@ void serialize_table(char *mem, size_t size, const std::string &filename)
 
 }
 
+void fill_table(Table &table, char *mem, size_t size,
+                std::vector<Entry> &entries, size_t threads)
+{
+  size_t buckets = size / sizeof(Entry);
+  threads = std::min(threads, buckets);
+
+  // a full table throws from Insert() at the same entry as before
+  bool sequential = threads < 2 || entries.size() >= buckets;
+  if (!sequential) {
+    FillState state(table, (Entry*) mem, buckets, entries, threads);
+    RunParts(&CountBuckets, state, threads);
+    sequential = std::find(state.zeroKey.begin(), state.zeroKey.end(), true)
+                 != state.zeroKey.end();
+
+    if (!sequential) {
+      RunParts(&ComputeCarry, state, threads);
+
+      // The table wraps around, so bucket 0 receives what overflows the end.
+      // There are fewer entries than buckets, so that is the least fixpoint,
+      // ie. the overflow of the whole table with none coming in.
+      Carry total;
+      for (size_t part = 0; part < threads; ++part) {
+        const Carry &carry = state.carries[part];
+        total.a = std::max(carry.a, total.a + carry.b);
+        total.b += carry.b;
+      }
+      int64_t carry = total.a;
+      for (size_t part = 0; part < threads; ++part) {
+        state.carryIn[part] = carry;
+        carry = state.carries[part](carry);
+      }
+
+      RunParts(&FindEmpty, state, threads);
+      for (size_t part = 0; part < threads; ++part) {
+        if (state.empty[part] >= 0) state.bounds.push_back(state.empty[part]);
+      }
+      state.counts.reset();
+
+      // move the entries to their regions, then let go of them
+      RunParts(&CountRegions, state, threads);
+      state.regions.resize(state.bounds.size());
+      for (size_t region = 0; region < state.bounds.size(); ++region) {
+        uint64_t offset = 0;
+        for (size_t part = 0; part < threads; ++part) {
+          uint64_t count = state.regionCounts[part][region];
+          state.regionCounts[part][region] = offset;
+          offset += count;
+        }
+        state.regions[region].resize(offset);
+      }
+      RunParts(&Partition, state, threads);
+      std::vector<Entry>().swap(entries);
+
+      RunParts(&FillRegion, state, state.bounds.size());
+      return;
+    }
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    table.Insert(entries[i]);
+  }
+  std::vector<Entry>().swap(entries);
+}
+
 uint64_t getKey(const uint64_t source_phrase[], size_t size)
 {
   //TOO SLOW
@@ -10,6 +10,7 @@
 #include <boost/functional/hash.hpp>
 #include <fcntl.h>
 #include <fstream>
+#include <vector>
 
 namespace probingpt
 {
@@ -39,6 +40,12 @@ typedef util::ProbingHashTable<Entry, boost::hash<uint64_t> > Table;
 
 void serialize_table(char *mem, size_t size, const std::string &filename);
 
+// Insert entries into an empty table in the given order, using several
+// threads. The result is byte-identical to calling table.Insert() on each.
+// entries is emptied, before the table is filled when it can be.
+void fill_table(Table &table, char *mem, size_t size,
+                std::vector<Entry> &entries, size_t threads);
+
 char * readTable(const char * filename, util::LoadMethod load_method, util::scoped_fd &file, util::scoped_memory &memory);
 
 uint64_t getKey(const uint64_t source_phrase[], size_t size);
@@ -6,6 +6,9 @@
 #include "StoreVocab.h"
 #include "moses2/legacy/Util2.h"
 #include "InputFileStream.h"
+#include "util/pcqueue.hh"
+#include <boost/bind/bind.hpp>
+#include <boost/thread/thread.hpp>
 
 using namespace std;
 
@@ -13,7 +16,8 @@ namespace probingpt
 {
 
 ///////////////////////////////////////////////////////////////////////
-void Node::Add(Table &table, const SourcePhrase &sourcePhrase, size_t pos)
+template<class Sink>
+void Node::Add(Sink &table, const SourcePhrase &sourcePhrase, size_t pos)
 {
   if (pos < sourcePhrase.size()) {
     uint64_t vocabId = sourcePhrase[pos];
@@ -43,7 +47,8 @@ void Node::Add(Table &table, const SourcePhrase &sourcePhrase, size_t pos)
   }
 }
 
-void Node::Write(Table &table)
+template<class Sink>
+void Node::Write(Sink &table)
 {
   //cerr << "START write " << done << " " << key << endl;
   BOOST_FOREACH(Children::value_type &valPair, m_children) {
@@ -63,13 +68,41 @@ void Node::Write(Table &table)
 }
 
 ///////////////////////////////////////////////////////////////////////
+namespace
+{
+
+void writeConfig(const std::string &basepath, unsigned long uniq_entries,
+                 int num_scores, int num_lex_scores, bool log_prob)
+{
+  std::ofstream configfile;
+  configfile.open((basepath + "/config").c_str());
+  configfile << "API_VERSION\t" << API_VERSION << '\n';
+  configfile << "uniq_entries\t" << uniq_entries << '\n';
+  configfile << "num_scores\t" << num_scores << '\n';
+  configfile << "num_lex_scores\t" << num_lex_scores << '\n';
+  configfile << "log_prob\t" << log_prob << '\n';
+  configfile.close();
+}
+
+void createProbingPTParallel(const std::string &phrasetable_path,
+                             const std::string &basepath, int num_scores, int num_lex_scores,
+                             bool log_prob, int max_cache_size, bool scfg, size_t threads);
+
+}
+
 void createProbingPT(const std::string &phrasetable_path,
                      const std::string &basepath, int num_scores, int num_lex_scores,
-                     bool log_prob, int max_cache_size, bool scfg)
+                     bool log_prob, int max_cache_size, bool scfg, size_t threads)
 {
 #if defined(_WIN32) || defined(_WIN64)
   std::cerr << "Create not implemented for Windows" << std::endl;
 #else
+  if (threads > 1) {
+    createProbingPTParallel(phrasetable_path, basepath, num_scores, num_lex_scores,
+                            log_prob, max_cache_size, scfg, threads);
+    return;
+  }
+
   std::cerr << "Starting..." << std::endl;
 
   //Get basepath and create directory if missing
@@ -226,17 +259,365 @@ void createProbingPT(const std::string &phrasetable_path,
   delete[] mem;
 
   //Write configfile
-  std::ofstream configfile;
-  configfile.open((basepath + "/config").c_str());
-  configfile << "API_VERSION\t" << API_VERSION << '\n';
-  configfile << "uniq_entries\t" << uniq_entries << '\n';
-  configfile << "num_scores\t" << num_scores << '\n';
-  configfile << "num_lex_scores\t" << num_lex_scores << '\n';
-  configfile << "log_prob\t" << log_prob << '\n';
-  configfile.close();
+  writeConfig(basepath, uniq_entries, num_scores, num_lex_scores, log_prob);
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////
+// Parallel build. A reader hands chunks of lines round robin to workers, which
+// split, hash, score and encode them. The calling thread takes the chunks back
+// in input order and does everything that depends on order the same way as
+// the loop above: vocab and alignment ids, TargetColl.dat, SCFG prefixes, the
+// cache and the order of hash table inserts.
+namespace
+{
+
+const size_t CHUNK_LINES = 10000;
+
+// Keeps the order of inserts, including Node's, for fill_table()
+struct EntryList {
+  std::vector<Entry> entries;
+
+  void Insert(const Entry &entry) {
+    entries.push_back(entry);
+  }
+};
+
+struct ParsedLine {
+  std::string source;
+  uint64_t key;
+  std::vector<uint64_t> vocabIds; // scfg only
+
+  // encoded rule in Chunk::rules, with ids local to the chunk
+  size_t ruleBegin;
+  size_t numProbs;
+  size_t numWords;
+
+  // for the cache
+  bool hasCount;
+  float count;
+};
+
+struct Chunk {
+  Chunk()
+    :vocab("")
+    ,rawSourceChanges(0)
+  {}
+
+  std::vector<std::string> lines;
+  std::vector<ParsedLine> parsed;
+  std::string rules;
+
+  // ids local to the chunk, in order of first appearance
+  StoreVocab<uint32_t> vocab;
+  std::vector<std::vector<size_t> > aligns;
+  std::vector<std::pair<uint64_t, std::string> > sourceWords;
+
+  // to count unique sources the way countUniqueSource() does
+  std::string firstRawSource, lastRawSource;
+  size_t rawSourceChanges;
+};
+
+typedef util::PCQueue<Chunk*> ChunkQueue;
+typedef std::priority_queue<CacheItem*, std::vector<CacheItem*>, CacheItemOrderer> Cache;
+
+void parseChunk(Chunk &chunk, bool log_prob, bool scfg, int max_cache_size)
+{
+  boost::unordered_map<std::vector<size_t>, uint32_t> aligns;
+  boost::unordered_set<std::string> sourceWords;
+  StringPiece prevRawSource;
+
+  chunk.parsed.resize(chunk.lines.size());
+  for (size_t i = 0; i < chunk.lines.size(); ++i) {
+    const std::string &text = chunk.lines[i];
+    ParsedLine &parsed = chunk.parsed[i];
+    line_text line = splitLine(text, scfg);
+
+    StringPiece rawSource(text.data(), std::min(text.find("|||"), text.size()));
+    if (i == 0) {
+      chunk.firstRawSource = rawSource.as_string();
+    } else if (rawSource != prevRawSource) {
+      ++chunk.rawSourceChanges;
+    }
+    prevRawSource = rawSource;
+
+    // source vocab, as add_to_map()
+    util::TokenIter<util::SingleCharacter> itWord(line.source_phrase, util::SingleCharacter(' '));
+    while (itWord) {
+      util::TokenIter<util::SingleCharacter> itFactor(*itWord, util::SingleCharacter('|'));
+      while (itFactor) {
+        std::string factor = itFactor->as_string();
+        if (sourceWords.insert(factor).second) {
+          chunk.sourceWords.push_back(std::make_pair(getHash(*itFactor), factor));
+        }
+        itFactor++;
+      }
+      itWord++;
+    }
+
+    parsed.source = line.source_phrase.as_string();
+    std::vector<uint64_t> vocabIds = getVocabIDs(parsed.source);
+    parsed.key = getKey(vocabIds);
+    if (scfg) {
+      parsed.vocabIds.swap(vocabIds);
+    }
+
+    target_text rule;
+    StoreTarget::Parse(line, log_prob, scfg, chunk.vocab, rule);
+
+    uint32_t alignIds[2];
+    const std::vector<size_t> *ruleAligns[2] = { &rule.word_align_term, &rule.word_align_non_term };
+    for (size_t j = 0; j < 2; ++j) {
+      std::pair<boost::unordered_map<std::vector<size_t>, uint32_t>::iterator, bool> ret =
+        aligns.insert(std::make_pair(*ruleAligns[j], (uint32_t) chunk.aligns.size()));
+      if (ret.second) {
+        chunk.aligns.push_back(*ruleAligns[j]);
+      }
+      alignIds[j] = ret.first->second;
+    }
+
+    parsed.ruleBegin = chunk.rules.size();
+    parsed.numProbs = rule.prob.size();
+    parsed.numWords = rule.target_phrase.size();
+    StoreTarget::Encode(rule, alignIds[0], alignIds[1], chunk.rules);
+
+    parsed.hasCount = false;
+    if (max_cache_size) {
+      std::string countStr = Moses2::Trim(line.counts.as_string());
+      if (!countStr.empty()) {
+        std::vector<float> toks = Moses2::Tokenize<float>(countStr);
+        if (toks.size() >= 2) {
+          parsed.hasCount = true;
+          parsed.count = toks[1];
+        }
+      }
+    }
+  }
+  chunk.lastRawSource = prevRawSource.as_string();
+
+  std::vector<std::string>().swap(chunk.lines);
+}
+
+void parseChunks(ChunkQueue &in, ChunkQueue &out, bool log_prob, bool scfg, int max_cache_size)
+{
+  Chunk *chunk;
+  while (in.Consume(chunk)) {
+    parseChunk(*chunk, log_prob, scfg, max_cache_size);
+    out.Produce(chunk);
+  }
+  out.Produce(NULL);
+}
+
+void readChunks(util::FilePiece &filein, std::vector<ChunkQueue*> &toWorkers)
+{
+  size_t worker = 0;
+  Chunk *chunk = new Chunk;
+  try {
+    while (true) {
+      chunk->lines.push_back(filein.ReadLine().as_string());
+      if (chunk->lines.size() == CHUNK_LINES) {
+        toWorkers[worker]->Produce(chunk);
+        worker = (worker + 1) % toWorkers.size();
+        chunk = new Chunk;
+      }
+    }
+  } catch (util::EndOfFileException &e) {
+  }
+
+  if (chunk->lines.empty()) {
+    delete chunk;
+  } else {
+    toWorkers[worker]->Produce(chunk);
+    worker = (worker + 1) % toWorkers.size();
+  }
+
+  // the consumer stops at the first NULL, which is the next worker's
+  for (size_t i = 0; i < toWorkers.size(); ++i) {
+    toWorkers[(worker + i) % toWorkers.size()]->Produce(NULL);
+  }
+}
+
+// Replace the chunk's local ids in its encoded rules with the global ones.
+// Ids are handed out in order of first appearance, so doing it chunk by chunk
+// gives the same ids as the sequential build
+void remapChunk(Chunk &chunk, StoreTarget &storeTarget, StoreVocab<uint64_t> &sourceVocab)
+{
+  for (size_t i = 0; i < chunk.sourceWords.size(); ++i) {
+    sourceVocab.Insert(chunk.sourceWords[i].first, chunk.sourceWords[i].second);
+  }
+
+  std::vector<std::string> words;
+  chunk.vocab.GetWords(words);
+  std::vector<uint32_t> vocabIds(words.size() + 1);
+  for (size_t i = 0; i < words.size(); ++i) {
+    vocabIds[i + 1] = storeTarget.GetVocabId(words[i]);
+  }
+
+  std::vector<uint32_t> alignIds(chunk.aligns.size());
+  for (size_t i = 0; i < chunk.aligns.size(); ++i) {
+    alignIds[i] = storeTarget.GetAlignId(chunk.aligns[i]);
+  }
+
+  for (size_t i = 0; i < chunk.parsed.size(); ++i) {
+    const ParsedLine &parsed = chunk.parsed[i];
+    char *rule = &chunk.rules[parsed.ruleBegin];
+
+    TargetPhraseInfo tpInfo;
+    memcpy(&tpInfo, rule, sizeof(TargetPhraseInfo));
+    tpInfo.alignTerm = alignIds[tpInfo.alignTerm];
+    tpInfo.alignNonTerm = alignIds[tpInfo.alignNonTerm];
+    memcpy(rule, &tpInfo, sizeof(TargetPhraseInfo));
+
+    char *word = rule + sizeof(TargetPhraseInfo) + parsed.numProbs * sizeof(float);
+    for (size_t j = 0; j < parsed.numWords; ++j, word += sizeof(uint32_t)) {
+      uint32_t vocabId;
+      memcpy(&vocabId, word, sizeof(uint32_t));
+      vocabId = vocabIds[vocabId];
+      memcpy(word, &vocabId, sizeof(uint32_t));
+    }
+  }
+}
+
+void createProbingPTParallel(const std::string &phrasetable_path,
+                             const std::string &basepath, int num_scores, int num_lex_scores,
+                             bool log_prob, int max_cache_size, bool scfg, size_t threads)
+{
+  std::cerr << "Starting with " << threads << " threads..." << std::endl;
+
+  //Get basepath and create directory if missing
+  mkdir(basepath.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  StoreTarget storeTarget(basepath);
+  StoreVocab<uint64_t> sourceVocab(basepath + "/source_vocabids");
+  util::FilePiece filein(phrasetable_path.c_str());
+
+  std::vector<ChunkQueue*> toWorkers, fromWorkers;
+  boost::thread_group workers;
+  for (size_t i = 0; i < threads; ++i) {
+    toWorkers.push_back(new ChunkQueue(2));
+    fromWorkers.push_back(new ChunkQueue(2));
+    workers.create_thread(boost::bind(&parseChunks, boost::ref(*toWorkers[i]),
+                                      boost::ref(*fromWorkers[i]), log_prob, scfg, max_cache_size));
+  }
+  workers.create_thread(boost::bind(&readChunks, boost::ref(filein), boost::ref(toWorkers)));
+
+  Cache cache;
+  float totalSourceCount = 0;
+
+  EntryList sourceEntries;
+  Node sourcePhrases;
+  sourcePhrases.done = true;
+  sourcePhrases.key = 0;
+
+  unsigned long uniq_entries = 0;
+  std::string prevRawSource;
+  size_t line_num = 0;
+
+  // current group of target phrases
+  std::string prevSource;
+  uint64_t prevKey = 0;
+  std::vector<uint64_t> prevVocabIds;
+  std::string rules;
+  uint64_t numTP = 0;
+
+  for (size_t worker = 0; ; worker = (worker + 1) % threads) {
+    Chunk *chunk;
+    if (!fromWorkers[worker]->Consume(chunk)) {
+      break;
+    }
+
+    if (chunk->firstRawSource != prevRawSource) {
+      ++uniq_entries;
+    }
+    uniq_entries += chunk->rawSourceChanges;
+    prevRawSource = chunk->lastRawSource;
+
+    remapChunk(*chunk, storeTarget, sourceVocab);
+
+    for (size_t i = 0; i < chunk->parsed.size(); ++i) {
+      const ParsedLine &line = chunk->parsed[i];
+      size_t ruleEnd = (i + 1 < chunk->parsed.size())
+                       ? chunk->parsed[i + 1].ruleBegin : chunk->rules.size();
+
+      ++line_num;
+      if (line_num % 1000000 == 0) {
+        std::cerr << line_num << " " << std::flush;
+      }
+
+      if (!prevSource.empty() && prevSource != line.source) {
+        uint64_t targetInd = storeTarget.Save(numTP, rules);
+        rules.clear();
+        numTP = 0;
+
+        Entry sourceEntry;
+        sourceEntry.value = targetInd;
+        if (scfg) {
+          sourcePhrases.Add(sourceEntries, prevVocabIds);
+        }
+        sourceEntry.key = prevKey;
+        sourceEntries.Insert(sourceEntry);
+
+        // update cache - CURRENT source phrase, not prev
+        if (max_cache_size && line.hasCount) {
+          totalSourceCount += line.count;
+
+          CacheItem *item = new CacheItem(Moses2::Trim(line.source), line.key, line.count);
+          cache.push(item);
+
+          if (max_cache_size > 0 && cache.size() > max_cache_size) {
+            cache.pop();
+          }
+        }
+      }
+
+      if (prevSource.empty() || prevSource != line.source) {
+        prevSource = line.source;
+        prevKey = line.key;
+        prevVocabIds = line.vocabIds;
+      }
+
+      rules.append(chunk->rules, line.ruleBegin, ruleEnd - line.ruleBegin);
+      ++numTP;
+    }
+
+    delete chunk;
+  }
+  workers.join_all();
+  Moses2::RemoveAllInColl(toWorkers);
+  Moses2::RemoveAllInColl(fromWorkers);
+
+  std::cerr
+      << "Reading phrase table finished, writing remaining files to disk."
+      << std::endl;
+
+  Entry sourceEntry;
+  sourceEntry.value = storeTarget.Save(numTP, rules);
+  sourceEntry.key = prevKey;
+  sourceEntries.Insert(sourceEntry);
+
+  sourcePhrases.Write(sourceEntries);
+
+  storeTarget.SaveAlignment();
+
+  size_t size = Table::Size(uniq_entries, 1.2);
+  char * mem = new char[size];
+  memset(mem, 0, size);
+  Table table(mem, size);
+  fill_table(table, mem, size, sourceEntries.entries, threads);
+
+  serialize_table(mem, size, (basepath + "/probing_hash.dat"));
+
+  sourceVocab.Save();
+
+  serialize_cache(cache, (basepath + "/cache"), totalSourceCount);
+
+  delete[] mem;
+
+  writeConfig(basepath, uniq_entries, num_scores, num_lex_scores, log_prob);
+}
+
+}
+
 size_t countUniqueSource(const std::string &path)
 {
   size_t ret = 0;
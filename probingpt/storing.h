@@ -35,14 +35,19 @@ public:
     :done(false)
   {}
 
-  void Add(Table &table, const SourcePhrase &sourcePhrase, size_t pos = 0);
-  void Write(Table &table);
+  // Entries go to a Table, or anything else with Insert(const Entry &)
+  template<class Sink>
+  void Add(Sink &table, const SourcePhrase &sourcePhrase, size_t pos = 0);
+  template<class Sink>
+  void Write(Sink &table);
 };
 
 
+// threads > 1 parses the phrase table and fills the hash table in parallel.
+// The output is the same as with 1 thread.
 void createProbingPT(const std::string &phrasetable_path,
                      const std::string &basepath, int num_scores, int num_lex_scores,
-                     bool log_prob, int max_cache_size, bool scfg);
+                     bool log_prob, int max_cache_size, bool scfg, size_t threads = 1);
 uint64_t getKey(const std::vector<uint64_t> &source_phrase);
 
 std::vector<uint64_t> CreatePrefix(const std::vector<uint64_t> &vocabid_source, size_t endPos);
@@ -99,6 +99,13 @@ template <class Except, class Data> typename Except::template ExceptionTag<Excep
 #define UTIL_LIKELY(x) (x)
 #endif
 
+// Hint that the cache line holding addr will be read soon.
+#if __GNUC__ >= 3
+#define UTIL_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define UTIL_PREFETCH(addr) ((void)(addr))
+#endif
+
 #define UTIL_THROW_IF_ARG(Condition, Exception, Arg, Modify) do { \
   if (UTIL_UNLIKELY(Condition)) { \
     UTIL_THROW_BACKEND(#Condition, Exception, Arg, Modify); \
@@ -6,6 +6,7 @@
 
 #include "util/exception.hh"
 #include "util/file.hh"
+#include "util/numa.hh"
 #include "util/parallel_read.hh"
 #include "util/scoped.hh"
 
@@ -312,10 +313,17 @@ void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scope
     case POPULATE_OR_READ:
 #endif
     case READ:
+    case NUMA_REPLICATE:
       HugeMalloc(size, false, out);
       SeekOrThrow(fd, offset);
       ReadOrThrow(fd, out.get(), size);
       break;
+    case NUMA_INTERLEAVE:
+      HugeMalloc(size, false, out);
+      NumaInterleave(out.get(), size);
+      SeekOrThrow(fd, offset);
+      ReadOrThrow(fd, out.get(), size);
+      break;
     case PARALLEL_READ:
       HugeMalloc(size, false, out);
       ParallelRead(fd, out.get(), size, offset);
@@ -139,6 +139,13 @@ typedef enum {
   READ,
   // malloc and read in parallel (recommended for Lustre)
   PARALLEL_READ,
+  // malloc with pages interleaved across NUMA nodes, then read.  Spreads the
+  // memory bandwidth of a large table over all sockets.
+  NUMA_INTERLEAVE,
+  // malloc and read, placed on the node of the calling thread.  To get a
+  // replica per node, load once per node under util::ScopedNumaPreferred and
+  // have each thread read the copy for util::NumaNodeOfCurrentThread().
+  NUMA_REPLICATE,
 } LoadMethod;
 
 void MapRead(LoadMethod method, int fd, uint64_t offset, std::size_t size, scoped_memory &out);
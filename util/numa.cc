@@ -0,0 +1,144 @@
+#include "util/numa.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy)
+#define UTIL_NUMA_SYSCALLS
+
+namespace {
+
+// From linux/mempolicy.h, which is not always installed.
+const int kMPolDefault = 0;
+const int kMPolPreferred = 1;
+const int kMPolInterleave = 3;
+
+// Node masks are a single unsigned long.
+const std::size_t kMaxNodes = 8 * sizeof(unsigned long);
+
+// Parse a sysfs list like "0-7,16-23".
+void ParseList(const std::string &list, std::vector<std::size_t> &out) {
+  std::size_t pos = 0;
+  while (pos < list.size()) {
+    unsigned int begin, end;
+    int consumed;
+    if (sscanf(list.c_str() + pos, "%u-%u%n", &begin, &end, &consumed) != 2) {
+      if (sscanf(list.c_str() + pos, "%u%n", &begin, &consumed) != 1) return;
+      end = begin;
+    }
+    for (unsigned int i = begin; i <= end; ++i) out.push_back(i);
+    pos += consumed;
+    if (pos < list.size() && list[pos] == ',') ++pos;
+  }
+}
+
+class Topology {
+  public:
+    Topology() : nodes_(0) {
+      for (std::size_t node = 0; node < kMaxNodes; ++node) {
+        char name[64];
+        sprintf(name, "/sys/devices/system/node/node%u/cpulist", static_cast<unsigned int>(node));
+        std::ifstream in(name);
+        if (!in) break;
+        std::string list;
+        std::getline(in, list);
+        std::vector<std::size_t> cpus;
+        ParseList(list, cpus);
+        for (std::vector<std::size_t>::const_iterator i = cpus.begin(); i != cpus.end(); ++i) {
+          if (*i >= cpu_to_node_.size()) cpu_to_node_.resize(*i + 1, 0);
+          cpu_to_node_[*i] = node;
+        }
+        ++nodes_;
+      }
+      if (!nodes_) nodes_ = 1;
+    }
+
+    std::size_t Nodes() const { return nodes_; }
+
+    std::size_t NodeOfCPU(int cpu) const {
+      return (cpu >= 0 && static_cast<std::size_t>(cpu) < cpu_to_node_.size()) ? cpu_to_node_[cpu] : 0;
+    }
+
+    unsigned long AllNodes() const {
+      return nodes_ == kMaxNodes ? ~0UL : ((1UL << nodes_) - 1);
+    }
+
+  private:
+    std::size_t nodes_;
+    std::vector<std::size_t> cpu_to_node_;
+};
+
+const Topology &GetTopology() {
+  static const Topology topology;
+  return topology;
+}
+
+} // namespace
+#endif // linux
+
+std::size_t NumaNodes() {
+#ifdef UTIL_NUMA_SYSCALLS
+  return GetTopology().Nodes();
+#else
+  return 1;
+#endif
+}
+
+std::size_t NumaNodeOfCurrentThread() {
+#ifdef UTIL_NUMA_SYSCALLS
+  const Topology &topology = GetTopology();
+  if (topology.Nodes() < 2) return 0;
+  return topology.NodeOfCPU(sched_getcpu());
+#else
+  return 0;
+#endif
+}
+
+void NumaInterleave(void *start, std::size_t size) {
+#ifdef UTIL_NUMA_SYSCALLS
+  const Topology &topology = GetTopology();
+  if (topology.Nodes() < 2 || !size) return;
+  unsigned long mask = topology.AllNodes();
+  // mbind wants a page-aligned start.
+  uintptr_t page = sysconf(_SC_PAGE_SIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(start) & ~(page - 1);
+  std::size_t length = size + (reinterpret_cast<uintptr_t>(start) - begin);
+  // Failure just means default placement.
+  syscall(SYS_mbind, begin, length, kMPolInterleave, &mask, kMaxNodes, 0);
+#endif
+}
+
+ScopedNumaPreferred::ScopedNumaPreferred(std::size_t node) : set_(false), old_mode_(0), old_mask_(0) {
+#ifdef UTIL_NUMA_SYSCALLS
+  if (NumaNodes() < 2 || node >= NumaNodes()) return;
+  // Without the old policy there is nothing to go back to, so leave it be.
+  if (syscall(SYS_get_mempolicy, &old_mode_, &old_mask_, kMaxNodes, NULL, 0)) return;
+  unsigned long mask = 1UL << node;
+  set_ = !syscall(SYS_set_mempolicy, kMPolPreferred, &mask, kMaxNodes);
+#endif
+}
+
+ScopedNumaPreferred::~ScopedNumaPreferred() {
+#ifdef UTIL_NUMA_SYSCALLS
+  if (!set_) return;
+  if (old_mode_ == kMPolDefault) {
+    syscall(SYS_set_mempolicy, kMPolDefault, NULL, 0);
+  } else {
+    syscall(SYS_set_mempolicy, old_mode_, &old_mask_, kMaxNodes);
+  }
+#endif
+}
+
+} // namespace util
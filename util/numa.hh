@@ -0,0 +1,45 @@
+#ifndef UTIL_NUMA_H
+#define UTIL_NUMA_H
+/* NUMA placement without a libnuma dependency.  Everything here is best
+ * effort: on non-Linux, single-node machines, or when the kernel refuses
+ * (e.g. in a container), the calls do nothing and there is one node.
+ */
+
+#include <cstddef>
+
+namespace util {
+
+// Number of NUMA nodes with memory or CPUs.  At least 1.
+std::size_t NumaNodes();
+
+// Node of the CPU the calling thread is running on right now.  Stable if the
+// thread is pinned, which is what callers choosing a replica want.
+std::size_t NumaNodeOfCurrentThread();
+
+// Spread the pages of [start, start + size) round-robin over all nodes.  Only
+// affects pages that have not been touched yet, so call before filling.
+void NumaInterleave(void *start, std::size_t size);
+
+// While in scope, memory first touched by the calling thread is placed on
+// node if it has room.  The thread's previous policy is restored afterwards.
+class ScopedNumaPreferred {
+  public:
+    explicit ScopedNumaPreferred(std::size_t node);
+
+    ~ScopedNumaPreferred();
+
+  private:
+    bool set_;
+
+    // Policy to restore.
+    int old_mode_;
+    unsigned long old_mask_;
+
+    // Noncopyable.
+    ScopedNumaPreferred(const ScopedNumaPreferred &);
+    ScopedNumaPreferred &operator=(const ScopedNumaPreferred &);
+};
+
+} // namespace util
+
+#endif // UTIL_NUMA_H
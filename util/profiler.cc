@@ -0,0 +1,97 @@
+#include "util/profiler.hh"
+
+#include <boost/atomic.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace util {
+
+bool Profiler::enabled_ = false;
+
+namespace {
+
+boost::atomic<std::size_t> next_event(Profiler::kFixedEvents);
+
+// Only written by the thread it belongs to.  Atomic so Totals() can read it
+// while that thread counts.
+struct ThreadCounts {
+  boost::atomic<uint64_t> calls[Profiler::kMaxEvents];
+  boost::atomic<uint64_t> nanoseconds[Profiler::kMaxEvents];
+
+  ThreadCounts() {
+    for (std::size_t i = 0; i < Profiler::kMaxEvents; ++i) {
+      calls[i].store(0, boost::memory_order_relaxed);
+      nanoseconds[i].store(0, boost::memory_order_relaxed);
+    }
+  }
+};
+
+// The counts of threads that are gone are kept too.
+boost::mutex all_counts_mutex;
+std::vector<ThreadCounts*> all_counts;
+
+void KeepCounts(ThreadCounts *) {}
+
+boost::thread_specific_ptr<ThreadCounts> thread_counts(&KeepCounts);
+
+ThreadCounts &GetThreadCounts() {
+  ThreadCounts *ret = thread_counts.get();
+  if (!ret) {
+    ret = new ThreadCounts;
+    thread_counts.reset(ret);
+    boost::lock_guard<boost::mutex> lock(all_counts_mutex);
+    all_counts.push_back(ret);
+  }
+  return *ret;
+}
+
+} // namespace
+
+std::size_t Profiler::Reserve(std::size_t count) {
+  return next_event.fetch_add(count);
+}
+
+void Profiler::Add(std::size_t event, double seconds, std::size_t calls) {
+  if (event >= kMaxEvents) return;
+  ThreadCounts &counts = GetThreadCounts();
+  counts.calls[event].store(counts.calls[event].load(boost::memory_order_relaxed) + calls,
+                            boost::memory_order_relaxed);
+  counts.nanoseconds[event].store(counts.nanoseconds[event].load(boost::memory_order_relaxed)
+                                  + static_cast<uint64_t>(seconds * 1e9), boost::memory_order_relaxed);
+}
+
+std::size_t Profiler::Totals(std::vector<Total> &out) {
+  std::vector<uint64_t> nanoseconds(kMaxEvents, 0);
+  out.assign(kMaxEvents, Total());
+  boost::lock_guard<boost::mutex> lock(all_counts_mutex);
+  for (std::vector<ThreadCounts*>::const_iterator t = all_counts.begin(); t != all_counts.end(); ++t) {
+    for (std::size_t i = 0; i < kMaxEvents; ++i) {
+      out[i].calls += (*t)->calls[i].load(boost::memory_order_relaxed);
+      nanoseconds[i] += (*t)->nanoseconds[i].load(boost::memory_order_relaxed);
+    }
+  }
+  for (std::size_t i = 0; i < kMaxEvents; ++i) {
+    out[i].seconds = nanoseconds[i] / 1e9;
+  }
+  return all_counts.size();
+}
+
+void Profiler::WriteJsonTotal(std::ostream &out, const char *name, const Total &total, bool &first) {
+  if (total.calls == 0) return;
+  if (!first) out << ", ";
+  first = false;
+  out << "\"" << name << "\": {\"calls\": " << total.calls
+      << ", \"seconds\": " << total.seconds << "}";
+}
+
+void Profiler::WriteJsonString(std::ostream &out, const std::string &str) {
+  out << '"';
+  for (std::size_t i = 0; i < str.size(); ++i) {
+    if (str[i] == '"' || str[i] == '\\') out << '\\';
+    out << str[i];
+  }
+  out << '"';
+}
+
+} // namespace util
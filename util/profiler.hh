@@ -0,0 +1,83 @@
+#ifndef UTIL_PROFILER_H
+#define UTIL_PROFILER_H
+/* Time spent and number of calls per event, summed over all threads.  Events
+ * are plain numbers: the program picks its own below kFixedEvents and
+ * Reserve()s the rest, e.g. a block per feature function.  Off unless
+ * Enable()d.
+ *
+ * Each thread counts in its own table, so timing a call costs two clock reads
+ * and no locking.  When profiling is off it costs a branch.
+ */
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "util/usage.hh"
+
+namespace util {
+
+class Profiler {
+  public:
+    static const std::size_t kMaxEvents = 4096;
+
+    // Events [0, kFixedEvents) are never handed out by Reserve().
+    static const std::size_t kFixedEvents = 16;
+
+    // Not thread safe, call before timing anything.
+    static void Enable() { enabled_ = true; }
+
+    static bool IsEnabled() { return enabled_; }
+
+    // First of count consecutive new events.
+    static std::size_t Reserve(std::size_t count);
+
+    // calls is more than one for a call that did the work of several at once.
+    static void Add(std::size_t event, double seconds, std::size_t calls = 1);
+
+    struct Total {
+      uint64_t calls;
+      double seconds;
+    };
+
+    // Sums of all threads so far, indexed by event.  Returns how many threads
+    // counted.
+    static std::size_t Totals(std::vector<Total> &out);
+
+    // Appends "name": {"calls": c, "seconds": s} to a JSON object, unless the
+    // event was never called.  first is true until something was written.
+    static void WriteJsonTotal(std::ostream &out, const char *name, const Total &total, bool &first);
+
+    // Writes str as a JSON string.
+    static void WriteJsonString(std::ostream &out, const std::string &str);
+
+    // Times its own lifetime.
+    class Scope {
+      public:
+        explicit Scope(std::size_t event, std::size_t calls = 1)
+          : event_(event), calls_(calls), start_(enabled_ ? WallTime() : -1.0) {}
+
+        ~Scope() {
+          if (start_ >= 0.0) Add(event_, WallTime() - start_, calls_);
+        }
+
+      private:
+        std::size_t event_;
+        std::size_t calls_;
+        double start_;
+
+        // Noncopyable.
+        Scope(const Scope &);
+        Scope &operator=(const Scope &);
+    };
+
+  private:
+    static bool enabled_;
+};
+
+} // namespace util
+
+#endif // UTIL_PROFILER_H